@@ -0,0 +1,197 @@
+#include "asset_manager.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace nightforge {
+
+std::string ArtRequest::key() const {
+    return name + '\n' + std::to_string(width) + '\n' + std::to_string(static_cast<int>(mode)) + (color ? "c" : "m");
+}
+
+// Relative and inside the sprites dir, no way up or out of it
+static bool safe_name(const std::string& name) {
+    return !name.empty() && name[0] != '/' && name[0] != '\\' && name.find("..") == std::string::npos;
+}
+
+bool read_show_image_args(nightscript::VM& vm, const std::vector<nightscript::Value>& args, int default_width,
+                          ArtRequest& request) {
+    using nightscript::ValueType;
+    if (args.empty() || args.size() > 3 || args[0].type() != ValueType::STRING_ID ||
+        (args.size() > 1 && args[1].type() != ValueType::INT) ||
+        (args.size() > 2 && args[2].type() != ValueType::STRING_ID)) {
+        std::cerr << "show_image: expected (name[, width[, mode]])" << std::endl;
+        return false;
+    }
+
+    request.name = vm.strings().get_string(args[0].as_string_id());
+    if (!safe_name(request.name)) {
+        std::cerr << "show_image: name must be relative to the sprites dir, without .." << std::endl;
+        return false;
+    }
+    request.width = args.size() > 1 ? static_cast<int>(args[1].as_integer()) : default_width;
+    if (request.width <= 0) {
+        std::cerr << "show_image: width must be positive" << std::endl;
+        return false;
+    }
+
+    std::string mode = args.size() > 2 ? vm.strings().get_string(args[2].as_string_id()) : "clean";
+    if (mode == "clean") request.mode = ascii_art::Mode::CLEAN;
+    else if (mode == "high_fidelity") request.mode = ascii_art::Mode::HIGH_FIDELITY;
+    else if (mode == "block") request.mode = ascii_art::Mode::BLOCK;
+    else if (mode == "half_block") request.mode = ascii_art::Mode::HALF_BLOCK;
+    else if (mode == "braille") request.mode = ascii_art::Mode::BRAILLE;
+    else {
+        std::cerr << "show_image: unknown mode " << mode << std::endl;
+        return false;
+    }
+    return true;
+}
+
+AssetManager::AssetManager(std::string sprites_dir, size_t max_bytes)
+    : sprites_dir_(std::move(sprites_dir)), max_bytes_(max_bytes) {}
+
+AssetManager::~AssetManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+AssetState AssetManager::request(const ArtRequest& request, std::shared_ptr<const ArtAsset>& art) {
+    std::string key = request.key();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        art = it->second->art;
+        return AssetState::READY;
+    }
+    if (failed_.count(key) || !safe_name(request.name)) return AssetState::FAILED;
+
+    if (in_flight_.insert(key).second) {
+        queue_.push_back(request);
+        if (!worker_.joinable()) worker_ = std::thread(&AssetManager::worker_loop, this);
+        queue_cv_.notify_one();
+    }
+    return AssetState::PENDING;
+}
+
+bool AssetManager::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !in_flight_.empty();
+}
+
+size_t AssetManager::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+size_t AssetManager::count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+void AssetManager::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+        ArtRequest request = std::move(queue_.front());
+        queue_.pop_front();
+
+        lock.unlock();
+        std::shared_ptr<const ArtAsset> art;
+        try {
+            art = convert(request);
+        } catch (const std::exception& e) {
+            std::cerr << "show_image: " << e.what() << std::endl;
+        }
+        lock.lock();
+
+        std::string key = request.key();
+        in_flight_.erase(key);
+        if (art) {
+            insert(key, std::move(art));
+        } else {
+            failed_.insert(key);
+        }
+    }
+}
+
+// Runs of equal glyph and colors along each row, decoded to codepoints once
+std::shared_ptr<const ArtAsset> AssetManager::convert(const ArtRequest& request) const {
+    std::string path = sprites_dir_ + "/" + request.name;
+    int width, height, channels;
+    std::unique_ptr<stbi_uc, void (*)(void*)> pixels(ascii_art::stbi_load(path.c_str(), &width, &height, &channels, 3),
+                                                     ascii_art::stbi_image_free);
+    if (!pixels) {
+        throw std::runtime_error("Failed to load image: " + path);
+    }
+
+    ascii_art::Config config;
+    config.mode = request.mode;
+    config.target_width = std::max(1, std::min(request.width, 0xFFFF));
+    config.use_color = request.color;
+    ascii_art::Interpreter interpreter(config);
+    ascii_art::Cells cells;
+    interpreter.convert_cells(pixels.get(), width, height, 3, cells);
+    if (cells.height > 0xFFFF) {
+        throw std::runtime_error("Image too tall: " + path);
+    }
+
+    std::vector<uint32_t> codepoints;
+    for (const auto& glyph : interpreter.charset()) codepoints.push_back(first_codepoint(glyph));
+
+    auto art = std::make_shared<ArtAsset>();
+    art->cols = cells.width;
+    art->rows = cells.height;
+    const bool backgrounds = !cells.backgrounds.empty();
+    for (int y = 0; y < cells.height; ++y) {
+        const size_t row = static_cast<size_t>(y) * cells.width;
+        int x = 0;
+        while (x < cells.width) {
+            const size_t i = row + x;
+            CellRun run;
+            run.x = static_cast<uint16_t>(x);
+            run.y = static_cast<uint16_t>(y);
+            run.codepoint = codepoints[cells.glyphs[i]];
+            run.fg = request.color ? cells.colors[i] : DEFAULT_COLOR;
+            run.bg = backgrounds ? cells.backgrounds[i] : DEFAULT_COLOR;
+
+            int end = x + 1;
+            while (end < cells.width) {
+                const size_t j = row + end;
+                if (codepoints[cells.glyphs[j]] != run.codepoint) break;
+                if (request.color && cells.colors[j] != run.fg) break;
+                if (backgrounds && cells.backgrounds[j] != run.bg) break;
+                ++end;
+            }
+            run.length = static_cast<uint16_t>(end - x);
+            art->runs.push_back(run);
+            x = end;
+        }
+    }
+    art->runs.shrink_to_fit();
+    return art;
+}
+
+// Newest first, the oldest go until the cache fits again. The entry just
+// added always stays, even alone over the cap
+void AssetManager::insert(const std::string& key, std::shared_ptr<const ArtAsset> art) {
+    bytes_ += art->bytes();
+    lru_.push_front(Entry{key, std::move(art)});
+    entries_[key] = lru_.begin();
+
+    while (bytes_ > max_bytes_ && lru_.size() > 1) {
+        Entry& oldest = lru_.back();
+        bytes_ -= oldest.art->bytes();
+        entries_.erase(oldest.key);
+        lru_.pop_back();
+    }
+}
+
+} // namespace nightforge
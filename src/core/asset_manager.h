@@ -0,0 +1,87 @@
+#pragma once
+#include "../rendering/ascii_art.h"
+#include "../rendering/tui_renderer.h"
+#include "../nightscript/vm.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace nightforge {
+
+// One image converted at one size and mode, the cache key
+struct ArtRequest {
+    std::string name; // under Config::sprites_dir
+    int width = 80;   // cells, the height follows the aspect ratio
+    ascii_art::Mode mode = ascii_art::Mode::CLEAN;
+    bool color = true;
+
+    std::string key() const;
+};
+
+// Converted art, kept as row runs so drawing it is a fill per run
+struct ArtAsset {
+    int cols = 0;
+    int rows = 0;
+    std::vector<CellRun> runs;
+
+    size_t bytes() const { return sizeof(ArtAsset) + runs.capacity() * sizeof(CellRun); }
+};
+
+// show_image(name[, width[, mode]]) arguments, mode one of clean,
+// high_fidelity, block, half_block, braille. Prints why and returns false if
+// they don't fit
+bool read_show_image_args(nightscript::VM& vm, const std::vector<nightscript::Value>& args, int default_width,
+                          ArtRequest& request);
+
+enum class AssetState { READY, PENDING, FAILED };
+
+// Converts images on a background worker and keeps the results in an LRU
+// cache capped by memory. Safe to call from any thread: asking never blocks
+// on a conversion, the first ask queues it and later asks find it done.
+// Art handed out stays valid after it's evicted, so whoever shows it holds on
+// to it instead of asking again every frame
+class AssetManager {
+public:
+    AssetManager(std::string sprites_dir, size_t max_bytes);
+    ~AssetManager();
+
+    AssetState request(const ArtRequest& request, std::shared_ptr<const ArtAsset>& art);
+    bool pending() const;
+
+    size_t bytes() const;
+    size_t count() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const ArtAsset> art;
+    };
+
+    const std::string sprites_dir_;
+    const size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::list<Entry> lru_; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+    size_t bytes_ = 0;
+    std::deque<ArtRequest> queue_;
+    std::unordered_set<std::string> in_flight_; // queued or converting
+    std::unordered_set<std::string> failed_;    // not retried
+    bool stopping_ = false;
+    std::thread worker_; // started on the first miss
+
+    void worker_loop();
+    std::shared_ptr<const ArtAsset> convert(const ArtRequest& request) const;
+    void insert(const std::string& key, std::shared_ptr<const ArtAsset> art);
+};
+
+} // namespace nightforge
@@ -0,0 +1,195 @@
+#include "benchmarks.h"
+#include "../rendering/ascii_art.h"
+#include "../rendering/ascii_simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nightforge {
+
+// Repeats fn for at least min_seconds, returns calls per second
+template <typename Fn>
+static double per_second(Fn&& fn, double min_seconds = 0.25) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    int calls = 0;
+    double elapsed = 0.0;
+    do {
+        fn();
+        ++calls;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    return calls / elapsed;
+}
+
+// Gradients with some noise on top, so runs break up like in a photo
+static ascii_art::Image make_test_frame(int width, int height) {
+    ascii_art::Image image(width, height, 3);
+    uint32_t seed = 0x9e3779b9u;
+    uint8_t* p = image.data.data();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            int noise = static_cast<int>(seed & 15) - 8;
+            *p++ = static_cast<uint8_t>(std::min(255, std::max(0, x * 255 / width + noise)));
+            *p++ = static_cast<uint8_t>(std::min(255, std::max(0, y * 255 / height + noise)));
+            *p++ = static_cast<uint8_t>(std::min(255, std::max(0, (x + y) * 255 / (width + height) + noise)));
+        }
+    }
+    return image;
+}
+
+struct BenchConfig {
+    std::string label;
+    ascii_art::Config config;
+};
+
+static std::string format(const char* fmt, ...) {
+    char buf[128];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return buf;
+}
+
+// Converts the same 1080p frame with every config in the table, one row each
+static void bench_configs(const std::string& title, const std::vector<BenchConfig>& table) {
+    static const ascii_art::Image frame = make_test_frame(1920, 1080);
+    printf("%s\n", title.c_str());
+    for (const auto& row : table) {
+        ascii_art::Interpreter interpreter(row.config);
+        size_t bytes = 0;
+        double fps = per_second([&] { bytes = interpreter.convert(frame).size(); });
+        printf("  %-20s %9.1f fps %9.3f ms/frame %8zu bytes\n", row.label.c_str(), fps, 1000.0 / fps, bytes);
+    }
+}
+
+static void bench_ascii_convert() {
+    std::vector<BenchConfig> table;
+    for (bool color : {false, true}) {
+        for (int width : {80, 160, 320, 640}) {
+            ascii_art::Config config;
+            config.target_width = width;
+            config.use_color = color;
+            config.filter = ascii_art::Filter::NEAREST; // the classify kernels, not the resampler
+            table.push_back({format("width %4d %s", width, color ? "color" : "mono"), config});
+        }
+    }
+    bench_configs(format("ascii convert, 1920x1080 rgb input (%s kernels)", ascii_art::simd::level_name()), table);
+}
+
+static void bench_resize_filters() {
+    const std::pair<ascii_art::Filter, const char*> filters[] = {
+        {ascii_art::Filter::NEAREST, "nearest"},
+        {ascii_art::Filter::BOX, "box"},
+        {ascii_art::Filter::BILINEAR, "bilinear"},
+        {ascii_art::Filter::LANCZOS, "lanczos"},
+    };
+    std::vector<BenchConfig> table;
+    for (const auto& [filter, name] : filters) {
+        for (int width : {80, 320}) {
+            ascii_art::Config config;
+            config.target_width = width;
+            config.filter = filter;
+            table.push_back({format("%-8s width %4d", name, width), config});
+        }
+    }
+    bench_configs("ascii convert by resize filter, 1920x1080 rgb input, mono", table);
+}
+
+// Low widths are where dithering matters, 320 shows what it costs per cell
+static void bench_dither_modes() {
+    const std::pair<ascii_art::Dither, const char*> modes[] = {
+        {ascii_art::Dither::NONE, "none"},
+        {ascii_art::Dither::BAYER, "bayer"},
+        {ascii_art::Dither::FLOYD_STEINBERG, "fs"},
+        {ascii_art::Dither::ATKINSON, "atkinson"},
+    };
+    std::vector<BenchConfig> table;
+    for (const auto& [dither, name] : modes) {
+        for (int width : {40, 80, 320}) {
+            ascii_art::Config config;
+            config.target_width = width;
+            config.dither = dither;
+            table.push_back({format("%-8s width %4d", name, width), config});
+        }
+    }
+    bench_configs("ascii convert by dither mode, 1920x1080 rgb input, mono", table);
+}
+
+// Same cells, 1, 2 and 8 pixels per cell
+static void bench_subcell_modes() {
+    const std::pair<ascii_art::Mode, const char*> modes[] = {
+        {ascii_art::Mode::CLEAN, "clean"},
+        {ascii_art::Mode::HALF_BLOCK, "half"},
+        {ascii_art::Mode::BRAILLE, "braille"},
+    };
+    std::vector<BenchConfig> table;
+    for (bool color : {false, true}) {
+        for (const auto& [mode, name] : modes) {
+            ascii_art::Config config;
+            config.target_width = 160;
+            config.mode = mode;
+            config.use_color = color;
+            table.push_back({format("%-8s %s", name, color ? "color" : "mono"), config});
+        }
+    }
+    bench_configs("ascii convert by mode, 1920x1080 rgb input, width 160", table);
+}
+
+// Escapes are most of the bytes of colored output, the palette decides how many
+static void bench_palettes() {
+    const std::pair<ascii_art::Palette, const char*> palettes[] = {
+        {ascii_art::Palette::TRUECOLOR, "truecolor"},
+        {ascii_art::Palette::XTERM256, "256"},
+        {ascii_art::Palette::ANSI16, "16"},
+    };
+    std::vector<BenchConfig> table;
+    for (const auto& [palette, name] : palettes) {
+        ascii_art::Config config;
+        config.target_width = 160;
+        config.use_color = true;
+        config.palette = palette;
+        table.push_back({name, config});
+    }
+    bench_configs("ascii convert by palette, 1920x1080 rgb input, width 160 color", table);
+}
+
+// Wide colored output is where emitting escapes dominates
+static void bench_parallel_convert() {
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> counts = {1};
+    for (unsigned t = 2; t < cores; t *= 2) counts.push_back(static_cast<int>(t));
+    if (cores > 1) counts.push_back(static_cast<int>(cores));
+
+    std::vector<BenchConfig> table;
+    for (int threads : counts) {
+        ascii_art::Config config;
+        config.target_width = 400;
+        config.use_color = true;
+        config.threads = threads;
+        table.push_back({format("threads %3d", threads), config});
+    }
+    bench_configs(format("ascii convert in bands, 1920x1080 rgb input, width 400 color (%u cores)", cores), table);
+}
+
+int run_benchmarks() {
+    bench_ascii_convert();
+    bench_resize_filters();
+    bench_dither_modes();
+    bench_palettes();
+    bench_subcell_modes();
+    bench_parallel_convert();
+    return 0;
+}
+
+} // namespace nightforge
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace nightforge {
+
+// --bench: microbenchmarks for the hot paths outside the script VM (those
+// live in tests/benchmarks as scripts). Prints one line per case
+int run_benchmarks();
+
+} // namespace nightforge
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <string>
 
 namespace nightforge {
@@ -15,12 +16,39 @@ struct Config {
     const char* scenes_dir = "assets/scenes";
     const char* scripts_dir = "assets/scripts";
     const char* sprites_dir = "assets/sprites";
+    size_t asset_cache_bytes = 32 << 20; // converted images kept for show_image
     
     // Engine settings
     int max_stack_size = 1024;
     int max_constants = 4096;
     int render_buffer_size = 4096;
     
+    // Frame pacing, idle frames wait for input instead of ticking
+    int target_fps = 60;
+    bool show_frame_stats = false; // print frame time percentiles on exit
+    
+    // Converted animation (.nfa, see webp_to_ascii --save) played as the background
+    std::string background_animation = "";
+    
+    // Headless: no TTY, render into a virtual screen as fast as possible and report
+    bool headless = false;
+    int headless_frames = 300;
+    int headless_cols = 120; // also the screen size of server sessions
+    int headless_rows = 40;
+    
+    // Server: one process hosting a session per connection (POSIX only).
+    // An all-digit address is a TCP port on localhost, anything else a Unix socket path
+    std::string serve_address = "";
+    int serve_workers = 0;          // session worker threads, 0 = one per core
+    int max_sessions = 256;
+    int session_stack_slots = 16384; // VM stack per session (8 bytes a slot)
+    long long session_steps = 10000000; // loop iterations and calls per script run, then it's stopped
+    std::string serve_art = "";     // image converted once and shown by every session
+    
+    // Script JIT (x86-64 Linux only, ignored elsewhere)
+    bool enable_jit = false;
+    int jit_hot_threshold = 1000; // calls before a function gets compiled
+    
     // Default save location
     const char* save_dir = "saves";
 };
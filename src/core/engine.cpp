@@ -1,6 +1,11 @@
 #include "engine.h"
+#include "engine_host.h"
 #include "../nightscript/stdlib/string.h"
 #include "../nightscript/stdlib/file.h"
+#include "../nightscript/stdlib/array.h"
+#include "terminal_headless.h"
+#include "session_server.h"
+#include "benchmarks.h"
 #include <iostream>
 #include <fstream>
 #include <cstdio>
@@ -18,31 +23,25 @@
 
 namespace nightforge {
 
-// Simple HostEnvironment implementation that stores host functions
-class EngineHost : public nightscript::HostEnvironment {
-public:
-    void register_function(const std::string& name, nightscript::HostFunction func) override {
-        std::string key = name;
-        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c){ return std::tolower(c); });
-        host_functions_[key] = func;
-    }
-
-    std::optional<nightscript::Value> call_host(const std::string& name, const std::vector<nightscript::Value>& args) override {
-        auto it = host_functions_.find(name);
-        if (it != host_functions_.end()) {
-            return it->second(args);
-        }
-        return std::nullopt;
-    }
-
-private:
-    std::unordered_map<std::string, nightscript::HostFunction> host_functions_;
-};
+// Static so the background layer sees the same art every frame
+const std::string& test_scene_art() {
+    static const std::string art =
+        "    ===================================\n"
+        "    |         NightForge Engine       |\n"
+        "    |                                 |\n"
+        "    |          Kuon are you...        |\n"
+        "    |           betraying us?         |\n"
+        "    |                                 |\n"
+        "    ===================================";
+    return art;
+}
 
 Engine::Engine(const Config& config) 
-    : config_(config), running_(false), current_size_{0, 0} {
+    : config_(config), running_(false), assets_(config.sprites_dir, config.asset_cache_bytes), current_size_{0, 0} {
     host_env_impl_ = std::make_unique<EngineHost>();
     vm_ = std::make_unique<nightscript::VM>(host_env_impl_.get());
+    vm_->set_jit_enabled(config_.enable_jit);
+    vm_->set_jit_threshold(static_cast<uint32_t>(config_.jit_hot_threshold > 0 ? config_.jit_hot_threshold : 1));
     runtime_ = std::make_unique<Runtime>(vm_.get());
     terminal_ = std::unique_ptr<Terminal>(create_terminal());
     
@@ -55,34 +54,60 @@ Engine::~Engine() {
 
 int Engine::run() {
     if (config_.run_benchmarks) {
-        std::cout << "Benchmarks not yet implemented\n";
-        return 0;
+        return run_benchmarks();
+    }
+
+    if (!config_.serve_address.empty()) {
+        // Sessions get their own VMs, the script is compiled once and shared
+        SessionServer server(config_);
+        return server.run();
     }
 
     if (!config_.script_file.empty()) {
         execute_script_file(config_.script_file);
         return 0;
     }
+    
+    if (!load_animation()) {
+        return 1;
+    }
+    
+    if (config_.headless) {
+        return run_headless();
+    }
 
     if (!init_terminal()) {
         std::cerr << "Failed to initialize terminal" << std::endl;
         return 1;
     }
     
+    int target_fps = config_.target_fps > 0 ? config_.target_fps : 60;
+    FrameScheduler scheduler(target_fps);
+    render_thread_ = std::make_unique<RenderThread>(*terminal_);
+    render_thread_->start(std::max(1, 1000 / target_fps));
+    
     running_ = true;
     
+    TerminalSize size{0, 0};
+    bool size_ok = false;
+    
     while (running_) {
-        TerminalSize size;
-        bool size_ok = check_terminal_size(size);
+        scheduler.begin_frame();
 
-        if (!size_ok) {
-            if (!terminal_->get_size(size)) {
+        // The size is only queried after a resize signal (or an R retry)
+        if (terminal_->consume_resize() || size_stale_) {
+            size_stale_ = false;
+            size_ok = check_terminal_size(size);
+            if (!size_ok && !terminal_->get_size(size)) {
                 size.cols = 80; // fallback
                 size.rows = 24;
             }
+        }
 
+        if (!size_ok) {
             // Only redraw the small-screen notice when the size actually changes or when it's not already shown (so it doesn't flicker)
             if (!showing_small_screen_ || size.cols != last_small_size_.cols || size.rows != last_small_size_.rows) {
+                render_thread_->pause(); // the notice is written directly
                 terminal_->hide_cursor();
                 show_terminal_too_small_screen(size);
                 last_small_size_ = size;
@@ -90,7 +115,8 @@ int Engine::run() {
             }
 
             handle_input();
-            terminal_->sleep_ms(100);
+            if (!running_) break;
+            scheduler.wait_next(*terminal_, !input_.has_pending()); // only input or a resize changes anything
             continue;
         }
 
@@ -99,32 +125,120 @@ int Engine::run() {
             terminal_->clear_screen();
             terminal_->home_cursor();
             showing_small_screen_ = false;
+            // Screen was wiped, the render thread redraws the last frame in full
+            render_thread_->resume();
         }
 
         current_size_ = size;
 
-        // Initialize or resize renderer if needed
-        if (!renderer_ || renderer_->grid().width() != size.cols || renderer_->grid().height() != size.rows) {
+        // Initialize or resize renderer if needed, resizing keeps its storage
+        if (!renderer_) {
             renderer_ = std::make_unique<TUIRenderer>(size.cols, size.rows);
+        } else {
+            renderer_->resize(size.cols, size.rows);
         }
 
         handle_input();
+        if (!running_) break;
         update();
-        render();
+        bool changed = render();
 
-        // braindead fps limiter
-        terminal_->sleep_ms(16);
+        // A half-read escape sequence needs another frame to time out, and a
+        // playing animation or an image still converting needs the clock to
+        // keep ticking
+        scheduler.wait_next(*terminal_, !changed && !input_.has_pending() && !animation_player_ && !assets_.pending());
+    }
+    
+    cleanup_terminal();
+    
+    if (config_.show_frame_stats) {
+        FrameTimeStats stats = scheduler.stats();
+        fprintf(stderr, "frames: %zu (last %zu) p50 %.3f ms  p95 %.3f ms  p99 %.3f ms  max %.3f ms\n",
+                stats.frames, stats.samples, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms);
+    }
+    return 0;
+}
+
+int Engine::run_headless() {
+    int cols = config_.headless_cols > 0 ? config_.headless_cols : 120;
+    int rows = config_.headless_rows > 0 ? config_.headless_rows : 40;
+    int frames = config_.headless_frames > 0 ? config_.headless_frames : 1;
+    
+    auto* headless = new TerminalHeadless(cols, rows);
+    terminal_.reset(headless);
+    if (!init_terminal()) {
+        std::cerr << "Failed to initialize headless terminal" << std::endl;
+        return 1;
+    }
+    
+    // No render thread: frames are presented in order on this thread so
+    // byte counts and the final screen are the same on every run
+    renderer_ = std::make_unique<TUIRenderer>(cols, rows);
+    running_ = true;
+    
+    auto start = std::chrono::steady_clock::now();
+    int frame = 0;
+    for (; frame < frames && running_; ++frame) {
+        // Worst case every frame: rasterize every layer and send every cell
+        for (int id = 0; id < static_cast<int>(LayerId::COUNT); ++id) {
+            renderer_->invalidate_layer(static_cast<LayerId>(id));
+        }
+        renderer_->invalidate();
+        
+        handle_input();
+        update();
+        render();
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     
     cleanup_terminal();
+    
+    printf("headless: %d frames at %dx%d in %.3f ms\n", frame, cols, rows, seconds * 1000.0);
+    printf("  %.1f fps, %.1f us/frame\n", seconds > 0 ? frame / seconds : 0.0, frame > 0 ? seconds * 1e6 / frame : 0.0);
+    printf("  %.1f bytes/frame (%zu bytes, %zu writes)\n", frame > 0 ? static_cast<double>(headless->bytes_written()) / frame : 0.0,
+           headless->bytes_written(), headless->writes());
+    printf("  screen hash %016llx\n", static_cast<unsigned long long>(headless->screen_hash()));
     return 0;
 }
 
+bool Engine::load_animation() {
+    if (config_.background_animation.empty()) return true;
+    try {
+        animation_ = std::make_unique<ascii_art::Animation>(ascii_art::Animation::load(config_.background_animation));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    animation_player_ = std::make_unique<ascii_art::AnimationPlayer>(*animation_);
+    next_animation_frame_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(animation_player_->delay_ms());
+    return true;
+}
+
+void Engine::advance_animation() {
+    if (!animation_player_) return;
+    if (config_.headless) {
+        animation_player_->next();
+        return;
+    }
+    
+    // Frames that were due while the loop was busy are stepped through, not
+    // shown. After a long stall (suspended, say) the clock just restarts
+    auto now = std::chrono::steady_clock::now();
+    if (now - next_animation_frame_ > std::chrono::seconds(1)) next_animation_frame_ = now;
+    while (next_animation_frame_ <= now) {
+        animation_player_->next();
+        next_animation_frame_ += std::chrono::milliseconds(std::max(1, animation_player_->delay_ms()));
+    }
+}
+
 bool Engine::init_terminal() {
     return terminal_->init();
 }
 
 void Engine::cleanup_terminal() {
+    if (render_thread_) {
+        render_thread_->stop();
+    }
     if (terminal_) {
         terminal_->cleanup();
     }
@@ -172,41 +286,58 @@ void Engine::show_terminal_too_small_screen(const TerminalSize& current) {
 }
 
 void Engine::handle_input() {
-    char c;
-    if (terminal_->read_input(c)) {
-        c = tolower(c);
-        if (c == 'q') {
+    input_.pump(*terminal_);
+    
+    KeyEvent event;
+    while (input_.next(event)) {
+        if (event.key != Key::CHAR || (event.mods & (MOD_CTRL | MOD_ALT))) continue;
+        
+        uint32_t c = event.codepoint;
+        if (c == 'q' || c == 'Q') {
             running_ = false;
-        } else if (c == 'r') {
-            // Retry just continue the loop size will be checked again
+        } else if (c == 'r' || c == 'R') {
+            // Retry: query the size again even without a resize signal
+            size_stale_ = true;
         }
     }
 }
 
 void Engine::update() {
     // Game logic updates will go here (roblox CANT do this)
+    advance_animation();
 }
 
-void Engine::render() {
-    if (!renderer_) return;
+bool Engine::render() {
+    if (!renderer_) return false;
     
     renderer_->clear();
     
-    // test scene
-    std::string test_background =
-        "    ===================================\n"
-        "    |         NightForge Engine       |\n"
-        "    |                                 |\n"
-        "    |          Kuon are you...        |\n"
-        "    |           betraying us?         |\n"
-        "    |                                 |\n"
-        "    ===================================";
-    
-    renderer_->draw_background(test_background);
+    // Until the image is converted whatever was there stays
+    if (has_image_ && !image_art_) assets_.request(image_, image_art_);
+    if (image_art_) {
+        const ArtAsset& image = *image_art_;
+        renderer_->draw_background_runs(image_.key(), image.cols, image.rows, image.runs);
+    } else if (animation_player_) {
+        const ascii_art::AnimationPlayer& player = *animation_player_;
+        renderer_->draw_background_cells("frame " + std::to_string(player.frame()), animation_->width(), animation_->height(),
+                                         player.glyphs().data(), animation_->has_color() ? player.colors().data() : nullptr,
+                                         animation_->charset());
+    } else {
+        renderer_->draw_background(test_scene_art());
+    }
     renderer_->draw_status_bar("Test Scene", false);
     renderer_->draw_dialog_box("Welcome to NightForge. Press Q to quit.");
     
-    renderer_->render();
+    if (!render_thread_) {
+        // Headless, present in order on this thread
+        renderer_->render(*terminal_);
+        return true;
+    }
+    
+    // Output happens on the render thread, only hand over frames that changed
+    if (!renderer_->compose()) return false;
+    render_thread_->publish(renderer_->grid());
+    return true;
 }
 
 void Engine::execute_script_file(const std::string& filename) {
@@ -268,6 +399,13 @@ void Engine::execute_script_file(const std::string& filename) {
             break;
     }
     
+    // stderr, so the stats don't end up mixed into the script's own output
+    if (config_.enable_jit) {
+        std::cerr << "JIT: " << vm_->stats.jit_compiled << " functions compiled, "
+                  << vm_->stats.jit_entries << " entries, "
+                  << vm_->stats.jit_bailouts << " bailouts" << std::endl;
+    }
+    
     std::vector<std::pair<int,uint64_t>> ops;
     for (int i = 0; i < 256; ++i) {
         uint64_t c = vm_->stats.op_counts[i];
@@ -290,6 +428,7 @@ void Engine::setup_host_functions() {
     // Register stdlib functions
     stdlib::register_string_functions(host_env_impl_.get(), vm_.get());
     stdlib::register_file_functions(host_env_impl_.get(), vm_.get());
+    stdlib::register_array_functions(host_env_impl_.get(), vm_.get());
 
     // show_text(string) - display text in dialogue panel
     host_env_impl_->register_function("show_text", [this](const std::vector<Value>& args) -> nightscript::Value {
@@ -404,6 +543,20 @@ void Engine::setup_host_functions() {
         return Value::nil();
     });
     
+    // show_image(name[, width[, mode]]) - show an image from the sprites dir as
+    // the background, converted in the background and cached
+    host_env_impl_->register_function("show_image", [this](const std::vector<Value>& args) -> nightscript::Value {
+        int cols = current_size_.cols > 0 ? current_size_.cols : config_.headless_cols;
+        ArtRequest request;
+        if (!read_show_image_args(*vm_, args, cols, request)) return Value::nil();
+        
+        image_art_.reset();
+        AssetState state = assets_.request(request, image_art_);
+        image_ = request;
+        has_image_ = true;
+        return Value::boolean(state != AssetState::FAILED);
+    });
+    
     // show_choice(string, string) 
     host_env_impl_->register_function("show_choice", [this](const std::vector<Value>& args) -> nightscript::Value {
         if (args.size() < 1 || args[0].type() != ValueType::STRING_ID) {
@@ -2,14 +2,24 @@
 #include "config.h"
 #include "terminal.h"
 #include "runtime.h"
+#include "frame_scheduler.h"
+#include "input.h"
+#include "asset_manager.h"
 #include "../rendering/tui_renderer.h"
+#include "../rendering/render_thread.h"
+#include "../rendering/ascii_anim.h"
 #include "../nightscript/vm.h"
 #include "../nightscript/compiler.h"
 #include "../nightscript/host_api.h"
+#include <chrono>
 #include <memory>
+#include <string>
 
 namespace nightforge {
 
+// Placeholder scene art, drawn locally and by every server session
+const std::string& test_scene_art();
+
 class Engine {
 public:
     explicit Engine(const Config& config);
@@ -25,14 +35,32 @@ private:
     std::unique_ptr<nightscript::VM> vm_;
     std::unique_ptr<nightscript::HostEnvironment> host_env_impl_;
     std::unique_ptr<Terminal> terminal_;
+    std::unique_ptr<RenderThread> render_thread_; // writes frames, destroyed before terminal_
+    Input input_;
+    
+    // Background animation, stepped by its own frame delays (one frame per
+    // engine frame when headless, so runs stay reproducible)
+    std::unique_ptr<ascii_art::Animation> animation_;
+    std::unique_ptr<ascii_art::AnimationPlayer> animation_player_;
+    std::chrono::steady_clock::time_point next_animation_frame_;
+    
+    // Converted images for show_image, the one on screen drawn once it's ready
+    AssetManager assets_;
+    ArtRequest image_;
+    bool has_image_ = false;
+    std::shared_ptr<const ArtAsset> image_art_; // held once ready, eviction can't take it off screen
+    
+    bool load_animation();
+    void advance_animation();
     
+    int run_headless();
     bool init_terminal();
     void cleanup_terminal();
     bool check_terminal_size(TerminalSize& size);
     void show_terminal_too_small_screen(const TerminalSize& current);
     void handle_input();
     void update();
-    void render();
+    bool render(); // false if the frame didn't change
     
     // NightScript
     void execute_script_file(const std::string& filename);
@@ -41,6 +69,7 @@ private:
     // Terminal state
     TerminalSize current_size_;
     bool showing_small_screen_ = false;
+    bool size_stale_ = true;
     TerminalSize last_small_size_{0,0};
 };
 
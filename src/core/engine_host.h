@@ -0,0 +1,31 @@
+#pragma once
+#include "../nightscript/host_api.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+
+namespace nightforge {
+
+// Simple HostEnvironment implementation that stores host functions
+class EngineHost : public nightscript::HostEnvironment {
+public:
+    void register_function(const std::string& name, nightscript::HostFunction func) override {
+        std::string key = name;
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c){ return std::tolower(c); });
+        host_functions_[key] = func;
+    }
+
+    std::optional<nightscript::Value> call_host(const std::string& name, const std::vector<nightscript::Value>& args) override {
+        auto it = host_functions_.find(name);
+        if (it != host_functions_.end()) {
+            return it->second(args);
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::unordered_map<std::string, nightscript::HostFunction> host_functions_;
+};
+
+} // namespace nightforge
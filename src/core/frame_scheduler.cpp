@@ -0,0 +1,81 @@
+#include "frame_scheduler.h"
+#include "terminal.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <time.h>
+#include <cerrno>
+#endif
+
+namespace nightforge {
+
+FrameScheduler::FrameScheduler(int target_fps) {
+    if (target_fps <= 0) target_fps = 60;
+    period_ = std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1000000000LL / target_fps));
+    frame_start_ = deadline_ = Clock::now();
+    samples_ms_.reserve(SAMPLE_WINDOW);
+}
+
+void FrameScheduler::begin_frame() {
+    frame_start_ = Clock::now();
+}
+
+void FrameScheduler::wait_next(Terminal& terminal, bool idle) {
+    Clock::time_point now = Clock::now();
+    
+    float ms = std::chrono::duration<float, std::milli>(now - frame_start_).count();
+    if (samples_ms_.size() < SAMPLE_WINDOW) {
+        samples_ms_.push_back(ms);
+    } else {
+        samples_ms_[next_sample_] = ms;
+        next_sample_ = (next_sample_ + 1) % SAMPLE_WINDOW;
+    }
+    ++frames_;
+    
+    if (idle) {
+        terminal.wait_input(-1); // resizes and wake() end this too
+        deadline_ = Clock::now(); // the next busy frame starts a fresh schedule
+        return;
+    }
+    
+    deadline_ += period_;
+    if (deadline_ < now) deadline_ = now; // overran, skip the missed slots instead of bursting
+    
+    // Wait for input in whole milliseconds, then land on the deadline exactly
+    int wait_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline_ - now).count());
+    if (wait_ms > 0 && terminal.wait_input(wait_ms)) return;
+    sleep_until(deadline_);
+}
+
+void FrameScheduler::sleep_until(Clock::time_point deadline) {
+#ifdef __linux__
+    // steady_clock is CLOCK_MONOTONIC on Linux, so the time point is usable as is
+    long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+
+FrameTimeStats FrameScheduler::stats() const {
+    FrameTimeStats stats;
+    stats.frames = frames_;
+    stats.samples = samples_ms_.size();
+    if (samples_ms_.empty()) return stats;
+    
+    std::vector<float> sorted(samples_ms_);
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double q) { return static_cast<double>(sorted[static_cast<size_t>(q * (sorted.size() - 1))]); };
+    stats.p50_ms = at(0.50);
+    stats.p95_ms = at(0.95);
+    stats.p99_ms = at(0.99);
+    stats.max_ms = sorted.back();
+    return stats;
+}
+
+} // namespace nightforge
@@ -0,0 +1,49 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace nightforge {
+
+class Terminal;
+
+struct FrameTimeStats {
+    size_t frames = 0;   // all frames since start
+    size_t samples = 0;  // frames the percentiles cover (most recent window)
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+// Paces the game loop against absolute deadlines so time spent in update/render
+// comes out of the frame budget instead of adding to it. Frames that changed
+// nothing block on input instead of ticking, so an idle session costs no CPU
+class FrameScheduler {
+public:
+    explicit FrameScheduler(int target_fps);
+    
+    void begin_frame();
+    // Ends the frame and waits for the next one. Busy frames wait for the next
+    // deadline, idle frames until input. Input always ends the wait early
+    void wait_next(Terminal& terminal, bool idle);
+    
+    // Frame work time, begin_frame to wait_next
+    FrameTimeStats stats() const;
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr size_t SAMPLE_WINDOW = 1024;
+    
+    Clock::duration period_;
+    Clock::time_point frame_start_;
+    Clock::time_point deadline_;
+    std::vector<float> samples_ms_; // ring buffer
+    size_t next_sample_ = 0;
+    size_t frames_ = 0;
+    
+    static void sleep_until(Clock::time_point deadline);
+};
+
+} // namespace nightforge
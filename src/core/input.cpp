@@ -0,0 +1,270 @@
+#include "input.h"
+#include "terminal.h"
+#include <cstring>
+
+namespace nightforge {
+
+size_t Input::pump(Terminal& terminal) {
+    size_t count = 0;
+    char buffer[READ_CHUNK];
+    size_t n;
+    while ((n = terminal.read_available(buffer, sizeof(buffer))) > 0) {
+        count += feed(buffer, n);
+        if (n < sizeof(buffer)) break;
+    }
+    
+    return count + expire();
+}
+
+size_t Input::feed(const char* data, size_t size) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (pending_size_ == 0) return decode(bytes, size, false);
+    
+    // Glue the held back bytes to the new ones
+    joined_.assign(pending_, pending_ + pending_size_);
+    joined_.insert(joined_.end(), bytes, bytes + size);
+    return decode(joined_.data(), joined_.size(), false);
+}
+
+size_t Input::expire() {
+    if (pending_size_ > 0 && Clock::now() - pending_since_ >= std::chrono::milliseconds(ESCAPE_TIMEOUT_MS)) {
+        return flush();
+    }
+    return 0;
+}
+
+size_t Input::flush() {
+    if (pending_size_ == 0) return 0;
+    size_t count = decode(pending_, pending_size_, true);
+    pending_size_ = 0;
+    return count;
+}
+
+bool Input::next(KeyEvent& event) {
+    if (head_ == tail_) return false;
+    event = queue_[head_ & (QUEUE_SIZE - 1)];
+    ++head_;
+    return true;
+}
+
+void Input::push(const KeyEvent& event) {
+    if (tail_ - head_ == QUEUE_SIZE) {
+        ++dropped_; // game isn't reading, keep the older keys
+        return;
+    }
+    queue_[tail_ & (QUEUE_SIZE - 1)] = event;
+    ++tail_;
+}
+
+size_t Input::decode(const unsigned char* data, size_t size, bool final) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < size) {
+        KeyEvent event;
+        size_t used = decode_one(data + pos, size - pos, final, event);
+        if (used == 0) break;
+        push(event);
+        ++count;
+        pos += used;
+    }
+    
+    // Keep the unfinished tail for the next read
+    size_t rest = size - pos;
+    if (rest > MAX_PENDING) rest = 0; // can't be a real sequence, drop it
+    bool was_pending = pending_size_ > 0;
+    std::memmove(pending_, data + pos, rest);
+    pending_size_ = rest;
+    if (rest > 0 && !was_pending) pending_since_ = Clock::now();
+    return count;
+}
+
+static Key key_for_tilde(int code) {
+    switch (code) {
+        case 1: case 7: return Key::HOME;
+        case 2: return Key::INSERT;
+        case 3: return Key::DELETE;
+        case 4: case 8: return Key::END;
+        case 5: return Key::PAGE_UP;
+        case 6: return Key::PAGE_DOWN;
+        case 11: return Key::F1;
+        case 12: return Key::F2;
+        case 13: return Key::F3;
+        case 14: return Key::F4;
+        case 15: return Key::F5;
+        case 17: return Key::F6;
+        case 18: return Key::F7;
+        case 19: return Key::F8;
+        case 20: return Key::F9;
+        case 21: return Key::F10;
+        case 23: return Key::F11;
+        case 24: return Key::F12;
+        default: return Key::UNKNOWN;
+    }
+}
+
+// Final byte of CSI/SS3 sequences that don't take a number (arrows, home/end, F1-F4)
+static Key key_for_letter(unsigned char c) {
+    switch (c) {
+        case 'A': return Key::UP;
+        case 'B': return Key::DOWN;
+        case 'C': return Key::RIGHT;
+        case 'D': return Key::LEFT;
+        case 'H': return Key::HOME;
+        case 'F': return Key::END;
+        case 'P': return Key::F1;
+        case 'Q': return Key::F2;
+        case 'R': return Key::F3;
+        case 'S': return Key::F4;
+        default: return Key::UNKNOWN;
+    }
+}
+
+// xterm modifier parameter: 1 + (shift | alt << 1 | ctrl << 2)
+static uint8_t mods_for_param(int param) {
+    if (param <= 1) return MOD_NONE;
+    int bits = param - 1;
+    uint8_t mods = MOD_NONE;
+    if (bits & 1) mods |= MOD_SHIFT;
+    if (bits & 2) mods |= MOD_ALT;
+    if (bits & 4) mods |= MOD_CTRL;
+    return mods;
+}
+
+// ESC [ params final
+static size_t decode_csi(const unsigned char* data, size_t size, bool final, KeyEvent& event) {
+    size_t i = 2;
+    while (i < size && data[i] >= 0x20 && data[i] <= 0x3F) ++i;
+    if (i >= size) {
+        if (!final) return 0;
+        event.key = Key::ESCAPE; // gave up waiting, the rest decodes as plain keys
+        return 1;
+    }
+    
+    unsigned char last = data[i];
+    if (last < 0x40 || last > 0x7E) {
+        event.key = Key::UNKNOWN; // broken by a control byte, skip what we have
+        return i;
+    }
+    
+    int params[2] = {0, 0};
+    int param_count = 0;
+    bool private_marker = false;
+    for (size_t j = 2; j < i; ++j) {
+        unsigned char c = data[j];
+        if (c >= '0' && c <= '9') {
+            if (param_count == 0) param_count = 1;
+            if (param_count <= 2) params[param_count - 1] = params[param_count - 1] * 10 + (c - '0');
+        } else if (c == ';') {
+            if (param_count == 0) param_count = 1;
+            ++param_count;
+        } else {
+            private_marker = true; // <, ?, = ... mouse reports and friends
+        }
+    }
+    
+    event.key = Key::UNKNOWN;
+    if (private_marker) return i + 1;
+    
+    if (last == '~') {
+        event.key = key_for_tilde(params[0]);
+    } else if (last == 'Z') {
+        event.key = Key::TAB;
+        event.mods = MOD_SHIFT;
+        return i + 1;
+    } else {
+        event.key = key_for_letter(last);
+    }
+    event.mods = mods_for_param(params[1]);
+    return i + 1;
+}
+
+size_t Input::decode_one(const unsigned char* data, size_t size, bool final, KeyEvent& event) {
+    unsigned char b = data[0];
+    
+    if (b == 0x1B) {
+        if (size == 1) {
+            if (!final) return 0;
+            event.key = Key::ESCAPE;
+            return 1;
+        }
+        unsigned char next = data[1];
+        if (next == '[') return decode_csi(data, size, final, event);
+        if (next == 'O') {
+            if (size < 3) {
+                if (!final) return 0;
+                event.key = Key::ESCAPE;
+                return 1;
+            }
+            event.key = key_for_letter(data[2]);
+            return 3;
+        }
+        if (next == 0x1B) {
+            event.key = Key::ESCAPE;
+            return 1;
+        }
+        // ESC before a plain key is how terminals send Alt+key
+        size_t used = decode_one(data + 1, size - 1, final, event);
+        if (used == 0) return 0;
+        event.mods |= MOD_ALT;
+        return used + 1;
+    }
+    
+    if (b == '\r' || b == '\n') {
+        event.key = Key::ENTER;
+        return 1;
+    }
+    if (b == '\t') {
+        event.key = Key::TAB;
+        return 1;
+    }
+    if (b == 0x7F || b == 0x08) {
+        event.key = Key::BACKSPACE;
+        return 1;
+    }
+    if (b == 0) {
+        event.key = Key::CHAR;
+        event.codepoint = ' ';
+        event.mods = MOD_CTRL;
+        return 1;
+    }
+    if (b <= 26) {
+        event.key = Key::CHAR;
+        event.codepoint = 'a' + b - 1;
+        event.mods = MOD_CTRL;
+        return 1;
+    }
+    if (b < 0x20) {
+        event.key = Key::UNKNOWN;
+        event.mods = MOD_CTRL;
+        return 1;
+    }
+    if (b < 0x80) {
+        event.key = Key::CHAR;
+        event.codepoint = b;
+        return 1;
+    }
+    
+    // UTF-8
+    size_t length;
+    uint32_t cp;
+    if ((b & 0xE0) == 0xC0) { length = 2; cp = b & 0x1F; }
+    else if ((b & 0xF0) == 0xE0) { length = 3; cp = b & 0x0F; }
+    else if ((b & 0xF8) == 0xF0) { length = 4; cp = b & 0x07; }
+    else { length = 0; cp = 0; }
+    
+    event.key = Key::CHAR;
+    event.codepoint = 0xFFFD;
+    if (length == 0) return 1;
+    if (size < length) {
+        if (!final) return 0;
+        return 1;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if ((data[i] & 0xC0) != 0x80) return 1;
+        cp = (cp << 6) | (data[i] & 0x3F);
+    }
+    event.codepoint = cp;
+    return length;
+}
+
+} // namespace nightforge
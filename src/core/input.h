@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nightforge {
+
+class Terminal;
+
+enum class Key : uint8_t {
+    CHAR,       // printable text, see KeyEvent::codepoint
+    ENTER,
+    ESCAPE,
+    BACKSPACE,
+    TAB,
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT,
+    HOME,
+    END,
+    PAGE_UP,
+    PAGE_DOWN,
+    INSERT,
+    DELETE,
+    F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+    UNKNOWN     // a well-formed sequence we don't map (mouse, paste markers...)
+};
+
+enum KeyMod : uint8_t {
+    MOD_NONE  = 0,
+    MOD_SHIFT = 1 << 0,
+    MOD_ALT   = 1 << 1,
+    MOD_CTRL  = 1 << 2,
+};
+
+struct KeyEvent {
+    Key key = Key::UNKNOWN;
+    uint8_t mods = MOD_NONE;
+    uint32_t codepoint = 0; // for CHAR, and the letter for Ctrl+letter
+};
+
+// Reads raw terminal bytes once per frame, decodes them into key events and
+// queues those in a ring. Escape sequences and UTF-8 split across reads are
+// held back until the rest arrives. A lone ESC becomes an ESCAPE key once
+// nothing else followed it for ESCAPE_TIMEOUT_MS
+class Input {
+public:
+    // Drains everything the terminal has queued, returns the number of new events
+    size_t pump(Terminal& terminal);
+    
+    // Decodes raw bytes as if they came from the terminal
+    size_t feed(const char* data, size_t size);
+    // Decodes held back bytes as if no more will follow
+    size_t flush();
+    // flush() once held back bytes have waited ESCAPE_TIMEOUT_MS, for callers
+    // that feed() instead of pump()
+    size_t expire();
+    
+    bool next(KeyEvent& event);
+    bool empty() const { return head_ == tail_; }
+    // Bytes waiting for the rest of a sequence: keep frames coming so a
+    // lone ESC gets flushed
+    bool has_pending() const { return pending_size_ > 0; }
+    size_t dropped() const { return dropped_; }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr int ESCAPE_TIMEOUT_MS = 25;
+    static constexpr size_t MAX_PENDING = 32;  // longer unfinished sequences are junk
+    static constexpr size_t QUEUE_SIZE = 256;  // power of two
+    static constexpr size_t READ_CHUNK = 512;
+    
+    KeyEvent queue_[QUEUE_SIZE];
+    size_t head_ = 0; // next to read
+    size_t tail_ = 0; // next to write
+    size_t dropped_ = 0;
+    
+    unsigned char pending_[MAX_PENDING];
+    size_t pending_size_ = 0;
+    Clock::time_point pending_since_;
+    std::vector<unsigned char> joined_; // pending + new bytes, reused
+    
+    void push(const KeyEvent& event);
+    size_t decode(const unsigned char* data, size_t size, bool final);
+    
+    // Decodes one event from the start of data. Returns bytes consumed, or 0
+    // if the event is incomplete and final is false
+    static size_t decode_one(const unsigned char* data, size_t size, bool final, KeyEvent& event);
+};
+
+} // namespace nightforge
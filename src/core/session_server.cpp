@@ -0,0 +1,634 @@
+#include "session_server.h"
+#include "engine.h"
+#include "engine_host.h"
+#include "input.h"
+#include "../rendering/tui_renderer.h"
+#include "../rendering/ascii_art.h"
+#include "../nightscript/vm.h"
+#include "../nightscript/compiler.h"
+#include "../nightscript/stdlib/string.h"
+#include "../nightscript/stdlib/array.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <csignal>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+namespace nightforge {
+
+// Sent on connect and after quitting, the client's terminal does the rest
+static const char SESSION_START[] = "\033[2J\033[H\033[?25l";
+static const char SESSION_END[] = "\033[0m\033[2J\033[H\033[?25h";
+
+struct Session {
+    uint64_t id;
+    int fd;
+    EngineHost host;
+    nightscript::VM vm;
+    TUIRenderer renderer;
+    Input input;
+
+    // Worker side, only touched by the worker ticking the session
+    bool started = false;
+    std::string scene = "Session";
+    std::string dialog = "Welcome to NightForge. Press Q to quit.";
+    ArtRequest image; // shown instead of the shared background once converted
+    bool has_image = false;
+    std::shared_ptr<const ArtAsset> image_art; // held once ready, so eviction doesn't requeue it
+    std::string input_bytes; // inbox swapped out for decoding
+    std::atomic<bool> needs_tick{false}; // bytes held back, tick again after a timeout
+
+    std::mutex mutex;
+    std::string inbox;           // read, not decoded yet
+    std::string outbox;          // composed, not sent yet
+    size_t sent = 0;             // prefix of outbox already written
+    bool queued = false;         // in the run queue, or ticked again once running ends
+    bool running = false;        // a worker is ticking it
+    bool frame_deferred = false; // skipped composing while outbox was still full
+    bool finished = false;       // quit, close once outbox is sent
+    bool closed = false;         // fd gone, ticks are no-ops
+
+    Session(uint64_t session_id, int session_fd, int cols, int rows, size_t stack_slots)
+        : id(session_id), fd(session_fd), vm(&host, stack_slots), renderer(cols, rows) {}
+};
+
+#ifndef _WIN32
+
+static std::atomic<bool> g_stop_requested{false};
+static int g_server_wake_fd = -1;
+
+static void stop_handler(int) {
+    g_stop_requested.store(true);
+    if (g_server_wake_fd >= 0) {
+        int saved_errno = errno;
+        char byte = 1;
+        ssize_t ignored = write(g_server_wake_fd, &byte, 1);
+        (void)ignored;
+        errno = saved_errno;
+    }
+}
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+static bool is_port(const std::string& address) {
+    return !address.empty() && address.size() <= 5 &&
+           std::all_of(address.begin(), address.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+// Script-facing functions bound to one session. Nothing here blocks (no wait,
+// no stdin, no files): a worker ticking a session is shared by all of them
+static void register_session_functions(Session& session, AssetManager& assets) {
+    using namespace nightscript;
+    EngineHost* host = &session.host;
+    VM* vm = &session.vm;
+
+    stdlib::register_string_functions(host, vm);
+    stdlib::register_array_functions(host, vm);
+
+    host->register_function("show_text", [&session](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1 || args[0].type() != ValueType::STRING_ID) {
+            std::cerr << "show_text: expected string argument" << std::endl;
+            return Value::nil();
+        }
+        session.dialog = session.vm.strings().get_string(args[0].as_string_id());
+        return Value::nil();
+    });
+
+    host->register_function("show_scene", [&session](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1 || args[0].type() != ValueType::STRING_ID) {
+            std::cerr << "show_scene: expected string argument (scene name)" << std::endl;
+            return Value::nil();
+        }
+        session.scene = session.vm.strings().get_string(args[0].as_string_id());
+        return Value::nil();
+    });
+
+    // Only queues the conversion, the session keeps ticking until it's done
+    host->register_function("show_image", [&session, &assets](const std::vector<Value>& args) -> Value {
+        ArtRequest request;
+        if (!read_show_image_args(session.vm, args, session.renderer.grid().width(), request)) return Value::nil();
+        session.image_art.reset();
+        AssetState state = assets.request(request, session.image_art);
+        session.image = request;
+        session.has_image = true;
+        return Value::boolean(state != AssetState::FAILED);
+    });
+
+    host->register_function("log", [&session](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1 || args[0].type() != ValueType::STRING_ID) {
+            std::cerr << "log: expected string argument" << std::endl;
+            return Value::nil();
+        }
+        std::cout << "[session " << session.id << "] " << session.vm.strings().get_string(args[0].as_string_id()) << std::endl;
+        return Value::nil();
+    });
+
+    host->register_function("set_variable", [&session](const std::vector<Value>& args) -> Value {
+        if (args.size() != 2 || args[0].type() != ValueType::STRING_ID) {
+            std::cerr << "set_variable: expected (string, value) arguments" << std::endl;
+            return Value::nil();
+        }
+        session.vm.set_global(session.vm.strings().get_string(args[0].as_string_id()), args[1]);
+        return Value::nil();
+    });
+
+    host->register_function("get_variable", [&session](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1 || args[0].type() != ValueType::STRING_ID) {
+            std::cerr << "get_variable: expected string argument (variable name)" << std::endl;
+            return Value::nil();
+        }
+        return session.vm.get_global(session.vm.strings().get_string(args[0].as_string_id()));
+    });
+
+    host->register_function("now", [](const std::vector<Value>&) -> Value {
+        using clock = std::chrono::steady_clock;
+        auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+        return Value::floating(static_cast<double>(now_ns) / 1e9);
+    });
+}
+
+SessionServer::SessionServer(const Config& config)
+    : config_(config), assets_(config.sprites_dir, config.asset_cache_bytes) {}
+
+SessionServer::~SessionServer() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+
+    for (auto& session : sessions_) {
+        ssize_t ignored = write(session->fd, SESSION_END, sizeof(SESSION_END) - 1);
+        (void)ignored;
+        close(session->fd);
+    }
+    sessions_.clear();
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        if (!is_port(config_.serve_address)) unlink(config_.serve_address.c_str());
+    }
+    g_server_wake_fd = -1;
+    for (int fd : wake_pipe_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool SessionServer::load_shared_assets() {
+    const std::string& filename = config_.script_file;
+    if (!filename.empty()) {
+        nightscript::Compiler compiler;
+        if (!compiler.load_cached_bytecode(filename, shared_.script, shared_.strings)) {
+            std::ifstream file(filename);
+            if (!file.is_open()) {
+                std::cerr << "Error: Could not open script file: " << filename << std::endl;
+                return false;
+            }
+            std::stringstream source;
+            source << file.rdbuf();
+            if (!compiler.compile(source.str(), shared_.script, shared_.strings)) {
+                std::cerr << "Error: Compilation failed: " << filename << std::endl;
+                return false;
+            }
+            compiler.save_bytecode_cache(filename, shared_.script, shared_.strings);
+        }
+        shared_.has_script = true;
+    }
+
+    if (config_.serve_art.empty()) {
+        shared_.background = test_scene_art();
+        return true;
+    }
+    try {
+        ascii_art::Interpreter converter;
+        converter.set_target_size(std::max(1, config_.headless_cols));
+        shared_.background = converter.convert_from_file(config_.serve_art);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SessionServer::open_listener() {
+    const std::string& address = config_.serve_address;
+
+    if (is_port(address)) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            std::cerr << "Error: socket: " << strerror(errno) << std::endl;
+            return false;
+        }
+        int on = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        // Loopback only, put a proxy in front to expose it
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(std::atoi(address.c_str())));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "Error: bind 127.0.0.1:" << address << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+    } else {
+        sockaddr_un addr{};
+        if (address.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Error: socket path too long: " << address << std::endl;
+            return false;
+        }
+        // A socket left behind by a previous run, never anything else
+        struct stat st;
+        if (lstat(address.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            unlink(address.c_str());
+        }
+
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            std::cerr << "Error: socket: " << strerror(errno) << std::endl;
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, address.c_str(), address.size() + 1);
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "Error: bind " << address << ": " << strerror(errno) << std::endl;
+            close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+    }
+
+    if (listen(listen_fd_, 64) < 0) {
+        std::cerr << "Error: listen: " << strerror(errno) << std::endl;
+        return false;
+    }
+    set_nonblocking(listen_fd_);
+    return true;
+}
+
+int SessionServer::run() {
+    if (!load_shared_assets() || !open_listener()) return 1;
+
+    if (pipe(wake_pipe_) != 0) {
+        std::cerr << "Error: pipe: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    for (int fd : wake_pipe_) set_nonblocking(fd);
+    g_server_wake_fd = wake_pipe_[1];
+
+    // No SA_RESTART so a signal also ends the poll
+    struct sigaction sa{};
+    sa.sa_handler = stop_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN); // a client hanging up mid-write shows up as EPIPE
+
+    int worker_count = config_.serve_workers;
+    if (worker_count <= 0) worker_count = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+
+    std::cout << "Serving on " << (is_port(config_.serve_address) ? "127.0.0.1:" : "") << config_.serve_address
+              << " with " << worker_count << " workers" << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const auto tick_interval = std::chrono::milliseconds(std::max(1, 1000 / std::max(1, config_.target_fps)));
+    auto next_timed_tick = Clock::now() + tick_interval;
+
+    std::vector<pollfd> fds;
+    while (!g_stop_requested.load()) {
+        // [0] wake pipe, [1] listener, [2 + i] sessions_[i]
+        fds.clear();
+        fds.push_back({wake_pipe_[0], POLLIN, 0});
+        bool accepting = sessions_.size() < static_cast<size_t>(std::max(1, config_.max_sessions));
+        fds.push_back({accepting ? listen_fd_ : -1, POLLIN, 0});
+
+        bool timed = false;
+        for (auto& session : sessions_) {
+            short events = POLLIN;
+            {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                if (session->outbox.size() > session->sent) events |= POLLOUT;
+            }
+            fds.push_back({session->fd, events, 0});
+            timed = timed || session->needs_tick.load();
+        }
+
+        int timeout = -1;
+        if (timed) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_timed_tick - Clock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(0, wait));
+        }
+
+        int ready = poll(fds.data(), fds.size(), timeout);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "Error: poll: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(wake_pipe_[0], drain, sizeof(drain)) > 0) {}
+        }
+
+        // Sessions holding back an ESC get ticked so it turns into a key
+        auto now = Clock::now();
+        if (now >= next_timed_tick) {
+            for (auto& session : sessions_) {
+                if (session->needs_tick.load()) schedule(session);
+            }
+            next_timed_tick = now + tick_interval;
+        }
+
+        // Backwards so closing swaps in a session that was already handled
+        for (size_t i = sessions_.size(); i-- > 0;) {
+            std::shared_ptr<Session>& session = sessions_[i];
+            short revents = ready > 0 ? fds[2 + i].revents : 0;
+
+            if ((revents & (POLLIN | POLLHUP | POLLERR)) && !read_input(session)) {
+                close_session(i);
+                continue;
+            }
+            if (!flush_output(session)) {
+                close_session(i);
+                continue;
+            }
+
+            bool done;
+            {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                done = session->finished && session->sent == session->outbox.size();
+            }
+            if (done) close_session(i);
+        }
+
+        if (fds[1].revents & POLLIN) accept_sessions();
+    }
+
+    std::cout << "Server stopping, " << sessions_.size() << " sessions open" << std::endl;
+    return 0;
+}
+
+void SessionServer::accept_sessions() {
+    size_t limit = static_cast<size_t>(std::max(1, config_.max_sessions));
+    while (sessions_.size() < limit) {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "accept: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        set_nonblocking(fd);
+        if (is_port(config_.serve_address)) {
+            int on = 1; // frames go out in one write, don't hold them back
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        int cols = config_.headless_cols > 0 ? config_.headless_cols : 120;
+        int rows = config_.headless_rows > 0 ? config_.headless_rows : 40;
+        size_t stack_slots = static_cast<size_t>(std::max(256, config_.session_stack_slots));
+        auto session = std::make_shared<Session>(next_session_id_++, fd, cols, rows, stack_slots);
+
+        // The chunk is shared between threads, its JIT state must never change
+        session->vm.set_jit_enabled(false);
+        // A runaway script would hold its worker, and shutdown joins the workers
+        session->vm.set_step_budget(static_cast<uint64_t>(std::max(1000LL, config_.session_steps)));
+        session->vm.strings() = shared_.strings;
+        register_session_functions(*session, assets_);
+        session->outbox.assign(SESSION_START, sizeof(SESSION_START) - 1);
+
+        sessions_.push_back(session);
+        std::cout << "[session " << session->id << "] connected (" << sessions_.size() << " open)" << std::endl;
+        schedule(session);
+    }
+}
+
+void SessionServer::close_session(size_t index) {
+    std::shared_ptr<Session> session = sessions_[index];
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->closed = true;
+    }
+    close(session->fd);
+    sessions_[index] = sessions_.back();
+    sessions_.pop_back();
+    std::cout << "[session " << session->id << "] closed (" << sessions_.size() << " open)" << std::endl;
+}
+
+bool SessionServer::read_input(const std::shared_ptr<Session>& s) {
+    Session& session = *s;
+    // More than this unread means the client isn't a person typing
+    static constexpr size_t MAX_INBOX = 64 * 1024;
+
+    char buffer[4096];
+    bool got_input = false;
+    for (;;) {
+        ssize_t n = read(session.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            size_t room = MAX_INBOX - std::min(MAX_INBOX, session.inbox.size());
+            session.inbox.append(buffer, std::min(room, static_cast<size_t>(n)));
+            got_input = true;
+            continue;
+        }
+        if (n == 0) return false; // hung up
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        return false;
+    }
+
+    if (got_input) schedule(s);
+    return true;
+}
+
+bool SessionServer::flush_output(const std::shared_ptr<Session>& s) {
+    Session& session = *s;
+    bool reschedule = false;
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        while (session.sent < session.outbox.size()) {
+            ssize_t n = write(session.fd, session.outbox.data() + session.sent, session.outbox.size() - session.sent);
+            if (n > 0) {
+                session.sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true; // POLLOUT picks it up
+            return false;
+        }
+        if (session.sent == 0) return true;
+
+        // All sent: keep the capacity for the next frame
+        session.outbox.clear();
+        session.sent = 0;
+        reschedule = session.frame_deferred;
+        session.frame_deferred = false;
+    }
+
+    if (reschedule) schedule(s);
+    return true;
+}
+
+void SessionServer::schedule(const std::shared_ptr<Session>& session) {
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->queued || session->closed) return;
+        session->queued = true;
+        if (session->running) return; // the worker queues it again when done
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        run_queue_.push_back(session);
+    }
+    queue_cv_.notify_one();
+}
+
+void SessionServer::worker_loop() {
+    for (;;) {
+        std::shared_ptr<Session> session;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !run_queue_.empty(); });
+            if (stopping_) return;
+            session = std::move(run_queue_.front());
+            run_queue_.pop_front();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->queued = false;
+            session->running = true;
+        }
+
+        tick(*session);
+
+        bool again;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->running = false;
+            again = session->queued && !session->closed;
+        }
+        if (again) {
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                run_queue_.push_back(session);
+            }
+            queue_cv_.notify_one();
+        }
+    }
+}
+
+void SessionServer::tick(Session& session) {
+    session.input_bytes.clear();
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        if (session.closed) return;
+        session.input_bytes.swap(session.inbox);
+    }
+
+    if (!session.started) {
+        session.started = true;
+        if (shared_.has_script && session.vm.execute(shared_.script) != nightscript::VMResult::OK) {
+            session.dialog = "Script error.";
+        }
+    }
+
+    session.input.feed(session.input_bytes.data(), session.input_bytes.size());
+    session.input.expire();
+    session.needs_tick.store(session.input.has_pending());
+
+    bool quit = false;
+    KeyEvent event;
+    while (session.input.next(event)) {
+        if (event.key != Key::CHAR || (event.mods & (MOD_CTRL | MOD_ALT))) continue;
+        if (event.codepoint == 'q' || event.codepoint == 'Q') quit = true;
+    }
+
+    if (quit) {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        session.outbox.append(SESSION_END, sizeof(SESSION_END) - 1);
+        session.finished = true;
+        session.needs_tick.store(false);
+    } else {
+        {
+            // The client is still behind, the grid catches up once it drains
+            std::lock_guard<std::mutex> lock(session.mutex);
+            if (session.finished) return;
+            if (session.sent < session.outbox.size()) {
+                session.frame_deferred = true;
+                return;
+            }
+        }
+
+        TUIRenderer& renderer = session.renderer;
+        renderer.clear();
+        AssetState image_state = AssetState::FAILED;
+        if (session.image_art) image_state = AssetState::READY;
+        else if (session.has_image) image_state = assets_.request(session.image, session.image_art);
+        if (image_state == AssetState::READY) {
+            const ArtAsset& image = *session.image_art;
+            renderer.draw_background_runs(session.image.key(), image.cols, image.rows, image.runs);
+        } else {
+            renderer.draw_background(shared_.background);
+            if (image_state == AssetState::PENDING) session.needs_tick.store(true);
+        }
+        renderer.draw_status_bar(session.scene, false);
+        renderer.draw_dialog_box(session.dialog);
+        renderer.compose();
+
+        Grid& grid = renderer.grid();
+        if (!grid.compose_frame()) return;
+        std::lock_guard<std::mutex> lock(session.mutex);
+        session.outbox.append(grid.frame_data(), grid.frame_size());
+    }
+    wake();
+}
+
+void SessionServer::wake() {
+    char byte = 1;
+    ssize_t ignored = write(wake_pipe_[1], &byte, 1);
+    (void)ignored;
+}
+
+#else // _WIN32
+
+SessionServer::SessionServer(const Config& config)
+    : config_(config), assets_(config.sprites_dir, config.asset_cache_bytes) {}
+SessionServer::~SessionServer() = default;
+
+int SessionServer::run() {
+    std::cerr << "Error: --serve needs a POSIX system" << std::endl;
+    return 1;
+}
+
+#endif
+
+} // namespace nightforge
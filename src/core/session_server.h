@@ -0,0 +1,74 @@
+#pragma once
+#include "config.h"
+#include "asset_manager.h"
+#include "../nightscript/value.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nightforge {
+
+// Loaded once at startup and only read afterwards, every session uses the
+// same copy. Session VMs start from a copy of strings so the ids baked into
+// the script's constants mean the same thing in each of them
+struct SharedAssets {
+    bool has_script = false;
+    nightscript::Chunk script;
+    nightscript::StringTable strings;
+    std::string background; // converted art
+};
+
+struct Session;
+
+// Hosts many independent sessions in one process. Each connection gets its
+// own VM, renderer and input decoder, all sharing SharedAssets.
+// One event loop thread owns the sockets: it accepts, reads input into the
+// sessions' inboxes and writes their pending output without blocking.
+// Worker threads tick sessions that have something to do (input, a first
+// frame, a held back ESC) and leave the frame bytes for the loop to send.
+// A session is ticked by one worker at a time, and a session whose last
+// frame hasn't been sent yet skips composing so slow clients get fewer
+// frames instead of queueing them
+class SessionServer {
+public:
+    explicit SessionServer(const Config& config);
+    ~SessionServer();
+
+    // Serves until SIGINT/SIGTERM, returns the exit code
+    int run();
+
+private:
+    Config config_;
+    SharedAssets shared_;
+    AssetManager assets_; // show_image art, one cache for every session
+
+    int listen_fd_ = -1;
+    int wake_pipe_[2] = {-1, -1};
+    uint64_t next_session_id_ = 1;
+    std::vector<std::shared_ptr<Session>> sessions_; // event loop thread only
+
+    std::vector<std::thread> workers_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<std::shared_ptr<Session>> run_queue_; // guarded by queue_mutex_
+    bool stopping_ = false;                          // guarded by queue_mutex_
+
+    bool load_shared_assets();
+    bool open_listener();
+    void accept_sessions();
+    void close_session(size_t index);
+    bool read_input(const std::shared_ptr<Session>& session);
+    bool flush_output(const std::shared_ptr<Session>& session);
+
+    void schedule(const std::shared_ptr<Session>& session);
+    void worker_loop();
+    void tick(Session& session);
+    void wake();
+};
+
+} // namespace nightforge
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 namespace nightforge {
@@ -20,8 +21,23 @@ public:
     
     virtual bool check_size(int min_cols, int min_rows, TerminalSize& current) = 0;
     
+    // True once after each resize (and on the first call), so the size only
+    // has to be queried when it actually changed
+    virtual bool consume_resize() = 0;
+    
     virtual bool read_input(char& c) = 0;
     
+    // Reads whatever input is pending right now without blocking, returns the byte count.
+    // Special keys come through as VT escape sequences on every platform
+    virtual size_t read_available(char* buffer, size_t capacity) = 0;
+    
+    // Block until input is ready or timeout_ms passes (< 0 waits forever).
+    // Returns true if input is ready, false on timeout, wake() or an interrupting signal
+    virtual bool wait_input(int timeout_ms) = 0;
+    
+    // Ends a wait_input early, safe to call from any thread
+    virtual void wake() = 0;
+    
     virtual void sleep_ms(int ms) = 0;
     
     virtual void clear_screen() = 0;
@@ -31,6 +47,9 @@ public:
     
     virtual void home_cursor() = 0;
     
+    // Send a whole frame of output in as few syscalls as the platform allows
+    virtual bool write_output(const char* data, size_t size) = 0;
+    
     virtual bool is_initialized() const = 0;
 };
 
@@ -0,0 +1,300 @@
+#include "terminal_headless.h"
+#include <algorithm>
+#include <cstring>
+
+namespace nightforge {
+
+TerminalHeadless::TerminalHeadless(int cols, int rows)
+    : cols_(std::max(1, cols)), rows_(std::max(1, rows)), cells_(static_cast<size_t>(cols_) * rows_) {
+}
+
+bool TerminalHeadless::init() {
+    initialized_ = true;
+    return true;
+}
+
+void TerminalHeadless::cleanup() {
+    // Leaves the screen as it is so it can still be inspected
+    initialized_ = false;
+}
+
+bool TerminalHeadless::get_size(TerminalSize& size) {
+    size.cols = cols_;
+    size.rows = rows_;
+    return true;
+}
+
+bool TerminalHeadless::check_size(int min_cols, int min_rows, TerminalSize& current) {
+    get_size(current);
+    return current.cols >= min_cols && current.rows >= min_rows;
+}
+
+bool TerminalHeadless::consume_resize() {
+    bool pending = resize_pending_;
+    resize_pending_ = false;
+    return pending;
+}
+
+bool TerminalHeadless::read_input(char& c) {
+    if (input_pos_ >= input_.size()) return false;
+    c = input_[input_pos_++];
+    return true;
+}
+
+size_t TerminalHeadless::read_available(char* buffer, size_t capacity) {
+    size_t count = std::min(capacity, input_.size() - input_pos_);
+    std::memcpy(buffer, input_.data() + input_pos_, count);
+    input_pos_ += count;
+    if (input_pos_ == input_.size()) {
+        input_.clear();
+        input_pos_ = 0;
+    }
+    return count;
+}
+
+bool TerminalHeadless::wait_input(int) {
+    return input_pos_ < input_.size(); // never sleeps
+}
+
+void TerminalHeadless::wake() {
+}
+
+void TerminalHeadless::sleep_ms(int) {
+    // Headless runs as fast as possible
+}
+
+void TerminalHeadless::clear_screen() {
+    feed("\033[2J", 4);
+}
+
+void TerminalHeadless::hide_cursor() {
+}
+
+void TerminalHeadless::show_cursor() {
+}
+
+void TerminalHeadless::home_cursor() {
+    feed("\033[H", 3);
+}
+
+bool TerminalHeadless::write_output(const char* data, size_t size) {
+    bytes_written_ += size;
+    ++writes_;
+    feed(data, size);
+    return true;
+}
+
+bool TerminalHeadless::is_initialized() const {
+    return initialized_;
+}
+
+void TerminalHeadless::push_input(const std::string& bytes) {
+    input_ += bytes;
+}
+
+void TerminalHeadless::resize(int cols, int rows) {
+    cols_ = std::max(1, cols);
+    rows_ = std::max(1, rows);
+    // Real terminals reflow, a blank screen is the honest worst case
+    cells_.assign(static_cast<size_t>(cols_) * rows_, Cell());
+    cursor_x_ = std::min(cursor_x_, cols_ - 1);
+    cursor_y_ = std::min(cursor_y_, rows_ - 1);
+    resize_pending_ = true;
+}
+
+std::string TerminalHeadless::row_text(int y) const {
+    std::string text;
+    for (int x = 0; x < cols_; ++x) {
+        uint32_t cp = codepoint_at(x, y);
+        if (cp < 0x80) {
+            text += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            text += static_cast<char>(0xC0 | (cp >> 6));
+            text += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            text += static_cast<char>(0xE0 | (cp >> 12));
+            text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            text += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            text += static_cast<char>(0xF0 | (cp >> 18));
+            text += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            text += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return text;
+}
+
+uint64_t TerminalHeadless::screen_hash() const {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            hash ^= (v >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    };
+    mix(static_cast<uint32_t>(cols_));
+    mix(static_cast<uint32_t>(rows_));
+    for (const Cell& cell : cells_) {
+        mix(cell.codepoint);
+        mix(cell.style.fg);
+        mix(cell.style.bg);
+        mix(cell.style.attrs);
+    }
+    return hash;
+}
+
+void TerminalHeadless::put(uint32_t codepoint) {
+    if (cursor_x_ >= cols_) {
+        // Pending wrap, like xterm's autowrap
+        cursor_x_ = 0;
+        if (cursor_y_ < rows_ - 1) ++cursor_y_;
+    }
+    Cell& cell = cells_[cursor_y_ * cols_ + cursor_x_];
+    cell.codepoint = codepoint;
+    cell.style = pen_;
+    ++cursor_x_;
+}
+
+void TerminalHeadless::feed(const char* data, size_t size) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    
+    for (; p < end; ++p) {
+        unsigned char b = *p;
+        
+        switch (state_) {
+            case ParseState::GROUND:
+                if (utf8_remaining_ > 0) {
+                    if ((b & 0xC0) == 0x80) {
+                        utf8_codepoint_ = (utf8_codepoint_ << 6) | (b & 0x3F);
+                        if (--utf8_remaining_ == 0) put(utf8_codepoint_);
+                        continue;
+                    }
+                    utf8_remaining_ = 0;
+                    put(0xFFFD); // broken sequence, this byte is handled normally below
+                }
+                if (b == 0x1B) {
+                    state_ = ParseState::ESCAPE;
+                } else if (b == '\r') {
+                    cursor_x_ = 0;
+                } else if (b == '\n') {
+                    if (cursor_y_ < rows_ - 1) ++cursor_y_;
+                } else if (b == '\b') {
+                    if (cursor_x_ > 0) --cursor_x_;
+                } else if (b < 0x20) {
+                    // other controls don't touch the screen
+                } else if (b < 0x80) {
+                    put(b);
+                } else if ((b & 0xE0) == 0xC0) {
+                    utf8_codepoint_ = b & 0x1F;
+                    utf8_remaining_ = 1;
+                } else if ((b & 0xF0) == 0xE0) {
+                    utf8_codepoint_ = b & 0x0F;
+                    utf8_remaining_ = 2;
+                } else if ((b & 0xF8) == 0xF0) {
+                    utf8_codepoint_ = b & 0x07;
+                    utf8_remaining_ = 3;
+                } else {
+                    put(0xFFFD);
+                }
+                break;
+                
+            case ParseState::ESCAPE:
+                if (b == '[') {
+                    state_ = ParseState::CSI;
+                    param_count_ = 0;
+                    private_marker_ = false;
+                    std::fill(params_, params_ + MAX_PARAMS, 0);
+                } else {
+                    state_ = ParseState::GROUND; // two-byte escapes aren't used by the renderer
+                }
+                break;
+                
+            case ParseState::CSI:
+                if (b >= '0' && b <= '9') {
+                    if (param_count_ == 0) param_count_ = 1;
+                    int& param = params_[param_count_ - 1];
+                    if (param < 100000) param = param * 10 + (b - '0');
+                } else if (b == ';') {
+                    if (param_count_ == 0) param_count_ = 1;
+                    if (param_count_ < MAX_PARAMS) ++param_count_;
+                } else if (b >= 0x3C && b <= 0x3F) {
+                    private_marker_ = true;
+                } else if (b >= 0x40 && b <= 0x7E) {
+                    if (!private_marker_) run_csi(b);
+                    state_ = ParseState::GROUND;
+                } else if (b < 0x20 || b > 0x7E) {
+                    state_ = ParseState::GROUND; // aborted sequence
+                }
+                break;
+        }
+    }
+}
+
+void TerminalHeadless::run_csi(unsigned char final) {
+    auto param = [this](int i, int fallback) {
+        return (i < param_count_ && params_[i] > 0) ? params_[i] : fallback;
+    };
+    
+    switch (final) {
+        case 'H':
+        case 'f':
+            cursor_y_ = std::min(param(0, 1), rows_) - 1;
+            cursor_x_ = std::min(param(1, 1), cols_) - 1;
+            break;
+        case 'A': cursor_y_ = std::max(0, cursor_y_ - param(0, 1)); break;
+        case 'B': cursor_y_ = std::min(rows_ - 1, cursor_y_ + param(0, 1)); break;
+        case 'C': cursor_x_ = std::min(cols_ - 1, cursor_x_ + param(0, 1)); break;
+        case 'D': cursor_x_ = std::max(0, cursor_x_ - param(0, 1)); break;
+        case 'J':
+            if (param_count_ > 0 && params_[0] == 2) {
+                std::fill(cells_.begin(), cells_.end(), Cell());
+            }
+            break;
+        case 'm':
+            apply_sgr();
+            break;
+        default:
+            break;
+    }
+}
+
+void TerminalHeadless::apply_sgr() {
+    if (param_count_ == 0) {
+        pen_ = Style();
+        return;
+    }
+    for (int i = 0; i < param_count_; ++i) {
+        int p = params_[i];
+        switch (p) {
+            case 0: pen_ = Style(); break;
+            case 1: pen_.attrs |= ATTR_BOLD; break;
+            case 2: pen_.attrs |= ATTR_DIM; break;
+            case 3: pen_.attrs |= ATTR_ITALIC; break;
+            case 4: pen_.attrs |= ATTR_UNDERLINE; break;
+            case 7: pen_.attrs |= ATTR_REVERSE; break;
+            case 22: pen_.attrs &= ~(ATTR_BOLD | ATTR_DIM); break;
+            case 23: pen_.attrs &= ~ATTR_ITALIC; break;
+            case 24: pen_.attrs &= ~ATTR_UNDERLINE; break;
+            case 27: pen_.attrs &= ~ATTR_REVERSE; break;
+            case 39: pen_.fg = DEFAULT_COLOR; break;
+            case 49: pen_.bg = DEFAULT_COLOR; break;
+            case 38:
+            case 48:
+                // Only truecolor (38;2;r;g;b), which is all the renderer emits
+                if (i + 4 < param_count_ && params_[i + 1] == 2) {
+                    uint32_t color = rgb(static_cast<uint8_t>(params_[i + 2]), static_cast<uint8_t>(params_[i + 3]),
+                                         static_cast<uint8_t>(params_[i + 4]));
+                    if (p == 38) pen_.fg = color;
+                    else pen_.bg = color;
+                    i += 4;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+} // namespace nightforge
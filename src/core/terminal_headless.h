@@ -0,0 +1,87 @@
+#pragma once
+#include "terminal.h"
+#include "../rendering/tui_renderer.h"
+#include <string>
+#include <vector>
+
+namespace nightforge {
+
+// A terminal with no TTY behind it: output is parsed by a small VT parser
+// into an in-memory screen, input comes from push_input. Nothing ever blocks,
+// so the engine loop runs as fast as it can. Used for benchmarks, CI and
+// server-side sessions
+class TerminalHeadless : public Terminal {
+public:
+    TerminalHeadless(int cols, int rows);
+    
+    bool init() override;
+    void cleanup() override;
+    bool get_size(TerminalSize& size) override;
+    bool check_size(int min_cols, int min_rows, TerminalSize& current) override;
+    bool consume_resize() override;
+    bool read_input(char& c) override;
+    size_t read_available(char* buffer, size_t capacity) override;
+    bool wait_input(int timeout_ms) override;
+    void wake() override;
+    void sleep_ms(int ms) override;
+    void clear_screen() override;
+    void hide_cursor() override;
+    void show_cursor() override;
+    void home_cursor() override;
+    bool write_output(const char* data, size_t size) override;
+    bool is_initialized() const override;
+    
+    // Driver side
+    void push_input(const std::string& bytes);
+    void resize(int cols, int rows);
+    
+    // Virtual screen
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+    uint32_t codepoint_at(int x, int y) const { return cells_[y * cols_ + x].codepoint; }
+    Style style_at(int x, int y) const { return cells_[y * cols_ + x].style; }
+    std::string row_text(int y) const; // UTF-8
+    uint64_t screen_hash() const;      // FNV-1a over every cell, stable across runs
+    
+    size_t bytes_written() const { return bytes_written_; }
+    size_t writes() const { return writes_; }
+    
+private:
+    struct Cell {
+        uint32_t codepoint = ' ';
+        Style style;
+    };
+    
+    enum class ParseState : uint8_t { GROUND, ESCAPE, CSI };
+    
+    static constexpr int MAX_PARAMS = 16;
+    
+    int cols_;
+    int rows_;
+    std::vector<Cell> cells_;
+    bool initialized_ = false;
+    bool resize_pending_ = true;
+    
+    // Parser state survives across writes, sequences may be split
+    ParseState state_ = ParseState::GROUND;
+    int params_[MAX_PARAMS];
+    int param_count_ = 0;
+    bool private_marker_ = false;
+    uint32_t utf8_codepoint_ = 0;
+    int utf8_remaining_ = 0;
+    int cursor_x_ = 0;
+    int cursor_y_ = 0;
+    Style pen_;
+    
+    std::string input_;
+    size_t input_pos_ = 0;
+    size_t bytes_written_ = 0;
+    size_t writes_ = 0;
+    
+    void feed(const char* data, size_t size);
+    void put(uint32_t codepoint);
+    void run_csi(unsigned char final);
+    void apply_sgr();
+};
+
+} // namespace nightforge
@@ -1,26 +1,56 @@
 #include "terminal_posix.h"
 #include <termios.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <csignal>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
+#include <atomic>
 
 namespace nightforge {
 
 static TerminalPosix* g_terminal_instance = nullptr;
 
+// Set by SIGWINCH, starts set so the first frame queries the size
+static std::atomic<bool> g_resize_pending{true};
+static int g_wake_fd = -1;
+
 static void signal_handler(int sig) {
-    if (g_terminal_instance && sig == SIGWINCH) {
-        // Terminal resize signal - handled by get_size() calls
+    if (sig == SIGWINCH) {
+        g_resize_pending.store(true);
+        // Self-pipe: ends a wait_input so the resize is handled right away
+        if (g_wake_fd >= 0) {
+            int saved_errno = errno;
+            char byte = 1;
+            ssize_t ignored = write(g_wake_fd, &byte, 1);
+            (void)ignored;
+            errno = saved_errno;
+        }
     }
 }
 
 TerminalPosix::TerminalPosix() : initialized_(false) {
     g_terminal_instance = this;
+    if (pipe(wake_pipe_) == 0) {
+        for (int fd : wake_pipe_) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        g_wake_fd = wake_pipe_[1];
+    } else {
+        wake_pipe_[0] = wake_pipe_[1] = -1;
+    }
 }
 
 TerminalPosix::~TerminalPosix() {
     cleanup();
+    g_wake_fd = -1;
+    for (int fd : wake_pipe_) {
+        if (fd >= 0) close(fd);
+    }
     g_terminal_instance = nullptr;
 }
 
@@ -29,7 +59,12 @@ bool TerminalPosix::init() {
         return true;
     }
     
-    signal(SIGWINCH, signal_handler);
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = signal_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0; // no SA_RESTART, a blocking wait should see EINTR too
+    sigaction(SIGWINCH, &action, nullptr);
     
     struct termios term;
     if (tcgetattr(STDIN_FILENO, &term) != 0) {
@@ -76,6 +111,10 @@ bool TerminalPosix::get_size(TerminalSize& size) {
     return true;
 }
 
+bool TerminalPosix::consume_resize() {
+    return g_resize_pending.exchange(false);
+}
+
 bool TerminalPosix::check_size(int min_cols, int min_rows, TerminalSize& current) {
     if (!get_size(current)) {
         return false;
@@ -89,6 +128,42 @@ bool TerminalPosix::read_input(char& c) {
     return result > 0;
 }
 
+size_t TerminalPosix::read_available(char* buffer, size_t capacity) {
+    // VMIN/VTIME are 0, so this returns straight away with whatever is queued
+    ssize_t result;
+    do {
+        result = read(STDIN_FILENO, buffer, capacity);
+    } while (result < 0 && errno == EINTR);
+    return result > 0 ? static_cast<size_t>(result) : 0;
+}
+
+bool TerminalPosix::wait_input(int timeout_ms) {
+    struct pollfd fds[2];
+    fds[0].fd = STDIN_FILENO;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = wake_pipe_[0]; // poll skips it if the pipe couldn't be made
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    
+    // EINTR (SIGWINCH) just returns false so the caller rechecks the size
+    if (poll(fds, 2, timeout_ms) <= 0) return false;
+    
+    if (fds[1].revents & POLLIN) {
+        char drain[64];
+        while (read(wake_pipe_[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+    return (fds[0].revents & POLLIN) != 0;
+}
+
+void TerminalPosix::wake() {
+    if (wake_pipe_[1] < 0) return;
+    char byte = 1;
+    ssize_t ignored = write(wake_pipe_[1], &byte, 1); // full pipe means a wake is already pending
+    (void)ignored;
+}
+
 void TerminalPosix::sleep_ms(int ms) {
     usleep(ms * 1000);
 }
@@ -113,6 +188,28 @@ void TerminalPosix::home_cursor() {
     fflush(stdout);
 }
 
+bool TerminalPosix::write_output(const char* data, size_t size) {
+    // Anything still sitting in stdio has to go out first to keep the order
+    fflush(stdout);
+    
+    // One write(2) per frame; the loop only runs again on a partial write
+    while (size > 0) {
+        ssize_t n = write(STDOUT_FILENO, data, size);
+        if (n > 0) {
+            data += n;
+            size -= static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = {STDOUT_FILENO, POLLOUT, 0};
+            poll(&pfd, 1, -1);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool TerminalPosix::is_initialized() const {
     return initialized_;
 }
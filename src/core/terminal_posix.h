@@ -13,17 +13,23 @@ public:
     void cleanup() override;
     bool get_size(TerminalSize& size) override;
     bool check_size(int min_cols, int min_rows, TerminalSize& current) override;
+    bool consume_resize() override;
     bool read_input(char& c) override;
+    size_t read_available(char* buffer, size_t capacity) override;
+    bool wait_input(int timeout_ms) override;
+    void wake() override;
     void sleep_ms(int ms) override;
     void clear_screen() override;
     void hide_cursor() override;
     void show_cursor() override;
     void home_cursor() override;
+    bool write_output(const char* data, size_t size) override;
     bool is_initialized() const override;
     
 private:
     bool initialized_;
     struct termios original_termios_;
+    int wake_pipe_[2] = {-1, -1}; // wake() writes a byte, wait_input polls the read end
 };
 
 } // namespace nightforge
\ No newline at end of file
@@ -19,6 +19,9 @@ TerminalWin::TerminalWin() : initialized_(false), stdin_handle_(INVALID_HANDLE_V
 
 TerminalWin::~TerminalWin() {
     cleanup();
+    if (wake_event_) {
+        CloseHandle(wake_event_);
+    }
 }
 
 bool TerminalWin::init() {
@@ -26,6 +29,9 @@ bool TerminalWin::init() {
         return true;
     }
     
+    if (!wake_event_) {
+        wake_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr); // auto-reset
+    }
     stdin_handle_ = GetStdHandle(STD_INPUT_HANDLE);
     stdout_handle_ = GetStdHandle(STD_OUTPUT_HANDLE);
     
@@ -40,6 +46,9 @@ bool TerminalWin::init() {
     
     DWORD input_mode = original_stdin_mode_;
     input_mode &= ~(ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT);
+    // Resizes show up as WINDOW_BUFFER_SIZE_EVENT records, which is what ends
+    // an idle wait_input(-1) when the console changes size
+    input_mode |= ENABLE_WINDOW_INPUT;
     if (!SetConsoleMode(stdin_handle_, input_mode)) {
         return false;
     }
@@ -97,6 +106,15 @@ bool TerminalWin::check_size(int min_cols, int min_rows, TerminalSize& current)
     return current.cols >= min_cols && current.rows >= min_rows;
 }
 
+bool TerminalWin::consume_resize() {
+    // Resize events only wake wait_input, so compare sizes (no ioctl-style cost here)
+    TerminalSize size;
+    if (!get_size(size)) return false;
+    if (size.cols == last_size_.cols && size.rows == last_size_.rows) return false;
+    last_size_ = size;
+    return true;
+}
+
 bool TerminalWin::read_input(char& c) {
     if (_kbhit()) {
         c = _getch();
@@ -105,6 +123,76 @@ bool TerminalWin::read_input(char& c) {
     return false;
 }
 
+// _getch reports special keys as a 0 or 0xE0 prefix plus a scan code,
+// translated to the sequences a VT terminal would send
+static const char* vt_sequence_for_scan_code(int code) {
+    switch (code) {
+        case 72: return "\033[A";   // up
+        case 80: return "\033[B";   // down
+        case 77: return "\033[C";   // right
+        case 75: return "\033[D";   // left
+        case 71: return "\033[H";   // home
+        case 79: return "\033[F";   // end
+        case 73: return "\033[5~";  // page up
+        case 81: return "\033[6~";  // page down
+        case 82: return "\033[2~";  // insert
+        case 83: return "\033[3~";  // delete
+        case 59: return "\033OP";   // F1-F4
+        case 60: return "\033OQ";
+        case 61: return "\033OR";
+        case 62: return "\033OS";
+        case 63: return "\033[15~"; // F5-F10
+        case 64: return "\033[17~";
+        case 65: return "\033[18~";
+        case 66: return "\033[19~";
+        case 67: return "\033[20~";
+        case 68: return "\033[21~";
+        case 133: return "\033[23~"; // F11, F12
+        case 134: return "\033[24~";
+        default: return nullptr;
+    }
+}
+
+size_t TerminalWin::read_available(char* buffer, size_t capacity) {
+    size_t count = 0;
+    // Leave room for the longest translated sequence
+    while (count + 5 <= capacity && _kbhit()) {
+        int c = _getch();
+        if (c == 0 || c == 0xE0) {
+            const char* seq = vt_sequence_for_scan_code(_getch());
+            while (seq && *seq) buffer[count++] = *seq++;
+        } else {
+            buffer[count++] = static_cast<char>(c);
+        }
+    }
+    return count;
+}
+
+void TerminalWin::wake() {
+    if (wake_event_) {
+        SetEvent(wake_event_);
+    }
+}
+
+bool TerminalWin::wait_input(int timeout_ms) {
+    // The console handle is signaled for any console event (resize, focus,
+    // mouse), only report real keys
+    DWORD timeout = timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms);
+    HANDLE handles[2] = {stdin_handle_, wake_event_};
+    DWORD count = wake_event_ ? 2 : 1;
+    if (WaitForMultipleObjects(count, handles, FALSE, timeout) != WAIT_OBJECT_0) return false;
+    // Drop the non-key events at the head of the queue, otherwise the handle
+    // stays signaled. A key that arrives meanwhile stays queued for _getch
+    INPUT_RECORD record;
+    DWORD read = 0;
+    while (PeekConsoleInput(stdin_handle_, &record, 1, &read) && read == 1) {
+        if (record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown) return true;
+        ReadConsoleInput(stdin_handle_, &record, 1, &read);
+        if (record.EventType == WINDOW_BUFFER_SIZE_EVENT) break; // consume_resize picks it up
+    }
+    return false;
+}
+
 void TerminalWin::sleep_ms(int ms) {
     Sleep(ms);
 }
@@ -178,6 +266,21 @@ void TerminalWin::home_cursor() {
     }
 }
 
+bool TerminalWin::write_output(const char* data, size_t size) {
+    fflush(stdout);
+    
+    while (size > 0) {
+        DWORD chunk = size > 0x7FFFFFFF ? 0x7FFFFFFF : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(stdout_handle_, data, chunk, &written, nullptr) || written == 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
 bool TerminalWin::is_initialized() const {
     return initialized_;
 }
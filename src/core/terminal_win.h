@@ -16,12 +16,17 @@ public:
     void cleanup() override;
     bool get_size(TerminalSize& size) override;
     bool check_size(int min_cols, int min_rows, TerminalSize& current) override;
+    bool consume_resize() override;
     bool read_input(char& c) override;
+    size_t read_available(char* buffer, size_t capacity) override;
+    bool wait_input(int timeout_ms) override;
+    void wake() override;
     void sleep_ms(int ms) override;
     void clear_screen() override;
     void hide_cursor() override;
     void show_cursor() override;
     void home_cursor() override;
+    bool write_output(const char* data, size_t size) override;
     bool is_initialized() const override;
     
 private:
@@ -32,6 +37,8 @@ private:
     DWORD original_stdout_mode_;
     // Whether console supports virtual terminal (ANSI) sequences
     bool vt_enabled_ = false;
+    HANDLE wake_event_ = nullptr; // set by wake(), waited on next to stdin
+    TerminalSize last_size_{0, 0};   // no resize signal on Windows, compared per call
 };
 
 } // namespace nightforge
@@ -10,11 +10,26 @@ void print_usage(const char* program_name) {
     std::cout << "  --min-width WIDTH     Minimum terminal width (default: 80)\n";
     std::cout << "  --min-height HEIGHT   Minimum terminal height (default: 24)\n";
     std::cout << "  --dev-hot-reload      Enable hot reload for development\n";
-    std::cout << "  --bench               Run microbenchmarks\n";
+    std::cout << "  --bench               Run microbenchmarks (ASCII conversion)\n";
+    std::cout << "  --fps N               Target frame rate (default: 60)\n";
+    std::cout << "  --frame-stats         Print frame time percentiles on exit\n";
+    std::cout << "  --anim FILE.nfa       Play a converted animation as the background\n";
+    std::cout << "  --headless            Render into a virtual screen, no TTY needed\n";
+    std::cout << "  --frames N            Frames to run headless, each redrawn in full (default: 300)\n";
+    std::cout << "  --size COLSxROWS      Headless and session screen size (default: 120x40)\n";
+    std::cout << "  --serve PORT|PATH     Host one session per connection on a TCP port or Unix socket\n";
+    std::cout << "  --workers N           Session worker threads (default: one per core)\n";
+    std::cout << "  --max-sessions N      Connections accepted at once (default: 256)\n";
+    std::cout << "  --session-stack N     Script stack slots per session (default: 16384)\n";
+    std::cout << "  --session-steps N     Loop iterations and calls per session script run (default: 10000000)\n";
+    std::cout << "  --art IMAGE           Background image converted once for all sessions\n";
+    std::cout << "  --jit                 JIT-compile hot script functions (x86-64 Linux)\n";
+    std::cout << "  --jit-threshold N     Calls before a function is compiled (default: 1000)\n";
     std::cout << "  --help, -h            Show this help message\n";
     std::cout << "\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " assets/scripts/demo.ns\n";
+    std::cout << "  " << program_name << " --serve /tmp/nightforge.sock assets/scripts/demo.ns\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -35,6 +50,41 @@ int main(int argc, char* argv[]) {
             config.hot_reload = true;
         } else if (arg == "--bench") {
             config.run_benchmarks = true;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            config.target_fps = std::atoi(argv[++i]);
+        } else if (arg == "--frame-stats") {
+            config.show_frame_stats = true;
+        } else if (arg == "--anim" && i + 1 < argc) {
+            config.background_animation = argv[++i];
+        } else if (arg == "--headless") {
+            config.headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            config.headless_frames = std::atoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            std::string size = argv[++i];
+            size_t x = size.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Invalid --size, expected COLSxROWS: " << size << std::endl;
+                return 1;
+            }
+            config.headless_cols = std::atoi(size.substr(0, x).c_str());
+            config.headless_rows = std::atoi(size.substr(x + 1).c_str());
+        } else if (arg == "--serve" && i + 1 < argc) {
+            config.serve_address = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            config.serve_workers = std::atoi(argv[++i]);
+        } else if (arg == "--max-sessions" && i + 1 < argc) {
+            config.max_sessions = std::atoi(argv[++i]);
+        } else if (arg == "--session-stack" && i + 1 < argc) {
+            config.session_stack_slots = std::atoi(argv[++i]);
+        } else if (arg == "--session-steps" && i + 1 < argc) {
+            config.session_steps = std::atoll(argv[++i]);
+        } else if (arg == "--art" && i + 1 < argc) {
+            config.serve_art = argv[++i];
+        } else if (arg == "--jit") {
+            config.enable_jit = true;
+        } else if (arg == "--jit-threshold" && i + 1 < argc) {
+            config.jit_hot_threshold = std::atoi(argv[++i]);
         } else if (arg.substr(0, 2) == "--") {
             std::cerr << "Unknown option: " << arg << std::endl;
             print_usage(argv[0]);
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <fstream>
 #include <algorithm>
+#include <cctype>
 #include <sys/stat.h>
 #include <ctime>
 
@@ -194,9 +195,10 @@ void Compiler::expression_precedence(int min_precedence) {
     } else if (match(TokenType::IDENTIFIER)) {
         identifier();
         while (match(TokenType::LEFT_BRACKET)) {
+            bool typed = last_expression_type_ == InferredType::TYPED_ARRAY;
             expression();
             consume(TokenType::RIGHT_BRACKET, "Expected ']' after index");
-            emit_byte(static_cast<uint8_t>(OpCode::OP_INDEX_GET));
+            emit_byte(static_cast<uint8_t>(typed ? OpCode::OP_TYPED_GET : OpCode::OP_INDEX_GET));
             last_expression_type_ = InferredType::UNKNOWN;
         }
     } else if (match(TokenType::LEFT_BRACE)) {
@@ -352,7 +354,7 @@ void Compiler::number() {
         last_expression_type_ = InferredType::FLOAT;
     } else {
         int64_t value = std::stoll(num_str);
-        emit_constant(Value::integer(value));
+        emit_constant(Value::from_int64(value));
         last_expression_type_ = InferredType::INTEGER;
     }
 }
@@ -534,7 +536,8 @@ void Compiler::statement() {
             consume(TokenType::RIGHT_BRACKET, "Expected ']' after index");
             consume(TokenType::ASSIGN, "Expected '=' after index expression");
             expression(); // RHS
-            emit_byte(static_cast<uint8_t>(OpCode::OP_INDEX_SET));
+            bool typed = infer_variable_type(nameTok.lexeme) == InferredType::TYPED_ARRAY;
+            emit_byte(static_cast<uint8_t>(typed ? OpCode::OP_TYPED_SET : OpCode::OP_INDEX_SET));
             emit_byte(static_cast<uint8_t>(OpCode::OP_POP));
             return;
         } else if (next.type == TokenType::LEFT_PAREN) {
@@ -1117,6 +1120,15 @@ void Compiler::call_expression() {
     emit_byte(static_cast<uint8_t>(OpCode::OP_CALL_HOST));
     emit_byte(static_cast<uint8_t>(name_const));
     emit_byte(static_cast<uint8_t>(arg_count));
+
+    // Typed array constructors let indexing use OP_TYPED_GET/SET
+    std::string lc = func_name;
+    std::transform(lc.begin(), lc.end(), lc.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lc == "int32_array" || lc == "float64_array" || lc == "uint8_array") {
+        last_expression_type_ = InferredType::TYPED_ARRAY;
+    } else {
+        last_expression_type_ = InferredType::UNKNOWN;
+    }
 }
 
 void Compiler::print_statement() {
@@ -1177,11 +1189,17 @@ void Compiler::thread_jumps() {
     const auto& code = chunk_->code();
     size_t n = code.size();
     
-    // Lua 5.4 style aggressive jump threading
-    // Can optimize both unconditional jumps and conditional jumps leading to jumps
+    // Lua 5.4 style jump threading: a jump whose target is an unconditional
+    // OP_JUMP can go straight to that jump's destination.
+    // Walk instruction by instruction so operand bytes are never mistaken for opcodes.
     // Problem with this is that the compiler already builds very efficient jumps so this doesn't get used much, wow.
+    std::vector<bool> is_instr(n, false);
+    for (size_t i = 0; i < n; i += 1 + opcode_operand_bytes(static_cast<OpCode>(code[i]))) {
+        is_instr[i] = true;
+    }
+
     size_t total_jumps_found = 0;
-    for (size_t i = 0; i + 1 < n; ++i) {
+    for (size_t i = 0; i + 1 < n; i += 1 + opcode_operand_bytes(static_cast<OpCode>(code[i]))) {
         uint8_t instr = code[i];
         if (instr != static_cast<uint8_t>(OpCode::OP_JUMP) && 
             instr != static_cast<uint8_t>(OpCode::OP_JUMP_IF_FALSE)) {
@@ -1189,96 +1207,30 @@ void Compiler::thread_jumps() {
         }
         
         total_jumps_found++;
-        
-        // Debug: print jump details
-        // std::cout << "Jump at " << i << ": " 
-        //          << (instr == static_cast<uint8_t>(OpCode::OP_JUMP) ? "OP_JUMP" : "OP_JUMP_IF_FALSE");
 
+        // offsets are relative to the byte after the operand
         size_t offset_idx = i + 1;
-        if (offset_idx >= n) continue;
-        uint8_t off = code[offset_idx];
-        size_t dest = offset_idx + static_cast<size_t>(off);
-        
-        std::cout << " -> " << dest;
-        if (dest < n) {
-            uint8_t target_instr = code[dest];
-            if (target_instr == static_cast<uint8_t>(OpCode::OP_JUMP)) {
-                std::cout << " (target: OP_JUMP)";
-            } else if (target_instr == static_cast<uint8_t>(OpCode::OP_JUMP_IF_FALSE)) {
-                std::cout << " (target: OP_JUMP_IF_FALSE)";
-            } else {
-                std::cout << " (target: op" << static_cast<int>(target_instr) << ")";
-            }
-        }
-        std::cout << std::endl;
-
-        int follow = 0;
+        size_t dest = offset_idx + 1 + static_cast<size_t>(code[offset_idx]);
         size_t original_dest = dest;
-        
-        while (dest < n && follow < 64) {
-            uint8_t target_instr = code[dest];
-            
-            if (target_instr == static_cast<uint8_t>(OpCode::OP_JUMP)) {
-                if (dest + 1 >= n) break;
-                uint8_t next_off = code[dest + 1];
-                size_t next_dest = dest + 1 + static_cast<size_t>(next_off);
-                if (next_dest == dest) break; // Avoid infinite loops
-                dest = next_dest;
-                ++follow;
-                continue;
-            }
-            
-            if (target_instr == static_cast<uint8_t>(OpCode::OP_JUMP_IF_FALSE)) {
-                
-                if (instr == static_cast<uint8_t>(OpCode::OP_JUMP_IF_FALSE)) {
-                    if (dest + 1 >= n) break;
-                    uint8_t next_off = code[dest + 1];
-                    size_t next_dest = dest + 1 + static_cast<size_t>(next_off);
-                    if (next_dest == dest) break;
-                    dest = next_dest;
-                    ++follow;
-                    continue;
-                }
 
-                if (dest + 2 < n) {
-                    size_t cond_target = dest + 1 + static_cast<size_t>(code[dest + 1]);
-                    if (cond_target < n && code[cond_target] == static_cast<uint8_t>(OpCode::OP_JUMP)) {
-                        if (cond_target + 1 < n) {
-                            size_t final_target = cond_target + 1 + static_cast<size_t>(code[cond_target + 1]);
-                            if (final_target != dest && final_target < n) {
-                                dest = final_target;
-                                ++follow;
-                                continue;
-                            }
-                        }
-                    }
-                }
-            }
-            
-            if (target_instr == static_cast<uint8_t>(OpCode::OP_POP)) {
-                dest++;
-                ++follow;
-                continue;
-            }
-            
-            if (target_instr == static_cast<uint8_t>(OpCode::OP_RETURN)) {
-                break;
-            }
-            
-            break;
+        int follow = 0;
+        while (dest + 1 < n && is_instr[dest] && follow < 64 &&
+               code[dest] == static_cast<uint8_t>(OpCode::OP_JUMP)) {
+            size_t next_dest = dest + 2 + static_cast<size_t>(code[dest + 1]);
+            if (next_dest == dest) break; // Avoid infinite loops
+            dest = next_dest;
+            ++follow;
         }
 
-        if (dest != original_dest && dest < n) {
-            if (dest >= offset_idx) {
-                size_t new_off_sz = dest - offset_idx;
-                uint8_t new_off = (new_off_sz > 255) ? 255 : static_cast<uint8_t>(new_off_sz);
-                chunk_->patch_byte(offset_idx, new_off);
-                stats_.jump_threads_applied++;
-                
-                #ifdef DEBUG_JUMP_THREADING
-                std::cout << "Jump threading: " << i << " -> " << dest << " (saved " << (dest - original_dest) << " steps)" << std::endl;
-                #endif
-            }
+        if (dest != original_dest && dest <= n) {
+            size_t new_off_sz = dest - offset_idx - 1;
+            if (new_off_sz > 255) continue; // doesn't fit in the operand, keep the chain
+            chunk_->patch_byte(offset_idx, static_cast<uint8_t>(new_off_sz));
+            stats_.jump_threads_applied++;
+            
+            #ifdef DEBUG_JUMP_THREADING
+            std::cout << "Jump threading: " << i << " -> " << dest << " (saved " << follow << " jumps)" << std::endl;
+            #endif
         }
     }
     
@@ -1498,8 +1450,12 @@ void Compiler::emit_optimized_binary_op(TokenType op, InferredType left_type, In
                             result = Value::floating(r);
                             foldable = true;
                         } else {
-                            int64_t ri = static_cast<int64_t>(r);
-                            result = Value::integer(ri);
+                            int64_t ia = a.as_integer();
+                            int64_t ib = b.as_integer();
+                            if (op == TokenType::PLUS) result = Value::from_int64(ia + ib);
+                            else if (op == TokenType::MINUS) result = Value::from_int64(ia - ib);
+                            else if (op == TokenType::MULTIPLY) result = Value::multiply_ints(ia, ib);
+                            else result = Value::from_int64(static_cast<int64_t>(r));
                             foldable = true;
                         }
                     }
@@ -13,7 +13,8 @@ enum class InferredType {
     FLOAT,
     STRING,
     BOOLEAN,
-    NIL
+    NIL,
+    TYPED_ARRAY  // result of int32_array/float64_array/uint8_array
 };
 
 class Compiler {
@@ -0,0 +1,798 @@
+#include "jit.h"
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if NIGHTSCRIPT_JIT_AVAILABLE
+#include <sys/mman.h>
+#endif
+
+// Baseline JIT: one pass over the bytecode, every stack slot lives in VM memory
+// so any instruction can hand control back to the interpreter without fixups.
+// Type guards run before an instruction touches the stack; if one fails we
+// exit with that instruction's offset and the interpreter redoes it.
+
+namespace nightforge {
+namespace nightscript {
+
+#if NIGHTSCRIPT_JIT_AVAILABLE
+
+JitFunction::~JitFunction() {
+    if (memory) munmap(memory, size);
+}
+
+namespace {
+
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RSI = 6, RDI = 7, R10 = 10, R11 = 11 };
+enum Xmm : uint8_t { XMM0 = 0, XMM1 = 1, XMM2 = 2 };
+enum Cond : uint8_t {
+    CC_O = 0x0, CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_BE = 0x6, CC_A = 0x7,
+    CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF
+};
+
+// Register roles (all caller-saved, generated code never calls out)
+constexpr Reg FRAME = RDI;
+constexpr Reg BASE = RSI;
+constexpr Reg TOP = R10;
+constexpr Reg INT_TAG = R11;
+
+// Must agree with the NaN-boxing layout in value.h
+constexpr uint64_t QNAN = 0x7FF8000000000000ULL;
+constexpr uint64_t TAG_INT = 0x7FF9000000000000ULL;
+constexpr uint64_t TAG_NIL = QNAN | 0x1;
+constexpr uint64_t TAG_FALSE = QNAN | 0x2;
+constexpr uint64_t TAG_TRUE = QNAN | 0x3;
+
+constexpr int32_t SLOT = static_cast<int32_t>(sizeof(Value));
+
+// Minimal x86-64 encoder, only what the translator needs
+class Emitter {
+public:
+    using Label = size_t;
+
+    std::vector<uint8_t> code;
+
+    Label new_label() { labels_.push_back(SIZE_MAX); return labels_.size() - 1; }
+    void bind(Label l) { labels_[l] = code.size(); }
+
+    void jmp(Label l) { byte(0xE9); fixup(l); }
+    void jcc(Cond c, Label l) { byte(0x0F); byte(0x80 | c); fixup(l); }
+
+    // Resolve rel32 jumps, false if something jumps to an unbound label
+    bool finish() {
+        for (const auto& f : fixups_) {
+            size_t target = labels_[f.second];
+            if (target == SIZE_MAX) return false;
+            int32_t rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(f.first + 4));
+            std::memcpy(&code[f.first], &rel, sizeof(rel));
+        }
+        return true;
+    }
+
+    void mov(Reg dst, Reg src) { rex(true, src, dst); byte(0x89); modrm_rr(src, dst); }
+    void load(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x8B); modrm_mem(dst, base, disp); }
+    void store(Reg base, int32_t disp, Reg src) { rex(true, src, base); byte(0x89); modrm_mem(src, base, disp); }
+    void lea(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x8D); modrm_mem(dst, base, disp); }
+    void cmp_mem(Reg r, Reg base, int32_t disp) { rex(true, r, base); byte(0x3B); modrm_mem(r, base, disp); }
+    void mov_imm(Reg dst, uint64_t v) { rex(true, 0, dst); byte(0xB8 | (dst & 7)); imm64(v); }
+    void mov_eax_imm(uint32_t v) { byte(0xB8); imm32(static_cast<int32_t>(v)); } // zero-extends
+
+    void add(Reg dst, Reg src) { alu(0x01, dst, src); }
+    void sub(Reg dst, Reg src) { alu(0x29, dst, src); }
+    void or_(Reg dst, Reg src) { alu(0x09, dst, src); }
+    void cmp(Reg a, Reg b) { alu(0x39, a, b); }
+    void test(Reg a, Reg b) { alu(0x85, a, b); }
+    void imul(Reg dst, Reg src) { rex(true, dst, src); byte(0x0F); byte(0xAF); modrm_rr(dst, src); }
+    void add_imm(Reg r, int32_t v) { alu_imm(0, r, v); }
+    void and_imm(Reg r, int32_t v) { alu_imm(4, r, v); }
+    void sub_imm(Reg r, int32_t v) { alu_imm(5, r, v); }
+    void cmp_imm(Reg r, int32_t v) { alu_imm(7, r, v); }
+    void shl(Reg r, uint8_t n) { shift(4, r, n); }
+    void shr(Reg r, uint8_t n) { shift(5, r, n); }
+    void sar(Reg r, uint8_t n) { shift(7, r, n); }
+    void cqo() { byte(0x48); byte(0x99); }
+    void idiv(Reg r) { rex(true, 0, r); byte(0xF7); modrm_rr(7, r); }
+    void ret() { byte(0xC3); }
+
+    // Byte registers, only al/cl/dl are used so no REX is needed
+    void setcc(Cond c, Reg r) { byte(0x0F); byte(0x90 | c); modrm_rr(0, r); }
+    void and8(Reg dst, Reg src) { byte(0x20); modrm_rr(src, dst); }
+    void or8(Reg dst, Reg src) { byte(0x08); modrm_rr(src, dst); }
+    void xor_al(uint8_t v) { byte(0x34); byte(v); }
+    void movzx_eax_al() { byte(0x0F); byte(0xB6); byte(0xC0); }
+
+    // SSE2
+    void movq_to_xmm(Xmm x, Reg r) { byte(0x66); rex(true, x, r); byte(0x0F); byte(0x6E); modrm_rr(x, r); }
+    void movq_from_xmm(Reg r, Xmm x) { byte(0x66); rex(true, x, r); byte(0x0F); byte(0x7E); modrm_rr(x, r); }
+    void cvtsi2sd(Xmm x, Reg r) { byte(0xF2); rex(true, x, r); byte(0x0F); byte(0x2A); modrm_rr(x, r); }
+    void addsd(Xmm d, Xmm s) { sse(0xF2, 0x58, d, s); }
+    void mulsd(Xmm d, Xmm s) { sse(0xF2, 0x59, d, s); }
+    void subsd(Xmm d, Xmm s) { sse(0xF2, 0x5C, d, s); }
+    void divsd(Xmm d, Xmm s) { sse(0xF2, 0x5E, d, s); }
+    void ucomisd(Xmm a, Xmm b) { sse(0x66, 0x2E, a, b); }
+    void xorpd(Xmm d, Xmm s) { sse(0x66, 0x57, d, s); }
+
+private:
+    std::vector<size_t> labels_;
+    std::vector<std::pair<size_t, Label>> fixups_;
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void imm32(int32_t v) { uint8_t b[4]; std::memcpy(b, &v, 4); code.insert(code.end(), b, b + 4); }
+    void imm64(uint64_t v) { uint8_t b[8]; std::memcpy(b, &v, 8); code.insert(code.end(), b, b + 8); }
+    void fixup(Label l) { fixups_.push_back({code.size(), l}); imm32(0); }
+
+    void rex(bool w, uint8_t reg, uint8_t rm) {
+        uint8_t r = 0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((rm & 8) ? 0x01 : 0);
+        if (r != 0x40) byte(r);
+    }
+    void modrm_rr(uint8_t reg, uint8_t rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+    void modrm_mem(uint8_t reg, uint8_t base, int32_t disp) {
+        byte(0x80 | ((reg & 7) << 3) | (base & 7)); // [base + disp32]
+        if ((base & 7) == 4) byte(0x24);            // rsp/r12 need a SIB
+        imm32(disp);
+    }
+    void alu(uint8_t opc, Reg dst, Reg src) { rex(true, src, dst); byte(opc); modrm_rr(src, dst); }
+    void alu_imm(uint8_t ext, Reg r, int32_t v) { rex(true, 0, r); byte(0x81); modrm_rr(ext, r); imm32(v); }
+    void shift(uint8_t ext, Reg r, uint8_t n) { rex(true, 0, r); byte(0xC1); modrm_rr(ext, r); byte(n); }
+    void sse(uint8_t prefix, uint8_t opc, Xmm d, Xmm s) { byte(prefix); byte(0x0F); byte(opc); modrm_rr(d, s); }
+};
+
+using Label = Emitter::Label;
+
+// Stack effect of a supported opcode
+struct Effect {
+    int pops;
+    int pushes;
+};
+
+class Translator {
+public:
+    explicit Translator(const Chunk& chunk) : chunk_(chunk), bc_(chunk.code()) {}
+
+    bool translate() {
+        if (bc_.empty() || !analyze()) return false;
+
+        exit_ok_ = e_.new_label();
+        op_labels_.assign(bc_.size(), SIZE_MAX);
+        bail_labels_.assign(bc_.size(), SIZE_MAX);
+        for (size_t pc = 0; pc < bc_.size(); pc = next_pc(pc)) {
+            if (depth_[pc] != INT_MIN) op_labels_[pc] = e_.new_label();
+        }
+
+        // Prologue: cache frame fields, bail before doing anything if the
+        // stack can't hold this function's temporaries
+        e_.load(BASE, FRAME, 0);
+        e_.load(TOP, FRAME, 8);
+        e_.mov_imm(INT_TAG, TAG_INT);
+        e_.lea(RAX, TOP, max_depth_ * SLOT);
+        e_.cmp_mem(RAX, FRAME, 16);
+        e_.jcc(CC_A, bail(0));
+        if (max_slot_ >= 0) {
+            e_.lea(RAX, BASE, (max_slot_ + 1) * SLOT);
+            e_.cmp_mem(RAX, FRAME, 16);
+            e_.jcc(CC_A, bail(0));
+        }
+
+        for (size_t pc = 0; pc < bc_.size(); pc = next_pc(pc)) {
+            if (depth_[pc] == INT_MIN) continue; // unreachable
+            pc_ = pc;
+            e_.bind(op_labels_[pc]);
+            if (!supported(pc)) {
+                e_.jmp(bail(pc));
+                continue;
+            }
+            emit(pc);
+        }
+        e_.jmp(exit_ok_);
+
+        e_.bind(exit_ok_);
+        e_.store(FRAME, 8, TOP);
+        e_.mov_imm(RAX, static_cast<uint64_t>(JIT_DONE));
+        e_.ret();
+
+        for (size_t pc = 0; pc < bc_.size(); ++pc) {
+            if (bail_labels_[pc] == SIZE_MAX) continue;
+            e_.bind(bail_labels_[pc]);
+            e_.store(FRAME, 8, TOP);
+            e_.mov_eax_imm(static_cast<uint32_t>(pc));
+            e_.ret();
+        }
+        return e_.finish();
+    }
+
+    std::vector<uint8_t>& code() { return e_.code; }
+
+private:
+    const Chunk& chunk_;
+    const std::vector<uint8_t>& bc_;
+    Emitter e_;
+
+    std::vector<int> depth_;           // stack depth on entry to each instruction, INT_MIN if unreachable
+    std::vector<Label> op_labels_;
+    std::vector<Label> bail_labels_;   // created on first use
+    Label exit_ok_ = 0;
+    size_t pc_ = 0;
+    int max_depth_ = 0;
+    int max_slot_ = -1;
+
+    OpCode op_at(size_t pc) const { return static_cast<OpCode>(bc_[pc]); }
+    size_t next_pc(size_t pc) const { return pc + 1 + opcode_operand_bytes(op_at(pc)); }
+    uint8_t operand(size_t pc, int i) const { return bc_[pc + 1 + i]; }
+
+    bool constant_bits(size_t index, Value& out) const {
+        const auto& consts = chunk_.constants();
+        if (index >= consts.size()) return false;
+        out = consts[index];
+        return true;
+    }
+
+    static bool is_number(const Value& v) { return v.is_int() || v.is_float(); }
+
+    Label bail(size_t pc) {
+        if (bail_labels_[pc] == SIZE_MAX) bail_labels_[pc] = e_.new_label();
+        return bail_labels_[pc];
+    }
+    Label target(size_t dest) { return dest >= bc_.size() ? exit_ok_ : op_labels_[dest]; }
+
+    // Jump destination, SIZE_MAX if it would leave the chunk backwards
+    size_t jump_dest(size_t pc) const {
+        size_t after = pc + 2;
+        uint8_t off = operand(pc, 0);
+        if (op_at(pc) == OpCode::OP_JUMP_BACK) return off > after ? SIZE_MAX : after - off;
+        return after + off;
+    }
+
+    bool supported(size_t pc) const {
+        Value c;
+        switch (op_at(pc)) {
+            case OpCode::OP_CONSTANT:
+                return constant_bits(operand(pc, 0), c);
+            case OpCode::OP_CONSTANT_LONG:
+                return constant_bits(operand(pc, 0) | (operand(pc, 1) << 8), c);
+            case OpCode::OP_CONSTANT_LOCAL:
+                return constant_bits(operand(pc, 0), c);
+            case OpCode::OP_ADD_LOCAL_CONST:
+            case OpCode::OP_ADD_LOCAL_CONST_FLOAT:
+                return constant_bits(operand(pc, 1), c) && is_number(c);
+            case OpCode::OP_ADD_CONST_LOCAL:
+            case OpCode::OP_ADD_CONST_LOCAL_FLOAT:
+                return constant_bits(operand(pc, 0), c) && is_number(c);
+            case OpCode::OP_NIL: case OpCode::OP_TRUE: case OpCode::OP_FALSE:
+            case OpCode::OP_GET_LOCAL: case OpCode::OP_SET_LOCAL:
+            case OpCode::OP_ADD: case OpCode::OP_SUBTRACT: case OpCode::OP_MULTIPLY:
+            case OpCode::OP_DIVIDE: case OpCode::OP_MODULO:
+            case OpCode::OP_ADD_INT: case OpCode::OP_SUB_INT: case OpCode::OP_MUL_INT:
+            case OpCode::OP_DIV_INT: case OpCode::OP_MOD_INT:
+            case OpCode::OP_ADD_FLOAT: case OpCode::OP_SUB_FLOAT: case OpCode::OP_MUL_FLOAT:
+            case OpCode::OP_DIV_FLOAT:
+            case OpCode::OP_EQUAL: case OpCode::OP_GREATER: case OpCode::OP_GREATER_EQUAL:
+            case OpCode::OP_LESS_EQUAL: case OpCode::OP_LESS: case OpCode::OP_NOT:
+            case OpCode::OP_AND: case OpCode::OP_OR:
+            case OpCode::OP_JUMP: case OpCode::OP_JUMP_IF_FALSE: case OpCode::OP_JUMP_BACK:
+            case OpCode::OP_RETURN: case OpCode::OP_POP:
+            case OpCode::OP_ADD_LOCAL: case OpCode::OP_ADD_FLOAT_LOCAL:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static Effect effect(OpCode op) {
+        switch (op) {
+            case OpCode::OP_CONSTANT: case OpCode::OP_CONSTANT_LONG:
+            case OpCode::OP_NIL: case OpCode::OP_TRUE: case OpCode::OP_FALSE:
+            case OpCode::OP_GET_LOCAL:
+            case OpCode::OP_ADD_LOCAL: case OpCode::OP_ADD_FLOAT_LOCAL:
+            case OpCode::OP_ADD_LOCAL_CONST: case OpCode::OP_ADD_CONST_LOCAL:
+            case OpCode::OP_ADD_LOCAL_CONST_FLOAT: case OpCode::OP_ADD_CONST_LOCAL_FLOAT:
+                return {0, 1};
+            case OpCode::OP_SET_LOCAL: case OpCode::OP_NOT:
+                return {1, 1};
+            case OpCode::OP_JUMP_IF_FALSE: case OpCode::OP_POP:
+                return {1, 0};
+            case OpCode::OP_JUMP: case OpCode::OP_JUMP_BACK: case OpCode::OP_RETURN:
+            case OpCode::OP_CONSTANT_LOCAL:
+                return {0, 0};
+            default:
+                return {2, 1}; // binary arithmetic, comparisons, and/or
+        }
+    }
+
+    // Local slot operands of an instruction, -1 if none
+    int highest_slot(size_t pc) const {
+        switch (op_at(pc)) {
+            case OpCode::OP_GET_LOCAL: case OpCode::OP_SET_LOCAL:
+                return operand(pc, 0);
+            case OpCode::OP_ADD_LOCAL: case OpCode::OP_ADD_FLOAT_LOCAL:
+                return std::max(operand(pc, 0), operand(pc, 1));
+            case OpCode::OP_ADD_LOCAL_CONST: case OpCode::OP_ADD_LOCAL_CONST_FLOAT:
+                return operand(pc, 0);
+            case OpCode::OP_CONSTANT_LOCAL: case OpCode::OP_ADD_CONST_LOCAL:
+            case OpCode::OP_ADD_CONST_LOCAL_FLOAT:
+                return operand(pc, 1);
+            default:
+                return -1;
+        }
+    }
+
+    // Walk every reachable path and make sure each instruction always sees
+    // the same stack depth; otherwise we can't reason about it statically
+    bool analyze() {
+        size_t n = bc_.size();
+        std::vector<bool> is_instr(n, false);
+        for (size_t pc = 0; pc < n; pc = next_pc(pc)) {
+            if (next_pc(pc) > n) return false; // truncated operands
+            is_instr[pc] = true;
+        }
+        if (!supported(0)) return false; // would bail straight away
+
+        depth_.assign(n, INT_MIN);
+        std::vector<std::pair<size_t, int>> work = {{0, 0}};
+        while (!work.empty()) {
+            auto [pc, d] = work.back();
+            work.pop_back();
+            if (pc >= n) continue; // falls off the end = return
+            if (!is_instr[pc]) return false;
+            if (depth_[pc] != INT_MIN) {
+                if (depth_[pc] != d) return false;
+                continue;
+            }
+            depth_[pc] = d;
+            if (!supported(pc)) continue; // exits to the interpreter
+
+            OpCode op = op_at(pc);
+            Effect fx = effect(op);
+            if (d < fx.pops) return false;
+            int nd = d - fx.pops + fx.pushes;
+            max_depth_ = std::max(max_depth_, nd);
+            max_slot_ = std::max(max_slot_, highest_slot(pc));
+
+            switch (op) {
+                case OpCode::OP_RETURN:
+                    break;
+                case OpCode::OP_JUMP:
+                case OpCode::OP_JUMP_BACK: {
+                    size_t dest = jump_dest(pc);
+                    if (dest == SIZE_MAX) return false;
+                    work.push_back({dest, nd});
+                    break;
+                }
+                case OpCode::OP_JUMP_IF_FALSE:
+                    work.push_back({jump_dest(pc), nd});
+                    work.push_back({next_pc(pc), nd});
+                    break;
+                default:
+                    work.push_back({next_pc(pc), nd});
+                    break;
+            }
+        }
+        return true;
+    }
+
+    // --- helpers -----------------------------------------------------------
+
+    void push(Reg r) { e_.store(TOP, 0, r); e_.add_imm(TOP, SLOT); }
+    void store_binary(Reg r) { e_.store(TOP, -2 * SLOT, r); e_.sub_imm(TOP, SLOT); }
+    void load_operands() { e_.load(RAX, TOP, -2 * SLOT); e_.load(RDX, TOP, -SLOT); }
+
+    void guard_int(Reg r, Label fail) {
+        e_.mov(RCX, r);
+        e_.shr(RCX, 48);
+        e_.cmp_imm(RCX, 0x7FF9);
+        e_.jcc(CC_NE, fail);
+    }
+    void guard_float(Reg r, Label fail) {
+        e_.mov(RCX, r);
+        e_.shr(RCX, 48);
+        e_.and_imm(RCX, 0x7FF8);
+        e_.cmp_imm(RCX, 0x7FF8);
+        e_.jcc(CC_E, fail);
+    }
+    void unbox_int(Reg r) { e_.shl(r, 16); e_.sar(r, 16); }
+
+    // Results outside the 48-bit payload go back to the interpreter, which
+    // promotes them to floats. Clobbers rcx
+    void guard_int48(Reg r) {
+        e_.mov(RCX, r);
+        e_.shl(RCX, 16);
+        e_.sar(RCX, 16);
+        e_.cmp(RCX, r);
+        e_.jcc(CC_NE, bail(pc_));
+    }
+    void box_int(Reg r) { e_.shl(r, 16); e_.shr(r, 16); e_.or_(r, INT_TAG); }
+
+    // al holds 0/1 -> rax = boolean Value
+    void box_bool() {
+        e_.movzx_eax_al();
+        e_.mov_imm(RCX, TAG_FALSE);
+        e_.add(RAX, RCX);
+    }
+
+    // Int or float in r -> double in x, anything else exits. Clobbers r and rcx
+    void to_double(Reg r, Xmm x, Label fail) {
+        Label not_int = e_.new_label();
+        Label done = e_.new_label();
+        guard_int(r, not_int);
+        unbox_int(r);
+        e_.cvtsi2sd(x, r);
+        e_.jmp(done);
+        e_.bind(not_int);
+        guard_float(r, fail);
+        e_.movq_to_xmm(x, r);
+        e_.bind(done);
+    }
+
+    // al = 1 if r is nil or false. Clobbers r and rcx
+    void falsy(Reg r) {
+        e_.mov_imm(RCX, TAG_NIL);
+        e_.sub(r, RCX);
+        e_.cmp_imm(r, 1);
+        e_.setcc(CC_BE, r == RAX ? RAX : RDX);
+    }
+
+    // rax op rdx on unboxed ints, result in rax
+    void int_arith(OpCode op) {
+        switch (op) {
+            case OpCode::OP_ADD: e_.add(RAX, RDX); guard_int48(RAX); break;
+            case OpCode::OP_SUBTRACT: e_.sub(RAX, RDX); guard_int48(RAX); break;
+            case OpCode::OP_MULTIPLY:
+                e_.imul(RAX, RDX);
+                e_.jcc(CC_O, bail(pc_));
+                guard_int48(RAX);
+                break;
+            case OpCode::OP_DIVIDE:
+            case OpCode::OP_MODULO:
+                e_.test(RDX, RDX);
+                e_.jcc(CC_E, bail(pc_));
+                e_.mov(RCX, RDX);
+                e_.cqo();
+                e_.idiv(RCX);
+                if (op == OpCode::OP_MODULO) e_.mov(RAX, RDX);
+                else guard_int48(RAX); // INT48_MIN / -1
+                break;
+            default: break;
+        }
+    }
+
+    // xmm0 op xmm1, result in xmm0
+    void float_arith(OpCode op) {
+        switch (op) {
+            case OpCode::OP_ADD: e_.addsd(XMM0, XMM1); break;
+            case OpCode::OP_SUBTRACT: e_.subsd(XMM0, XMM1); break;
+            case OpCode::OP_MULTIPLY: e_.mulsd(XMM0, XMM1); break;
+            case OpCode::OP_DIVIDE:
+                e_.xorpd(XMM2, XMM2);
+                e_.ucomisd(XMM1, XMM2);
+                e_.jcc(CC_E, bail(pc_)); // zero (or NaN) divisor, let the interpreter decide
+                e_.divsd(XMM0, XMM1);
+                break;
+            default: break;
+        }
+    }
+
+    static OpCode generic_of(OpCode op) {
+        switch (op) {
+            case OpCode::OP_ADD_INT: case OpCode::OP_ADD_FLOAT: return OpCode::OP_ADD;
+            case OpCode::OP_SUB_INT: case OpCode::OP_SUB_FLOAT: return OpCode::OP_SUBTRACT;
+            case OpCode::OP_MUL_INT: case OpCode::OP_MUL_FLOAT: return OpCode::OP_MULTIPLY;
+            case OpCode::OP_DIV_INT: case OpCode::OP_DIV_FLOAT: return OpCode::OP_DIVIDE;
+            case OpCode::OP_MOD_INT: return OpCode::OP_MODULO;
+            default: return op;
+        }
+    }
+
+    // --- per-instruction code ----------------------------------------------
+
+    void emit_generic_arith(OpCode op) {
+        Label slow = e_.new_label();
+        Label done = e_.new_label();
+        load_operands();
+        guard_int(RAX, slow);
+        guard_int(RDX, slow);
+        unbox_int(RAX);
+        unbox_int(RDX);
+        int_arith(op);
+        box_int(RAX);
+        e_.jmp(done);
+
+        e_.bind(slow);
+        if (op == OpCode::OP_MODULO) {
+            e_.jmp(bail(pc_)); // float and string cases go back to the interpreter
+        } else {
+            to_double(RAX, XMM0, bail(pc_));
+            to_double(RDX, XMM1, bail(pc_));
+            float_arith(op);
+            e_.movq_from_xmm(RAX, XMM0);
+        }
+        e_.bind(done);
+        store_binary(RAX);
+    }
+
+    void emit_int_arith(OpCode op) {
+        load_operands();
+        guard_int(RAX, bail(pc_));
+        guard_int(RDX, bail(pc_));
+        unbox_int(RAX);
+        unbox_int(RDX);
+        int_arith(op);
+        box_int(RAX);
+        store_binary(RAX);
+    }
+
+    void emit_float_arith(OpCode op) {
+        load_operands();
+        guard_float(RAX, bail(pc_));
+        guard_float(RDX, bail(pc_));
+        e_.movq_to_xmm(XMM0, RAX);
+        e_.movq_to_xmm(XMM1, RDX);
+        float_arith(op);
+        e_.movq_from_xmm(RAX, XMM0);
+        store_binary(RAX);
+    }
+
+    void emit_compare(OpCode op) {
+        Label floats = e_.new_label();
+        Label done = e_.new_label();
+        load_operands();
+        guard_int(RAX, floats);
+        guard_int(RDX, bail(pc_));
+        e_.shl(RAX, 16); // drop the tag, keep the sign in bit 63
+        e_.shl(RDX, 16);
+        e_.cmp(RAX, RDX);
+        switch (op) {
+            case OpCode::OP_GREATER: e_.setcc(CC_G, RAX); break;
+            case OpCode::OP_GREATER_EQUAL: e_.setcc(CC_GE, RAX); break;
+            case OpCode::OP_LESS_EQUAL: e_.setcc(CC_LE, RAX); break;
+            default: e_.setcc(CC_L, RAX); break;
+        }
+        e_.jmp(done);
+
+        e_.bind(floats);
+        guard_float(RAX, bail(pc_));
+        guard_float(RDX, bail(pc_));
+        e_.movq_to_xmm(XMM0, RAX);
+        e_.movq_to_xmm(XMM1, RDX);
+        // unordered sets CF so above/above-equal are false for NaN
+        switch (op) {
+            case OpCode::OP_GREATER: e_.ucomisd(XMM0, XMM1); e_.setcc(CC_A, RAX); break;
+            case OpCode::OP_GREATER_EQUAL: e_.ucomisd(XMM0, XMM1); e_.setcc(CC_AE, RAX); break;
+            case OpCode::OP_LESS_EQUAL: e_.ucomisd(XMM1, XMM0); e_.setcc(CC_AE, RAX); break;
+            default: e_.ucomisd(XMM1, XMM0); e_.setcc(CC_A, RAX); break;
+        }
+        e_.bind(done);
+        box_bool();
+        store_binary(RAX);
+    }
+
+    void emit_equal() {
+        Label not_float = e_.new_label();
+        Label done = e_.new_label();
+        load_operands();
+        guard_float(RAX, not_float);
+        guard_float(RDX, bail(pc_));
+        e_.movq_to_xmm(XMM0, RAX);
+        e_.movq_to_xmm(XMM1, RDX);
+        e_.ucomisd(XMM0, XMM1);
+        e_.setcc(CC_E, RAX);
+        e_.setcc(CC_NP, RCX);
+        e_.and8(RAX, RCX);
+        e_.jmp(done);
+
+        // nil/bool/int/string compare by bits; tables, arrays and buffers
+        // never compare equal in the interpreter, leave those to it
+        e_.bind(not_float);
+        e_.mov(RCX, RAX);
+        e_.shr(RCX, 48);
+        e_.and_imm(RCX, 0x7);
+        e_.cmp_imm(RCX, 0x3);
+        e_.jcc(CC_AE, bail(pc_));
+        e_.cmp(RAX, RDX);
+        e_.setcc(CC_E, RAX);
+        e_.bind(done);
+        box_bool();
+        store_binary(RAX);
+    }
+
+    void emit_logic(OpCode op) {
+        load_operands();
+        falsy(RAX); // al = a is falsy
+        falsy(RDX); // dl = b is falsy
+        if (op == OpCode::OP_AND) e_.or8(RAX, RDX); // !(a && b) = !a || !b
+        else e_.and8(RAX, RDX);                      // !(a || b) = !a && !b
+        e_.xor_al(1);
+        box_bool();
+        store_binary(RAX);
+    }
+
+    void emit(size_t pc) {
+        OpCode op = op_at(pc);
+        switch (op) {
+            case OpCode::OP_CONSTANT:
+            case OpCode::OP_CONSTANT_LONG: {
+                size_t idx = operand(pc, 0);
+                if (op == OpCode::OP_CONSTANT_LONG) idx |= static_cast<size_t>(operand(pc, 1)) << 8;
+                Value c;
+                constant_bits(idx, c);
+                e_.mov_imm(RAX, c.raw_bits());
+                push(RAX);
+                break;
+            }
+            case OpCode::OP_NIL: e_.mov_imm(RAX, TAG_NIL); push(RAX); break;
+            case OpCode::OP_TRUE: e_.mov_imm(RAX, TAG_TRUE); push(RAX); break;
+            case OpCode::OP_FALSE: e_.mov_imm(RAX, TAG_FALSE); push(RAX); break;
+
+            case OpCode::OP_GET_LOCAL:
+                e_.load(RAX, BASE, operand(pc, 0) * SLOT);
+                push(RAX);
+                break;
+            case OpCode::OP_SET_LOCAL:
+                e_.load(RAX, TOP, -SLOT);
+                e_.store(BASE, operand(pc, 0) * SLOT, RAX);
+                break;
+            case OpCode::OP_CONSTANT_LOCAL: {
+                Value c;
+                constant_bits(operand(pc, 0), c);
+                e_.mov_imm(RAX, c.raw_bits());
+                e_.store(BASE, operand(pc, 1) * SLOT, RAX);
+                break;
+            }
+            case OpCode::OP_POP:
+                e_.sub_imm(TOP, SLOT);
+                break;
+
+            case OpCode::OP_ADD: case OpCode::OP_SUBTRACT: case OpCode::OP_MULTIPLY:
+            case OpCode::OP_DIVIDE: case OpCode::OP_MODULO:
+                emit_generic_arith(op);
+                break;
+            case OpCode::OP_ADD_INT: case OpCode::OP_SUB_INT: case OpCode::OP_MUL_INT:
+            case OpCode::OP_DIV_INT: case OpCode::OP_MOD_INT:
+                emit_int_arith(generic_of(op));
+                break;
+            case OpCode::OP_ADD_FLOAT: case OpCode::OP_SUB_FLOAT: case OpCode::OP_MUL_FLOAT:
+            case OpCode::OP_DIV_FLOAT:
+                emit_float_arith(generic_of(op));
+                break;
+
+            case OpCode::OP_EQUAL: emit_equal(); break;
+            case OpCode::OP_GREATER: case OpCode::OP_GREATER_EQUAL:
+            case OpCode::OP_LESS_EQUAL: case OpCode::OP_LESS:
+                emit_compare(op);
+                break;
+            case OpCode::OP_NOT:
+                e_.load(RAX, TOP, -SLOT);
+                falsy(RAX);
+                box_bool();
+                e_.store(TOP, -SLOT, RAX);
+                break;
+            case OpCode::OP_AND: case OpCode::OP_OR:
+                emit_logic(op);
+                break;
+
+            case OpCode::OP_JUMP: case OpCode::OP_JUMP_BACK:
+                e_.jmp(target(jump_dest(pc)));
+                break;
+            case OpCode::OP_JUMP_IF_FALSE:
+                e_.load(RAX, TOP, -SLOT);
+                e_.sub_imm(TOP, SLOT);
+                e_.mov_imm(RCX, TAG_NIL);
+                e_.sub(RAX, RCX);
+                e_.cmp_imm(RAX, 1);
+                e_.jcc(CC_BE, target(jump_dest(pc)));
+                break;
+            case OpCode::OP_RETURN:
+                e_.jmp(exit_ok_);
+                break;
+
+            case OpCode::OP_ADD_LOCAL:
+            case OpCode::OP_ADD_FLOAT_LOCAL: {
+                Label slow = e_.new_label();
+                Label done = e_.new_label();
+                e_.load(RAX, BASE, operand(pc, 0) * SLOT);
+                e_.load(RDX, BASE, operand(pc, 1) * SLOT);
+                if (op == OpCode::OP_ADD_LOCAL) {
+                    guard_int(RAX, slow);
+                    guard_int(RDX, slow);
+                    unbox_int(RAX);
+                    unbox_int(RDX);
+                    e_.add(RAX, RDX);
+                    guard_int48(RAX);
+                    box_int(RAX);
+                    e_.jmp(done);
+                }
+                e_.bind(slow);
+                to_double(RAX, XMM0, bail(pc));
+                to_double(RDX, XMM1, bail(pc));
+                e_.addsd(XMM0, XMM1);
+                e_.movq_from_xmm(RAX, XMM0);
+                e_.bind(done);
+                push(RAX);
+                break;
+            }
+            case OpCode::OP_ADD_LOCAL_CONST:
+            case OpCode::OP_ADD_CONST_LOCAL:
+            case OpCode::OP_ADD_LOCAL_CONST_FLOAT:
+            case OpCode::OP_ADD_CONST_LOCAL_FLOAT: {
+                bool local_first = op == OpCode::OP_ADD_LOCAL_CONST || op == OpCode::OP_ADD_LOCAL_CONST_FLOAT;
+                bool force_float = op == OpCode::OP_ADD_LOCAL_CONST_FLOAT || op == OpCode::OP_ADD_CONST_LOCAL_FLOAT;
+                uint8_t slot = operand(pc, local_first ? 0 : 1);
+                Value c;
+                constant_bits(operand(pc, local_first ? 1 : 0), c);
+                emit_local_plus_const(slot, c, force_float);
+                break;
+            }
+            default:
+                e_.jmp(bail(pc));
+                break;
+        }
+    }
+
+    // local + number constant (addition commutes, so operand order doesn't matter)
+    void emit_local_plus_const(uint8_t slot, const Value& c, bool force_float) {
+        Label slow = e_.new_label();
+        Label done = e_.new_label();
+        e_.load(RAX, BASE, slot * SLOT);
+        if (c.is_int() && !force_float) {
+            guard_int(RAX, slow);
+            unbox_int(RAX);
+            e_.mov_imm(RDX, static_cast<uint64_t>(c.as_integer()));
+            e_.add(RAX, RDX);
+            guard_int48(RAX);
+            box_int(RAX);
+            e_.jmp(done);
+        }
+        e_.bind(slow);
+        to_double(RAX, XMM0, bail(pc_));
+        double dc = c.is_int() ? static_cast<double>(c.as_integer()) : c.as_floating();
+        e_.mov_imm(RDX, Value::floating(dc).raw_bits());
+        e_.movq_to_xmm(XMM1, RDX);
+        e_.addsd(XMM0, XMM1);
+        e_.movq_from_xmm(RAX, XMM0);
+        e_.bind(done);
+        push(RAX);
+    }
+};
+
+} // namespace
+
+std::shared_ptr<JitFunction> jit_compile(const Chunk& chunk) {
+    Translator t(chunk);
+    if (!t.translate()) {
+#ifdef DEBUG_JIT
+        std::cerr << "[jit] rejected function (" << chunk.code().size() << " bytes)" << std::endl;
+#endif
+        return nullptr;
+    }
+
+    std::vector<uint8_t>& code = t.code();
+    void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return nullptr;
+    std::memcpy(mem, code.data(), code.size());
+    if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, code.size());
+        return nullptr;
+    }
+
+    auto fn = std::make_shared<JitFunction>();
+    fn->memory = mem;
+    fn->size = code.size();
+    fn->entry = reinterpret_cast<JitEntry>(mem);
+#ifdef DEBUG_JIT
+    std::cerr << "[jit] compiled " << chunk.code().size() << " bytes of bytecode into "
+              << code.size() << " bytes" << std::endl;
+#endif
+    return fn;
+}
+
+#else
+
+JitFunction::~JitFunction() = default;
+
+std::shared_ptr<JitFunction> jit_compile(const Chunk&) {
+    return nullptr;
+}
+
+#endif
+
+} // namespace nightscript
+} // namespace nightforge
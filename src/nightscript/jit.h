@@ -0,0 +1,46 @@
+#pragma once
+#include "value.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Baseline method JIT (x86-64 Linux only for now)
+#if defined(__x86_64__) && defined(__linux__)
+    #define NIGHTSCRIPT_JIT_AVAILABLE 1
+#else
+    #define NIGHTSCRIPT_JIT_AVAILABLE 0
+#endif
+
+namespace nightforge {
+namespace nightscript {
+
+// What native code sees of the VM stack. top is written back on every exit
+struct JitFrame {
+    Value* base;   // local slot 0
+    Value* top;    // current stack top
+    Value* limit;  // one past the last usable stack slot
+};
+
+// Native code returns JIT_DONE when the function finished (return or fell off
+// the end), otherwise the bytecode offset the interpreter should resume at
+constexpr int64_t JIT_DONE = -1;
+using JitEntry = int64_t (*)(JitFrame*);
+
+struct JitFunction {
+    JitEntry entry = nullptr;
+    void* memory = nullptr;
+    size_t size = 0;
+
+    JitFunction() = default;
+    JitFunction(const JitFunction&) = delete;
+    JitFunction& operator=(const JitFunction&) = delete;
+    ~JitFunction();
+};
+
+// Translate a function body into native code. Returns nullptr if the body
+// can't be compiled (unsupported first instruction, weird stack shape, no JIT
+// on this platform). Opcodes we don't handle become exits back to the interpreter
+std::shared_ptr<JitFunction> jit_compile(const Chunk& chunk);
+
+} // namespace nightscript
+} // namespace nightforge
@@ -0,0 +1,849 @@
+#include "array.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace nightforge {
+namespace nightscript {
+namespace stdlib {
+
+static bool is_number(const Value& v) {
+    return v.is_int() || v.is_float();
+}
+
+static double number_of(const Value& v) {
+    return v.is_float() ? v.as_floating() : static_cast<double>(v.as_integer());
+}
+
+static int64_t int_of(const Value& v) {
+    if (v.is_int()) return v.as_integer();
+    double d = v.as_floating();
+    if (!(d > -9.2e18 && d < 9.2e18)) return 0;
+    return static_cast<int64_t>(d);
+}
+
+// Optional non-negative integer argument
+static bool size_arg(const std::vector<Value>& args, size_t i, size_t fallback, size_t& out) {
+    if (i >= args.size()) { out = fallback; return true; }
+    if (!is_number(args[i]) || int_of(args[i]) < 0) return false;
+    out = static_cast<size_t>(int_of(args[i]));
+    return true;
+}
+
+static Value make_typed(VM* vm, const std::vector<Value>& args, ArrayKind kind, const char* name) {
+    size_t length = 0;
+    if (args.empty() || args.size() > 2 || !size_arg(args, 0, 0, length)) {
+        std::cerr << name << ": expected (length[, fill])" << std::endl;
+        return Value::nil();
+    }
+    if (length > (1u << 28)) {
+        std::cerr << name << ": length too large" << std::endl;
+        return Value::nil();
+    }
+    uint32_t id = vm->arrays().create_typed(kind, length);
+    if (args.size() == 2) {
+        array_fill(vm, {Value::array_id(id), args[1]});
+    }
+    return Value::array_id(id);
+}
+
+Value array_int32(VM* vm, const std::vector<Value>& args) {
+    return make_typed(vm, args, ArrayKind::INT32, "int32_array");
+}
+
+Value array_float64(VM* vm, const std::vector<Value>& args) {
+    return make_typed(vm, args, ArrayKind::FLOAT64, "float64_array");
+}
+
+Value array_uint8(VM* vm, const std::vector<Value>& args) {
+    return make_typed(vm, args, ArrayKind::UINT8, "uint8_array");
+}
+
+Value array_fill(VM* vm, const std::vector<Value>& args) {
+    if (args.size() < 2 || args.size() > 4 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "array_fill: expected (array, value[, start, count])" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t id = args[0].as_array_id();
+    size_t len = arrays.length(id);
+    size_t start = 0, count = 0;
+    if (!size_arg(args, 2, 0, start) || !size_arg(args, 3, len, count)) {
+        std::cerr << "array_fill: start and count must be non-negative numbers" << std::endl;
+        return Value::nil();
+    }
+    if (start > len) start = len;
+    count = std::min(count, len - start);
+
+    const Value& v = args[1];
+    if (auto* d = arrays.int32_data(id)) {
+        if (!is_number(v)) return args[0];
+        std::fill_n(d->begin() + start, count, static_cast<int32_t>(static_cast<uint32_t>(int_of(v))));
+    } else if (auto* d = arrays.float64_data(id)) {
+        if (!is_number(v)) return args[0];
+        std::fill_n(d->begin() + start, count, number_of(v));
+    } else if (auto* d = arrays.uint8_data(id)) {
+        if (!is_number(v)) return args[0];
+        std::fill_n(d->begin() + start, count, static_cast<uint8_t>(int_of(v)));
+    } else if (auto* d = arrays.values(id)) {
+        std::fill_n(d->begin() + start, count, v);
+    }
+    return args[0];
+}
+
+Value array_copy(VM* vm, const std::vector<Value>& args) {
+    if (args.size() < 2 || args.size() > 5 ||
+        args[0].type() != ValueType::ARRAY || args[1].type() != ValueType::ARRAY) {
+        std::cerr << "array_copy: expected (dst, src[, dst_start, src_start, count])" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t dst = args[0].as_array_id();
+    uint32_t src = args[1].as_array_id();
+    size_t dst_len = arrays.length(dst);
+    size_t src_len = arrays.length(src);
+    size_t dst_start = 0, src_start = 0, count = 0;
+    if (!size_arg(args, 2, 0, dst_start) || !size_arg(args, 3, 0, src_start) ||
+        !size_arg(args, 4, src_len, count)) {
+        std::cerr << "array_copy: offsets and count must be non-negative numbers" << std::endl;
+        return Value::nil();
+    }
+    if (dst_start > dst_len || src_start > src_len) return args[0];
+    count = std::min({count, dst_len - dst_start, src_len - src_start});
+    if (count == 0) return args[0];
+
+    // Same kind: straight memmove (copy_n/copy_backward handle overlap within one array)
+    auto copy_same = [&](auto* d, auto* s) {
+        auto first = s->begin() + src_start;
+        auto out = d->begin() + dst_start;
+        if (d == s && dst_start > src_start) std::copy_backward(first, first + count, out + count);
+        else std::copy_n(first, count, out);
+    };
+    ArrayKind dk = arrays.kind(dst);
+    if (dk == arrays.kind(src)) {
+        switch (dk) {
+            case ArrayKind::INT32: copy_same(arrays.int32_data(dst), arrays.int32_data(src)); return args[0];
+            case ArrayKind::FLOAT64: copy_same(arrays.float64_data(dst), arrays.float64_data(src)); return args[0];
+            case ArrayKind::UINT8: copy_same(arrays.uint8_data(dst), arrays.uint8_data(src)); return args[0];
+            case ArrayKind::VALUE: copy_same(arrays.values(dst), arrays.values(src)); return args[0];
+        }
+    }
+
+    // Mixed kinds convert element by element
+    for (size_t i = 0; i < count; ++i) {
+        arrays.set(dst, static_cast<ssize_t>(dst_start + i), arrays.get(src, static_cast<ssize_t>(src_start + i)));
+    }
+    return args[0];
+}
+
+Value array_sum(VM* vm, const std::vector<Value>& args) {
+    if (args.size() != 1 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "array_sum: expected (array)" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t id = args[0].as_array_id();
+
+    if (auto* d = arrays.int32_data(id)) {
+        return Value::from_int64(simd::sum_i32(d->data(), d->size()));
+    }
+    if (auto* d = arrays.uint8_data(id)) {
+        return Value::from_int64(static_cast<int64_t>(simd::sum_u8(d->data(), d->size())));
+    }
+    if (auto* d = arrays.float64_data(id)) {
+        return Value::floating(simd::sum_f64(d->data(), d->size()));
+    }
+
+    // Plain arrays: stay integer until a float shows up or the sum overflows,
+    // skip non-numbers
+    int64_t isum = 0;
+    double fsum = 0.0;
+    bool any_float = false;
+    if (auto* d = arrays.values(id)) {
+        for (const Value& v : *d) {
+            if (v.is_int()) {
+                if (Value::add_overflows(isum, v.as_integer(), isum)) {
+                    fsum += static_cast<double>(isum) + static_cast<double>(v.as_integer());
+                    isum = 0;
+                    any_float = true;
+                }
+            } else if (v.is_float()) { fsum += v.as_floating(); any_float = true; }
+        }
+    }
+    if (any_float) return Value::floating(fsum + static_cast<double>(isum));
+    return Value::from_int64(isum);
+}
+
+Value array_map_add(VM* vm, const std::vector<Value>& args) {
+    if (args.size() != 2 || args[0].type() != ValueType::ARRAY || !is_number(args[1])) {
+        std::cerr << "array_map_add: expected (array, number)" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t id = args[0].as_array_id();
+    const Value& delta = args[1];
+
+    if (auto* d = arrays.int32_data(id)) {
+        uint32_t k = static_cast<uint32_t>(int_of(delta)); // wraps like the element type
+        for (int32_t& x : *d) x = static_cast<int32_t>(static_cast<uint32_t>(x) + k);
+    } else if (auto* d = arrays.uint8_data(id)) {
+        uint8_t k = static_cast<uint8_t>(int_of(delta));
+        for (uint8_t& x : *d) x = static_cast<uint8_t>(x + k);
+    } else if (auto* d = arrays.float64_data(id)) {
+        double k = number_of(delta);
+        for (double& x : *d) x += k;
+    } else if (auto* d = arrays.values(id)) {
+        for (Value& v : *d) {
+            if (v.is_int() && delta.is_int()) v = Value::from_int64(v.as_integer() + delta.as_integer());
+            else if (is_number(v)) v = Value::floating(number_of(v) + number_of(delta));
+        }
+    }
+    return args[0];
+}
+
+// min/max over an array, or over the arguments when given several numbers
+static Value array_extreme(VM* vm, const std::vector<Value>& args, bool want_max, const char* name) {
+    if (args.size() >= 2) {
+        Value best = Value::nil();
+        for (const Value& v : args) {
+            if (!is_number(v)) {
+                std::cerr << name << ": expected (array) or numbers" << std::endl;
+                return Value::nil();
+            }
+            if (best.is_nil() || (want_max ? number_of(v) > number_of(best) : number_of(v) < number_of(best))) best = v;
+        }
+        return best;
+    }
+    if (args.size() != 1 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << name << ": expected (array) or numbers" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t id = args[0].as_array_id();
+    if (arrays.length(id) == 0) return Value::nil();
+
+    if (auto* d = arrays.int32_data(id)) {
+        return Value::integer(want_max ? simd::max_i32(d->data(), d->size()) : simd::min_i32(d->data(), d->size()));
+    }
+    if (auto* d = arrays.uint8_data(id)) {
+        return Value::integer(want_max ? simd::max_u8(d->data(), d->size()) : simd::min_u8(d->data(), d->size()));
+    }
+    if (auto* d = arrays.float64_data(id)) {
+        return Value::floating(want_max ? simd::max_f64(d->data(), d->size()) : simd::min_f64(d->data(), d->size()));
+    }
+
+    // Plain arrays: numbers only, the winner keeps its int/float type
+    Value best = Value::nil();
+    if (auto* d = arrays.values(id)) {
+        for (const Value& v : *d) {
+            if (!is_number(v)) continue;
+            if (best.is_nil()) { best = v; continue; }
+            bool better;
+            if (v.is_int() && best.is_int()) better = want_max ? v.as_integer() > best.as_integer() : v.as_integer() < best.as_integer();
+            else better = want_max ? number_of(v) > number_of(best) : number_of(v) < number_of(best);
+            if (better) best = v;
+        }
+    }
+    return best;
+}
+
+Value array_min(VM* vm, const std::vector<Value>& args) {
+    return array_extreme(vm, args, false, "min");
+}
+
+Value array_max(VM* vm, const std::vector<Value>& args) {
+    return array_extreme(vm, args, true, "max");
+}
+
+Value array_dot(VM* vm, const std::vector<Value>& args) {
+    if (args.size() != 2 || args[0].type() != ValueType::ARRAY || args[1].type() != ValueType::ARRAY) {
+        std::cerr << "dot: expected (array, array)" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t a = args[0].as_array_id();
+    uint32_t b = args[1].as_array_id();
+    size_t n = arrays.length(a);
+    if (arrays.length(b) != n) {
+        std::cerr << "dot: arrays must have the same length" << std::endl;
+        return Value::nil();
+    }
+
+    auto* ai = arrays.int32_data(a);
+    auto* bi = arrays.int32_data(b);
+    if (ai && bi) return Value::from_int64(simd::dot_i32(ai->data(), bi->data(), n));
+    auto* af = arrays.float64_data(a);
+    auto* bf = arrays.float64_data(b);
+    if (af && bf) return Value::floating(simd::dot_f64(af->data(), bf->data(), n));
+
+    // Mixed kinds or plain arrays: exact while everything is an int and fits,
+    // floats from the first overflow on like the VM's arithmetic
+    int64_t isum = 0;
+    double fsum = 0.0;
+    bool any_float = false;
+    for (size_t i = 0; i < n; ++i) {
+        Value x = arrays.get(a, static_cast<ssize_t>(i));
+        Value y = arrays.get(b, static_cast<ssize_t>(i));
+        if (!is_number(x) || !is_number(y)) continue;
+        int64_t product;
+        if (x.is_int() && y.is_int() && !Value::mul_overflows(x.as_integer(), y.as_integer(), product)) {
+            if (!Value::add_overflows(isum, product, isum)) continue;
+            fsum += static_cast<double>(isum) + static_cast<double>(product);
+            isum = 0;
+        } else {
+            fsum += number_of(x) * number_of(y);
+        }
+        any_float = true;
+    }
+    if (any_float) return Value::floating(fsum + static_cast<double>(isum));
+    return Value::from_int64(isum);
+}
+
+Value array_scale(VM* vm, const std::vector<Value>& args) {
+    if (args.size() != 2 || args[0].type() != ValueType::ARRAY || !is_number(args[1])) {
+        std::cerr << "scale: expected (array, number)" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t id = args[0].as_array_id();
+    const Value& k = args[1];
+
+    auto* i32 = arrays.int32_data(id);
+    if (auto* d = arrays.float64_data(id)) {
+        simd::scale_f64(d->data(), d->size(), number_of(k));
+    } else if (i32 && k.is_int()) {
+        simd::scale_i32(i32->data(), i32->size(), static_cast<int32_t>(static_cast<uint32_t>(k.as_integer())));
+    } else if (arrays.kind(id) != ArrayKind::VALUE) {
+        // uint8, or an int32 array scaled by a float: convert back like a store
+        size_t n = arrays.length(id);
+        for (size_t i = 0; i < n; ++i) {
+            Value v = arrays.get(id, static_cast<ssize_t>(i));
+            Value r = k.is_int() ? Value::multiply_ints(v.as_integer(), k.as_integer())
+                                 : Value::floating(number_of(v) * number_of(k));
+            arrays.set(id, static_cast<ssize_t>(i), r);
+        }
+    } else if (auto* d = arrays.values(id)) {
+        for (Value& v : *d) {
+            if (v.is_int() && k.is_int()) v = Value::multiply_ints(v.as_integer(), k.as_integer());
+            else if (is_number(v)) v = Value::floating(number_of(v) * number_of(k));
+        }
+    }
+    return args[0];
+}
+
+Value array_add_arrays(VM* vm, const std::vector<Value>& args) {
+    if (args.size() < 2 || args.size() > 3 ||
+        args[0].type() != ValueType::ARRAY || args[1].type() != ValueType::ARRAY ||
+        (args.size() == 3 && args[2].type() != ValueType::ARRAY)) {
+        std::cerr << "add_arrays: expected (array, array[, out])" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t a = args[0].as_array_id();
+    uint32_t b = args[1].as_array_id();
+    size_t n = arrays.length(a);
+    if (arrays.length(b) != n) {
+        std::cerr << "add_arrays: arrays must have the same length" << std::endl;
+        return Value::nil();
+    }
+
+    // Result goes to out when given, otherwise a new array of a's kind
+    uint32_t out;
+    if (args.size() == 3) {
+        out = args[2].as_array_id();
+        if (arrays.length(out) < n) {
+            std::cerr << "add_arrays: out array is too short" << std::endl;
+            return Value::nil();
+        }
+    } else if (arrays.kind(a) == ArrayKind::VALUE) {
+        out = arrays.create(n);
+        for (size_t i = 0; i < n; ++i) arrays.push_back(out, Value::nil());
+    } else {
+        out = arrays.create_typed(arrays.kind(a), n);
+    }
+
+    ArrayKind kind = arrays.kind(a);
+    if (kind == arrays.kind(b) && kind == arrays.kind(out)) {
+        switch (kind) {
+            case ArrayKind::INT32:
+                simd::add_i32(arrays.int32_data(a)->data(), arrays.int32_data(b)->data(), arrays.int32_data(out)->data(), n);
+                return Value::array_id(out);
+            case ArrayKind::UINT8:
+                simd::add_u8(arrays.uint8_data(a)->data(), arrays.uint8_data(b)->data(), arrays.uint8_data(out)->data(), n);
+                return Value::array_id(out);
+            case ArrayKind::FLOAT64:
+                simd::add_f64(arrays.float64_data(a)->data(), arrays.float64_data(b)->data(), arrays.float64_data(out)->data(), n);
+                return Value::array_id(out);
+            default:
+                break;
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        Value x = arrays.get(a, static_cast<ssize_t>(i));
+        Value y = arrays.get(b, static_cast<ssize_t>(i));
+        Value r = Value::nil();
+        if (x.is_int() && y.is_int()) r = Value::from_int64(x.as_integer() + y.as_integer());
+        else if (is_number(x) && is_number(y)) r = Value::floating(number_of(x) + number_of(y));
+        arrays.set(out, static_cast<ssize_t>(i), r);
+    }
+    return Value::array_id(out);
+}
+
+Value array_find_index(VM* vm, const std::vector<Value>& args) {
+    if (args.size() != 2 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "find_index: expected (array, value)" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    uint32_t id = args[0].as_array_id();
+    const Value& v = args[1];
+    const Value not_found = Value::integer(-1);
+
+    // Typed arrays compare numerically; a needle the element type can't hold never matches
+    if (auto* d = arrays.int32_data(id)) {
+        if (!is_number(v)) return not_found;
+        double x = number_of(v);
+        if (x != std::floor(x) || x < INT32_MIN || x > INT32_MAX) return not_found;
+        return Value::integer(simd::find_i32(d->data(), d->size(), static_cast<int32_t>(x)));
+    }
+    if (auto* d = arrays.uint8_data(id)) {
+        if (!is_number(v)) return not_found;
+        double x = number_of(v);
+        if (x != std::floor(x) || x < 0 || x > 255) return not_found;
+        return Value::integer(simd::find_u8(d->data(), d->size(), static_cast<uint8_t>(x)));
+    }
+    if (auto* d = arrays.float64_data(id)) {
+        if (!is_number(v)) return not_found;
+        return Value::integer(simd::find_f64(d->data(), d->size(), number_of(v)));
+    }
+
+    // Plain arrays use == semantics: nil, bools, ints and strings are equal
+    // exactly when the boxed bits are, so those search the raw words. == is
+    // never true for arrays, tables and the other reference types
+    auto* d = arrays.values(id);
+    if (!d) return not_found;
+    switch (v.type()) {
+        case ValueType::NIL:
+        case ValueType::BOOL:
+        case ValueType::INT:
+        case ValueType::STRING_ID: {
+            static_assert(sizeof(Value) == sizeof(uint64_t), "Value must be a single NaN-boxed word");
+            const uint64_t* words = reinterpret_cast<const uint64_t*>(d->data());
+            return Value::integer(simd::find_u64(words, d->size(), v.raw_bits()));
+        }
+        case ValueType::FLOAT:
+            break;
+        default:
+            return not_found;
+    }
+    double x = v.as_floating();
+    for (size_t i = 0; i < d->size(); ++i) {
+        const Value& e = (*d)[i];
+        if (e.is_float() && e.as_floating() == x) return Value::integer(static_cast<int64_t>(i));
+    }
+    return not_found;
+}
+
+// LSD radix sort on the sign-flipped bits, skipping passes where every key
+// lands in one bucket (small ranges only pay for one or two passes)
+static void radix_sort_i32(std::vector<int32_t>& data) {
+    size_t n = data.size();
+    std::vector<uint32_t> keys(n), tmp(n);
+    for (size_t i = 0; i < n; ++i) keys[i] = static_cast<uint32_t>(data[i]) ^ 0x80000000u;
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t count[257] = {0};
+        for (uint32_t k : keys) count[((k >> shift) & 0xFF) + 1]++;
+        if (std::find(count + 1, count + 257, n) != count + 257) continue;
+        for (int b = 0; b < 256; ++b) count[b + 1] += count[b];
+        for (uint32_t k : keys) tmp[count[(k >> shift) & 0xFF]++] = k;
+        keys.swap(tmp);
+    }
+    for (size_t i = 0; i < n; ++i) data[i] = static_cast<int32_t>(keys[i] ^ 0x80000000u);
+}
+
+// Ascending order without a comparator
+static void sort_natural(VM* vm, uint32_t id) {
+    ArrayTable& arrays = vm->arrays();
+    if (auto* d = arrays.int32_data(id)) {
+        if (d->size() < 256) std::sort(d->begin(), d->end());
+        else radix_sort_i32(*d);
+    } else if (auto* d = arrays.uint8_data(id)) {
+        size_t count[256] = {0};
+        for (uint8_t x : *d) count[x]++;
+        auto out = d->begin();
+        for (int b = 0; b < 256; ++b) out = std::fill_n(out, count[b], static_cast<uint8_t>(b));
+    } else if (auto* d = arrays.float64_data(id)) {
+        // NaNs have no order, park them at the end
+        auto nan_start = std::partition(d->begin(), d->end(), [](double x) { return !std::isnan(x); });
+        std::sort(d->begin(), nan_start);
+    } else if (auto* d = arrays.values(id)) {
+        // Numbers ascending, then strings by content, then everything else in original order
+        StringTable& strings = vm->strings();
+        auto rank = [](const Value& v) {
+            if (v.is_int() || (v.is_float() && !std::isnan(v.as_floating()))) return 0;
+            if (v.is_string_id()) return 1;
+            return 2;
+        };
+        std::stable_sort(d->begin(), d->end(), [&](const Value& a, const Value& b) {
+            int ra = rank(a), rb = rank(b);
+            if (ra != rb) return ra < rb;
+            if (ra == 0) {
+                if (a.is_int() && b.is_int()) return a.as_integer() < b.as_integer();
+                return number_of(a) < number_of(b);
+            }
+            if (ra == 1) return strings.get_string(a.as_string_id()) < strings.get_string(b.as_string_id());
+            return false;
+        });
+    }
+}
+
+// Callback argument: the name of a script function
+static bool callback_arg(VM* vm, const Value& v, ScriptFunction& fn, const char* name) {
+    if (v.type() != ValueType::STRING_ID) {
+        std::cerr << name << ": callback must be a function name" << std::endl;
+        return false;
+    }
+    const std::string& fname = vm->strings().get_string(v.as_string_id());
+    if (!vm->resolve_function(fname, fn)) {
+        std::cerr << name << ": unknown function " << fname << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool truthy(const Value& v) {
+    return !v.is_nil() && !v.is_false();
+}
+
+// Recognize `return a < b` / `return a > b` comparators so they sort natively.
+// Returns 1 for ascending, -1 for descending, 0 if the body is anything else
+static int simple_comparator(const ScriptFunction& fn) {
+    if (fn.param_count != 2) return 0;
+    const std::vector<uint8_t>& code = fn.chunk->code();
+    if (code.size() < 6) return 0;
+    const uint8_t get = static_cast<uint8_t>(OpCode::OP_GET_LOCAL);
+    if (code[0] != get || code[2] != get || code[5] != static_cast<uint8_t>(OpCode::OP_RETURN)) return 0;
+    for (size_t i = 6; i < code.size(); ++i) {
+        if (code[i] != static_cast<uint8_t>(OpCode::OP_RETURN)) return 0;
+    }
+    bool in_order;
+    if (code[1] == 0 && code[3] == 1) in_order = true;
+    else if (code[1] == 1 && code[3] == 0) in_order = false;
+    else return 0;
+    if (code[4] == static_cast<uint8_t>(OpCode::OP_LESS)) return in_order ? 1 : -1;
+    if (code[4] == static_cast<uint8_t>(OpCode::OP_GREATER)) return in_order ? -1 : 1;
+    return 0;
+}
+
+// Stable merge sort driven by a script comparator. Unlike std::sort it stays
+// in bounds whatever the comparator returns; stops at the first failed call
+static bool merge_sort_with(VM* vm, const ScriptFunction& cmp, std::vector<Value>& items) {
+    std::vector<Value> tmp(items.size());
+    Value pair[2];
+    Value result;
+    for (size_t width = 1; width < items.size(); width *= 2) {
+        for (size_t lo = 0; lo < items.size(); lo += 2 * width) {
+            size_t mid = std::min(lo + width, items.size());
+            size_t hi = std::min(lo + 2 * width, items.size());
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                // Take from the right only when it is strictly before the left
+                pair[0] = items[j];
+                pair[1] = items[i];
+                if (vm->call_function(cmp, pair, 2, result) != VMResult::OK) return false;
+                bool before = is_number(result) ? number_of(result) < 0 : truthy(result);
+                tmp[k++] = before ? items[j++] : items[i++];
+            }
+            while (i < mid) tmp[k++] = items[i++];
+            while (j < hi) tmp[k++] = items[j++];
+        }
+        items.swap(tmp);
+    }
+    return true;
+}
+
+Value array_sort(VM* vm, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "sort: expected (array[, comparator])" << std::endl;
+        return Value::nil();
+    }
+    Value array = args[0];
+    uint32_t id = array.as_array_id();
+    if (args.size() == 1) {
+        sort_natural(vm, id);
+        return array;
+    }
+
+    ScriptFunction cmp;
+    if (!callback_arg(vm, args[1], cmp, "sort")) return Value::nil();
+    ArrayTable& arrays = vm->arrays();
+    size_t n = arrays.length(id);
+
+    // a < b / a > b over plain numbers needs no calls at all
+    int order = simple_comparator(cmp);
+    if (order != 0) {
+        bool numeric = true;
+        if (auto* d = arrays.values(id)) {
+            for (const Value& v : *d) {
+                if (!v.is_int() && !(v.is_float() && !std::isnan(v.as_floating()))) { numeric = false; break; }
+            }
+        } else if (auto* d = arrays.float64_data(id)) {
+            numeric = std::none_of(d->begin(), d->end(), [](double x) { return std::isnan(x); });
+        }
+        if (numeric) {
+            sort_natural(vm, id);
+            if (order > 0) return array;
+            if (auto* d = arrays.int32_data(id)) std::reverse(d->begin(), d->end());
+            else if (auto* d = arrays.uint8_data(id)) std::reverse(d->begin(), d->end());
+            else if (auto* d = arrays.float64_data(id)) std::reverse(d->begin(), d->end());
+            else if (auto* d = arrays.values(id)) {
+                // Descending but stable: reverse, then put equal runs back in original order
+                std::reverse(d->begin(), d->end());
+                for (size_t lo = 0; lo < n;) {
+                    size_t hi = lo + 1;
+                    while (hi < n && number_of((*d)[hi]) == number_of((*d)[lo])) ++hi;
+                    std::reverse(d->begin() + lo, d->begin() + hi);
+                    lo = hi;
+                }
+            }
+            return array;
+        }
+    }
+
+    // Sort a snapshot so a callback that edits the array can't break the merge
+    std::vector<Value> items(n);
+    for (size_t i = 0; i < n; ++i) items[i] = arrays.get(id, static_cast<ssize_t>(i));
+    vm->push_root(array);
+    bool ok = merge_sort_with(vm, cmp, items);
+    vm->pop_roots(1);
+    if (!ok) {
+        std::cerr << "sort: comparator failed" << std::endl;
+        return Value::nil();
+    }
+    size_t count = std::min(n, arrays.length(id));
+    for (size_t i = 0; i < count; ++i) arrays.set(id, static_cast<ssize_t>(i), items[i]);
+    return array;
+}
+
+// New array of the same kind as id, for results that keep the element type
+static uint32_t create_like(ArrayTable& arrays, uint32_t id) {
+    ArrayKind kind = arrays.kind(id);
+    if (kind == ArrayKind::VALUE) return arrays.create();
+    return arrays.create_typed(kind, 0);
+}
+
+Value array_filter(VM* vm, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "filter: expected (array[, predicate])" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    Value array = args[0];
+    uint32_t id = array.as_array_id();
+
+    // No predicate: keep truthy elements (typed arrays hold only numbers)
+    if (args.size() == 1) {
+        if (auto* d = arrays.values(id)) {
+            uint32_t out = arrays.create(0);
+            std::vector<Value> kept;
+            kept.reserve(d->size());
+            for (const Value& v : *d) if (truthy(v)) kept.push_back(v);
+            *arrays.values(out) = std::move(kept);
+            return Value::array_id(out);
+        }
+        return array_map(vm, {array});
+    }
+
+    ScriptFunction pred;
+    if (!callback_arg(vm, args[1], pred, "filter")) return Value::nil();
+    uint32_t out = create_like(arrays, id);
+    vm->push_root(array);
+    vm->push_root(Value::array_id(out));
+    Value call_args[2];
+    Value result;
+    bool ok = true;
+    size_t argc = pred.param_count >= 2 ? 2 : 1;
+    for (size_t i = 0; i < arrays.length(id); ++i) {
+        call_args[0] = arrays.get(id, static_cast<ssize_t>(i));
+        call_args[1] = Value::integer(static_cast<int64_t>(i));
+        if (vm->call_function(pred, call_args, argc, result) != VMResult::OK) { ok = false; break; }
+        if (truthy(result)) arrays.push_back(out, call_args[0]);
+    }
+    vm->pop_roots(2);
+    if (!ok) {
+        std::cerr << "filter: predicate failed" << std::endl;
+        return Value::nil();
+    }
+    return Value::array_id(out);
+}
+
+Value array_map(VM* vm, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "map: expected (array[, function])" << std::endl;
+        return Value::nil();
+    }
+    ArrayTable& arrays = vm->arrays();
+    Value array = args[0];
+    uint32_t id = array.as_array_id();
+    size_t n = arrays.length(id);
+
+    // No function: a copy of the same kind
+    if (args.size() == 1) {
+        if (arrays.kind(id) == ArrayKind::VALUE) {
+            uint32_t out = arrays.create(n);
+            *arrays.values(out) = *arrays.values(id);
+            return Value::array_id(out);
+        }
+        uint32_t out = arrays.create_typed(arrays.kind(id), n);
+        return array_copy(vm, {Value::array_id(out), array});
+    }
+
+    // Results can be anything, so they always go into a plain array
+    ScriptFunction fn;
+    if (!callback_arg(vm, args[1], fn, "map")) return Value::nil();
+    uint32_t out = arrays.create(n);
+    vm->push_root(array);
+    vm->push_root(Value::array_id(out));
+    Value call_args[2];
+    Value result;
+    bool ok = true;
+    size_t argc = fn.param_count >= 2 ? 2 : 1;
+    for (size_t i = 0; i < arrays.length(id); ++i) {
+        call_args[0] = arrays.get(id, static_cast<ssize_t>(i));
+        call_args[1] = Value::integer(static_cast<int64_t>(i));
+        if (vm->call_function(fn, call_args, argc, result) != VMResult::OK) { ok = false; break; }
+        arrays.push_back(out, result);
+    }
+    vm->pop_roots(2);
+    if (!ok) {
+        std::cerr << "map: function failed" << std::endl;
+        return Value::nil();
+    }
+    return Value::array_id(out);
+}
+
+Value array_reduce(VM* vm, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 3 || args[0].type() != ValueType::ARRAY) {
+        std::cerr << "reduce: expected (array[, function[, initial]])" << std::endl;
+        return Value::nil();
+    }
+    // No function: numeric sum
+    if (args.size() == 1) return array_sum(vm, args);
+
+    ScriptFunction fn;
+    if (!callback_arg(vm, args[1], fn, "reduce")) return Value::nil();
+    ArrayTable& arrays = vm->arrays();
+    Value array = args[0];
+    uint32_t id = array.as_array_id();
+
+    size_t start = 0;
+    Value acc;
+    if (args.size() == 3) {
+        acc = args[2];
+    } else {
+        if (arrays.length(id) == 0) return Value::nil();
+        acc = arrays.get(id, 0);
+        start = 1;
+    }
+
+    vm->push_root(array);
+    Value call_args[3];
+    bool ok = true;
+    size_t argc = fn.param_count >= 3 ? 3 : 2;
+    for (size_t i = start; i < arrays.length(id); ++i) {
+        call_args[0] = acc;
+        call_args[1] = arrays.get(id, static_cast<ssize_t>(i));
+        call_args[2] = Value::integer(static_cast<int64_t>(i));
+        // The accumulator only lives in this frame, keep it reachable
+        vm->push_root(acc);
+        VMResult r = vm->call_function(fn, call_args, argc, acc);
+        vm->pop_roots(1);
+        if (r != VMResult::OK) { ok = false; break; }
+    }
+    vm->pop_roots(1);
+    if (!ok) {
+        std::cerr << "reduce: function failed" << std::endl;
+        return Value::nil();
+    }
+    return acc;
+}
+
+void register_array_functions(HostEnvironment* env, VM* vm) {
+    env->register_function("int32_array", [vm](const std::vector<Value>& args) {
+        return array_int32(vm, args);
+    });
+
+    env->register_function("float64_array", [vm](const std::vector<Value>& args) {
+        return array_float64(vm, args);
+    });
+
+    env->register_function("uint8_array", [vm](const std::vector<Value>& args) {
+        return array_uint8(vm, args);
+    });
+
+    env->register_function("array_fill", [vm](const std::vector<Value>& args) {
+        return array_fill(vm, args);
+    });
+
+    env->register_function("array_copy", [vm](const std::vector<Value>& args) {
+        return array_copy(vm, args);
+    });
+
+    env->register_function("array_sum", [vm](const std::vector<Value>& args) {
+        return array_sum(vm, args);
+    });
+
+    env->register_function("array_map_add", [vm](const std::vector<Value>& args) {
+        return array_map_add(vm, args);
+    });
+
+    env->register_function("sum", [vm](const std::vector<Value>& args) {
+        return array_sum(vm, args);
+    });
+
+    env->register_function("min", [vm](const std::vector<Value>& args) {
+        return array_min(vm, args);
+    });
+
+    env->register_function("max", [vm](const std::vector<Value>& args) {
+        return array_max(vm, args);
+    });
+
+    env->register_function("dot", [vm](const std::vector<Value>& args) {
+        return array_dot(vm, args);
+    });
+
+    env->register_function("scale", [vm](const std::vector<Value>& args) {
+        return array_scale(vm, args);
+    });
+
+    env->register_function("add_arrays", [vm](const std::vector<Value>& args) {
+        return array_add_arrays(vm, args);
+    });
+
+    env->register_function("find_index", [vm](const std::vector<Value>& args) {
+        return array_find_index(vm, args);
+    });
+
+    env->register_function("sort", [vm](const std::vector<Value>& args) {
+        return array_sort(vm, args);
+    });
+
+    env->register_function("filter", [vm](const std::vector<Value>& args) {
+        return array_filter(vm, args);
+    });
+
+    env->register_function("map", [vm](const std::vector<Value>& args) {
+        return array_map(vm, args);
+    });
+
+    env->register_function("reduce", [vm](const std::vector<Value>& args) {
+        return array_reduce(vm, args);
+    });
+}
+
+} // namespace stdlib
+} // namespace nightscript
+} // namespace nightforge
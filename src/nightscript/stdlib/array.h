@@ -0,0 +1,41 @@
+#pragma once
+#include "../host_api.h"
+#include "../vm.h"
+#include <vector>
+
+namespace nightforge {
+namespace nightscript {
+namespace stdlib {
+
+// Register typed array constructors and bulk array operations
+void register_array_functions(HostEnvironment* env, VM* vm);
+
+// Typed array constructors: (length[, fill])
+Value array_int32(VM* vm, const std::vector<Value>& args);
+Value array_float64(VM* vm, const std::vector<Value>& args);
+Value array_uint8(VM* vm, const std::vector<Value>& args);
+
+// Bulk operations (work on plain arrays too, typed ones take the fast path)
+Value array_fill(VM* vm, const std::vector<Value>& args);
+Value array_copy(VM* vm, const std::vector<Value>& args);
+Value array_sum(VM* vm, const std::vector<Value>& args);
+Value array_map_add(VM* vm, const std::vector<Value>& args);
+
+// Numeric kernels (SIMD on typed arrays, see simd.h). sort also takes a comparator
+Value array_min(VM* vm, const std::vector<Value>& args);
+Value array_max(VM* vm, const std::vector<Value>& args);
+Value array_dot(VM* vm, const std::vector<Value>& args);
+Value array_scale(VM* vm, const std::vector<Value>& args);
+Value array_add_arrays(VM* vm, const std::vector<Value>& args);
+Value array_find_index(VM* vm, const std::vector<Value>& args);
+Value array_sort(VM* vm, const std::vector<Value>& args);
+
+// Higher-order operations. Callbacks are script function names, resolved once
+// per call and invoked through VM::call_function
+Value array_filter(VM* vm, const std::vector<Value>& args);
+Value array_map(VM* vm, const std::vector<Value>& args);
+Value array_reduce(VM* vm, const std::vector<Value>& args);
+
+} // namespace stdlib
+} // namespace nightscript
+} // namespace nightforge
@@ -0,0 +1,630 @@
+#include "simd.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define NIGHTSCRIPT_SIMD_X86 1
+    #include <immintrin.h>
+    #define NS_SSE41 __attribute__((target("sse4.1")))
+    #define NS_AVX2 __attribute__((target("avx2")))
+#else
+    #define NIGHTSCRIPT_SIMD_X86 0
+#endif
+
+namespace nightforge {
+namespace nightscript {
+namespace stdlib {
+namespace simd {
+
+// Plain loops. Used on other architectures and for the tails of the wide kernels
+namespace scalar {
+
+static int64_t sum_i32(const int32_t* p, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i < n; ++i) s += p[i];
+    return s;
+}
+
+static uint64_t sum_u8(const uint8_t* p, size_t n) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < n; ++i) s += p[i];
+    return s;
+}
+
+static double sum_f64(const double* p, size_t n) {
+    double s = 0.0;
+    for (size_t i = 0; i < n; ++i) s += p[i];
+    return s;
+}
+
+template <typename T>
+static T min_of(const T* p, size_t n, T m) {
+    for (size_t i = 0; i < n; ++i) if (p[i] < m) m = p[i];
+    return m;
+}
+
+template <typename T>
+static T max_of(const T* p, size_t n, T m) {
+    for (size_t i = 0; i < n; ++i) if (p[i] > m) m = p[i];
+    return m;
+}
+
+static int32_t min_i32(const int32_t* p, size_t n) { return min_of(p, n, p[0]); }
+static int32_t max_i32(const int32_t* p, size_t n) { return max_of(p, n, p[0]); }
+static uint8_t min_u8(const uint8_t* p, size_t n) { return min_of(p, n, p[0]); }
+static uint8_t max_u8(const uint8_t* p, size_t n) { return max_of(p, n, p[0]); }
+static double min_f64(const double* p, size_t n) { return min_of(p, n, p[0]); }
+static double max_f64(const double* p, size_t n) { return max_of(p, n, p[0]); }
+
+static int64_t dot_i32(const int32_t* a, const int32_t* b, size_t n) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < n; ++i) s += static_cast<uint64_t>(static_cast<int64_t>(a[i]) * b[i]);
+    return static_cast<int64_t>(s);
+}
+
+static double dot_f64(const double* a, const double* b, size_t n) {
+    double s = 0.0;
+    for (size_t i = 0; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+static void scale_i32(int32_t* p, size_t n, int32_t k) {
+    for (size_t i = 0; i < n; ++i) {
+        p[i] = static_cast<int32_t>(static_cast<uint32_t>(p[i]) * static_cast<uint32_t>(k));
+    }
+}
+
+static void scale_f64(double* p, size_t n, double k) {
+    for (size_t i = 0; i < n; ++i) p[i] *= k;
+}
+
+static void add_i32(const int32_t* a, const int32_t* b, int32_t* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<int32_t>(static_cast<uint32_t>(a[i]) + static_cast<uint32_t>(b[i]));
+    }
+}
+
+static void add_u8(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = static_cast<uint8_t>(a[i] + b[i]);
+}
+
+static void add_f64(const double* a, const double* b, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+template <typename T>
+static ssize_t find_of(const T* p, size_t n, T v) {
+    for (size_t i = 0; i < n; ++i) if (p[i] == v) return static_cast<ssize_t>(i);
+    return -1;
+}
+
+static ssize_t find_i32(const int32_t* p, size_t n, int32_t v) { return find_of(p, n, v); }
+static ssize_t find_u8(const uint8_t* p, size_t n, uint8_t v) { return find_of(p, n, v); }
+static ssize_t find_f64(const double* p, size_t n, double v) { return find_of(p, n, v); }
+static ssize_t find_u64(const uint64_t* p, size_t n, uint64_t v) { return find_of(p, n, v); }
+
+} // namespace scalar
+
+// Finish a vector search with the scalar tail starting at i
+template <typename T>
+static ssize_t find_tail(const T* p, size_t i, size_t n, T v) {
+    ssize_t r = scalar::find_of(p + i, n - i, v);
+    return r < 0 ? -1 : static_cast<ssize_t>(i) + r;
+}
+
+#if NIGHTSCRIPT_SIMD_X86
+
+namespace sse41 {
+
+NS_SSE41 static int64_t sum_i32(const int32_t* p, size_t n) {
+    __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        acc0 = _mm_add_epi64(acc0, _mm_cvtepi32_epi64(v));
+        acc1 = _mm_add_epi64(acc1, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(v, v)));
+    }
+    acc0 = _mm_add_epi64(acc0, acc1);
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc0);
+    return lanes[0] + lanes[1] + scalar::sum_i32(p + i, n - i);
+}
+
+NS_SSE41 static uint64_t sum_u8(const uint8_t* p, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + scalar::sum_u8(p + i, n - i);
+}
+
+NS_SSE41 static double sum_f64(const double* p, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(p + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(p + i + 2));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc0);
+    return (lanes[0] + lanes[1]) + scalar::sum_f64(p + i, n - i);
+}
+
+NS_SSE41 static int32_t min_i32(const int32_t* p, size_t n) {
+    __m128i m = _mm_set1_epi32(p[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) m = _mm_min_epi32(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), m);
+    return scalar::min_of(p + i, n - i, scalar::min_of(lanes, 4, lanes[0]));
+}
+
+NS_SSE41 static int32_t max_i32(const int32_t* p, size_t n) {
+    __m128i m = _mm_set1_epi32(p[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) m = _mm_max_epi32(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), m);
+    return scalar::max_of(p + i, n - i, scalar::max_of(lanes, 4, lanes[0]));
+}
+
+NS_SSE41 static uint8_t min_u8(const uint8_t* p, size_t n) {
+    __m128i m = _mm_set1_epi8(static_cast<char>(p[0]));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) m = _mm_min_epu8(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    uint8_t lanes[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), m);
+    return scalar::min_of(p + i, n - i, scalar::min_of(lanes, 16, lanes[0]));
+}
+
+NS_SSE41 static uint8_t max_u8(const uint8_t* p, size_t n) {
+    __m128i m = _mm_set1_epi8(static_cast<char>(p[0]));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) m = _mm_max_epu8(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    uint8_t lanes[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), m);
+    return scalar::max_of(p + i, n - i, scalar::max_of(lanes, 16, lanes[0]));
+}
+
+NS_SSE41 static double min_f64(const double* p, size_t n) {
+    __m128d m = _mm_set1_pd(p[0]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) m = _mm_min_pd(m, _mm_loadu_pd(p + i));
+    double lanes[2];
+    _mm_storeu_pd(lanes, m);
+    return scalar::min_of(p + i, n - i, scalar::min_of(lanes, 2, lanes[0]));
+}
+
+NS_SSE41 static double max_f64(const double* p, size_t n) {
+    __m128d m = _mm_set1_pd(p[0]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) m = _mm_max_pd(m, _mm_loadu_pd(p + i));
+    double lanes[2];
+    _mm_storeu_pd(lanes, m);
+    return scalar::max_of(p + i, n - i, scalar::max_of(lanes, 2, lanes[0]));
+}
+
+NS_SSE41 static int64_t dot_i32(const int32_t* a, const int32_t* b, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        // mul_epi32 multiplies the even signed lanes into 64-bit products
+        acc = _mm_add_epi64(acc, _mm_mul_epi32(va, vb));
+        acc = _mm_add_epi64(acc, _mm_mul_epi32(_mm_srli_epi64(va, 32), _mm_srli_epi64(vb, 32)));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return static_cast<int64_t>(static_cast<uint64_t>(lanes[0]) + static_cast<uint64_t>(lanes[1]) +
+                                static_cast<uint64_t>(scalar::dot_i32(a + i, b + i, n - i)));
+}
+
+NS_SSE41 static double dot_f64(const double* a, const double* b, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc0);
+    return (lanes[0] + lanes[1]) + scalar::dot_f64(a + i, b + i, n - i);
+}
+
+NS_SSE41 static void scale_i32(int32_t* p, size_t n, int32_t k) {
+    const __m128i vk = _mm_set1_epi32(k);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i* q = reinterpret_cast<__m128i*>(p + i);
+        _mm_storeu_si128(q, _mm_mullo_epi32(_mm_loadu_si128(q), vk));
+    }
+    scalar::scale_i32(p + i, n - i, k);
+}
+
+NS_SSE41 static void scale_f64(double* p, size_t n, double k) {
+    const __m128d vk = _mm_set1_pd(k);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(p + i, _mm_mul_pd(_mm_loadu_pd(p + i), vk));
+    scalar::scale_f64(p + i, n - i, k);
+}
+
+NS_SSE41 static void add_i32(const int32_t* a, const int32_t* b, int32_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(va, vb));
+    }
+    scalar::add_i32(a + i, b + i, out + i, n - i);
+}
+
+NS_SSE41 static void add_u8(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(va, vb));
+    }
+    scalar::add_u8(a + i, b + i, out + i, n - i);
+}
+
+NS_SSE41 static void add_f64(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    scalar::add_f64(a + i, b + i, out + i, n - i);
+}
+
+NS_SSE41 static ssize_t find_i32(const int32_t* p, size_t n, int32_t v) {
+    const __m128i needle = _mm_set1_epi32(v);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+NS_SSE41 static ssize_t find_u8(const uint8_t* p, size_t n, uint8_t v) {
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(v));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle);
+        int mask = _mm_movemask_epi8(eq);
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+NS_SSE41 static ssize_t find_f64(const double* p, size_t n, double v) {
+    const __m128d needle = _mm_set1_pd(v);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p + i), needle));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+NS_SSE41 static ssize_t find_u64(const uint64_t* p, size_t n, uint64_t v) {
+    const __m128i needle = _mm_set1_epi64x(static_cast<int64_t>(v));
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i eq = _mm_cmpeq_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+} // namespace sse41
+
+namespace avx2 {
+
+NS_AVX2 static int64_t sum_i32(const int32_t* p, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 4));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(lo));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(hi));
+    }
+    acc0 = _mm256_add_epi64(acc0, acc1);
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc0);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar::sum_i32(p + i, n - i);
+}
+
+NS_AVX2 static uint64_t sum_u8(const uint8_t* p, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar::sum_u8(p + i, n - i);
+}
+
+NS_AVX2 static double sum_f64(const double* p, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(p + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(p + i + 4));
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc0);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + scalar::sum_f64(p + i, n - i);
+}
+
+NS_AVX2 static int32_t min_i32(const int32_t* p, size_t n) {
+    __m256i m = _mm256_set1_epi32(p[0]);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) m = _mm256_min_epi32(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    int32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), m);
+    return scalar::min_of(p + i, n - i, scalar::min_of(lanes, 8, lanes[0]));
+}
+
+NS_AVX2 static int32_t max_i32(const int32_t* p, size_t n) {
+    __m256i m = _mm256_set1_epi32(p[0]);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) m = _mm256_max_epi32(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    int32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), m);
+    return scalar::max_of(p + i, n - i, scalar::max_of(lanes, 8, lanes[0]));
+}
+
+NS_AVX2 static uint8_t min_u8(const uint8_t* p, size_t n) {
+    __m256i m = _mm256_set1_epi8(static_cast<char>(p[0]));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) m = _mm256_min_epu8(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    uint8_t lanes[32];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), m);
+    return scalar::min_of(p + i, n - i, scalar::min_of(lanes, 32, lanes[0]));
+}
+
+NS_AVX2 static uint8_t max_u8(const uint8_t* p, size_t n) {
+    __m256i m = _mm256_set1_epi8(static_cast<char>(p[0]));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) m = _mm256_max_epu8(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    uint8_t lanes[32];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), m);
+    return scalar::max_of(p + i, n - i, scalar::max_of(lanes, 32, lanes[0]));
+}
+
+NS_AVX2 static double min_f64(const double* p, size_t n) {
+    __m256d m = _mm256_set1_pd(p[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) m = _mm256_min_pd(m, _mm256_loadu_pd(p + i));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, m);
+    return scalar::min_of(p + i, n - i, scalar::min_of(lanes, 4, lanes[0]));
+}
+
+NS_AVX2 static double max_f64(const double* p, size_t n) {
+    __m256d m = _mm256_set1_pd(p[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) m = _mm256_max_pd(m, _mm256_loadu_pd(p + i));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, m);
+    return scalar::max_of(p + i, n - i, scalar::max_of(lanes, 4, lanes[0]));
+}
+
+NS_AVX2 static int64_t dot_i32(const int32_t* a, const int32_t* b, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_mul_epi32(va, vb));
+        acc1 = _mm256_add_epi64(acc1, _mm256_mul_epi32(_mm256_srli_epi64(va, 32), _mm256_srli_epi64(vb, 32)));
+    }
+    acc0 = _mm256_add_epi64(acc0, acc1);
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc0);
+    return static_cast<int64_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+                                static_cast<uint64_t>(scalar::dot_i32(a + i, b + i, n - i)));
+}
+
+NS_AVX2 static double dot_f64(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc0);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + scalar::dot_f64(a + i, b + i, n - i);
+}
+
+NS_AVX2 static void scale_i32(int32_t* p, size_t n, int32_t k) {
+    const __m256i vk = _mm256_set1_epi32(k);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i* q = reinterpret_cast<__m256i*>(p + i);
+        _mm256_storeu_si256(q, _mm256_mullo_epi32(_mm256_loadu_si256(q), vk));
+    }
+    scalar::scale_i32(p + i, n - i, k);
+}
+
+NS_AVX2 static void scale_f64(double* p, size_t n, double k) {
+    const __m256d vk = _mm256_set1_pd(k);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(p + i, _mm256_mul_pd(_mm256_loadu_pd(p + i), vk));
+    scalar::scale_f64(p + i, n - i, k);
+}
+
+NS_AVX2 static void add_i32(const int32_t* a, const int32_t* b, int32_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(va, vb));
+    }
+    scalar::add_i32(a + i, b + i, out + i, n - i);
+}
+
+NS_AVX2 static void add_u8(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi8(va, vb));
+    }
+    scalar::add_u8(a + i, b + i, out + i, n - i);
+}
+
+NS_AVX2 static void add_f64(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    scalar::add_f64(a + i, b + i, out + i, n - i);
+}
+
+NS_AVX2 static ssize_t find_i32(const int32_t* p, size_t n, int32_t v) {
+    const __m256i needle = _mm256_set1_epi32(v);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), needle);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+NS_AVX2 static ssize_t find_u8(const uint8_t* p, size_t n, uint8_t v) {
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(v));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), needle);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+NS_AVX2 static ssize_t find_f64(const double* p, size_t n, double v) {
+    const __m256d needle = _mm256_set1_pd(v);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + i), needle, _CMP_EQ_OQ));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+NS_AVX2 static ssize_t find_u64(const uint64_t* p, size_t n, uint64_t v) {
+    const __m256i needle = _mm256_set1_epi64x(static_cast<int64_t>(v));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), needle);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask) return static_cast<ssize_t>(i) + __builtin_ctz(mask);
+    }
+    return find_tail(p, i, n, v);
+}
+
+} // namespace avx2
+
+#endif // NIGHTSCRIPT_SIMD_X86
+
+struct Kernels {
+    Level level;
+    int64_t (*sum_i32)(const int32_t*, size_t);
+    uint64_t (*sum_u8)(const uint8_t*, size_t);
+    double (*sum_f64)(const double*, size_t);
+    int32_t (*min_i32)(const int32_t*, size_t);
+    int32_t (*max_i32)(const int32_t*, size_t);
+    uint8_t (*min_u8)(const uint8_t*, size_t);
+    uint8_t (*max_u8)(const uint8_t*, size_t);
+    double (*min_f64)(const double*, size_t);
+    double (*max_f64)(const double*, size_t);
+    int64_t (*dot_i32)(const int32_t*, const int32_t*, size_t);
+    double (*dot_f64)(const double*, const double*, size_t);
+    void (*scale_i32)(int32_t*, size_t, int32_t);
+    void (*scale_f64)(double*, size_t, double);
+    void (*add_i32)(const int32_t*, const int32_t*, int32_t*, size_t);
+    void (*add_u8)(const uint8_t*, const uint8_t*, uint8_t*, size_t);
+    void (*add_f64)(const double*, const double*, double*, size_t);
+    ssize_t (*find_i32)(const int32_t*, size_t, int32_t);
+    ssize_t (*find_u8)(const uint8_t*, size_t, uint8_t);
+    ssize_t (*find_f64)(const double*, size_t, double);
+    ssize_t (*find_u64)(const uint64_t*, size_t, uint64_t);
+};
+
+#define NS_KERNEL_TABLE(lvl, ns) \
+    Kernels{lvl, ns::sum_i32, ns::sum_u8, ns::sum_f64, ns::min_i32, ns::max_i32, ns::min_u8, ns::max_u8, \
+            ns::min_f64, ns::max_f64, ns::dot_i32, ns::dot_f64, ns::scale_i32, ns::scale_f64, \
+            ns::add_i32, ns::add_u8, ns::add_f64, ns::find_i32, ns::find_u8, ns::find_f64, ns::find_u64}
+
+static Kernels select_kernels() {
+#if NIGHTSCRIPT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return NS_KERNEL_TABLE(Level::AVX2, avx2);
+    if (__builtin_cpu_supports("sse4.1")) return NS_KERNEL_TABLE(Level::SSE41, sse41);
+#endif
+    return NS_KERNEL_TABLE(Level::SCALAR, scalar);
+}
+
+#undef NS_KERNEL_TABLE
+
+static const Kernels& kernels() {
+    static const Kernels k = select_kernels();
+    return k;
+}
+
+Level level() { return kernels().level; }
+
+const char* level_name() {
+    switch (level()) {
+        case Level::AVX2: return "avx2";
+        case Level::SSE41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+int64_t sum_i32(const int32_t* p, size_t n) { return kernels().sum_i32(p, n); }
+uint64_t sum_u8(const uint8_t* p, size_t n) { return kernels().sum_u8(p, n); }
+double sum_f64(const double* p, size_t n) { return kernels().sum_f64(p, n); }
+
+int32_t min_i32(const int32_t* p, size_t n) { return kernels().min_i32(p, n); }
+int32_t max_i32(const int32_t* p, size_t n) { return kernels().max_i32(p, n); }
+uint8_t min_u8(const uint8_t* p, size_t n) { return kernels().min_u8(p, n); }
+uint8_t max_u8(const uint8_t* p, size_t n) { return kernels().max_u8(p, n); }
+double min_f64(const double* p, size_t n) { return kernels().min_f64(p, n); }
+double max_f64(const double* p, size_t n) { return kernels().max_f64(p, n); }
+
+int64_t dot_i32(const int32_t* a, const int32_t* b, size_t n) { return kernels().dot_i32(a, b, n); }
+double dot_f64(const double* a, const double* b, size_t n) { return kernels().dot_f64(a, b, n); }
+
+void scale_i32(int32_t* p, size_t n, int32_t k) { kernels().scale_i32(p, n, k); }
+void scale_f64(double* p, size_t n, double k) { kernels().scale_f64(p, n, k); }
+
+void add_i32(const int32_t* a, const int32_t* b, int32_t* out, size_t n) { kernels().add_i32(a, b, out, n); }
+void add_u8(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t n) { kernels().add_u8(a, b, out, n); }
+void add_f64(const double* a, const double* b, double* out, size_t n) { kernels().add_f64(a, b, out, n); }
+
+ssize_t find_i32(const int32_t* p, size_t n, int32_t v) { return kernels().find_i32(p, n, v); }
+ssize_t find_u8(const uint8_t* p, size_t n, uint8_t v) { return kernels().find_u8(p, n, v); }
+ssize_t find_f64(const double* p, size_t n, double v) { return kernels().find_f64(p, n, v); }
+ssize_t find_u64(const uint64_t* p, size_t n, uint64_t v) { return kernels().find_u64(p, n, v); }
+
+} // namespace simd
+} // namespace stdlib
+} // namespace nightscript
+} // namespace nightforge
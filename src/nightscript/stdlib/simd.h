@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace nightforge {
+namespace nightscript {
+namespace stdlib {
+namespace simd {
+
+// Kernels over contiguous numeric storage. The best variant for the running
+// CPU (AVX2, SSE4.1, plain C++) is picked once on first use, so a binary built
+// without -march=native still gets the wide paths where they exist.
+// Float reductions add in lane order, not left to right, so the last bits can
+// differ from a sequential loop. NaN elements give unspecified min/max results.
+enum class Level : uint8_t { SCALAR, SSE41, AVX2 };
+
+Level level();
+const char* level_name();
+
+int64_t sum_i32(const int32_t* p, size_t n);
+uint64_t sum_u8(const uint8_t* p, size_t n);
+double sum_f64(const double* p, size_t n);
+
+// n must be > 0
+int32_t min_i32(const int32_t* p, size_t n);
+int32_t max_i32(const int32_t* p, size_t n);
+uint8_t min_u8(const uint8_t* p, size_t n);
+uint8_t max_u8(const uint8_t* p, size_t n);
+double min_f64(const double* p, size_t n);
+double max_f64(const double* p, size_t n);
+
+int64_t dot_i32(const int32_t* a, const int32_t* b, size_t n); // wraps like int64
+double dot_f64(const double* a, const double* b, size_t n);
+
+// In place, integer kinds wrap like the C element type
+void scale_i32(int32_t* p, size_t n, int32_t k);
+void scale_f64(double* p, size_t n, double k);
+
+// out[i] = a[i] + b[i]; out may alias a or b
+void add_i32(const int32_t* a, const int32_t* b, int32_t* out, size_t n);
+void add_u8(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t n);
+void add_f64(const double* a, const double* b, double* out, size_t n);
+
+// First index equal to v, -1 if none
+ssize_t find_i32(const int32_t* p, size_t n, int32_t v);
+ssize_t find_u8(const uint8_t* p, size_t n, uint8_t v);
+ssize_t find_f64(const double* p, size_t n, double v);
+ssize_t find_u64(const uint64_t* p, size_t n, uint64_t v); // raw Value bits
+
+} // namespace simd
+} // namespace stdlib
+} // namespace nightscript
+} // namespace nightforge
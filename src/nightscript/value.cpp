@@ -281,22 +281,93 @@ uint32_t ArrayTable::create(size_t reserve) {
     return id;
 }
 
+uint32_t ArrayTable::create_typed(ArrayKind kind, size_t length) {
+    uint32_t id = create();
+    ArrayEntry& a = arrays_[id];
+    a.kind = kind;
+    switch (kind) {
+        case ArrayKind::INT32: a.i32.assign(length, 0); break;
+        case ArrayKind::FLOAT64: a.f64.assign(length, 0.0); break;
+        case ArrayKind::UINT8: a.u8.assign(length, 0); break;
+        case ArrayKind::VALUE: a.items.assign(length, Value::nil()); break;
+    }
+    return id;
+}
+
+ArrayKind ArrayTable::kind(uint32_t id) const {
+    if (id >= arrays_.size()) return ArrayKind::VALUE;
+    return arrays_[id].kind;
+}
+
+size_t ArrayTable::length_of(const ArrayEntry& a) {
+    switch (a.kind) {
+        case ArrayKind::INT32: return a.i32.size();
+        case ArrayKind::FLOAT64: return a.f64.size();
+        case ArrayKind::UINT8: return a.u8.size();
+        default: return a.items.size();
+    }
+}
+
+Value ArrayTable::load(const ArrayEntry& a, size_t i) {
+    switch (a.kind) {
+        case ArrayKind::INT32: return Value::integer(a.i32[i]);
+        case ArrayKind::FLOAT64: return Value::floating(a.f64[i]);
+        case ArrayKind::UINT8: return Value::integer(a.u8[i]);
+        default: return a.items[i];
+    }
+}
+
+static inline int64_t to_int64(const Value& v) {
+    if (v.is_int()) return v.as_integer();
+    double d = v.as_floating();
+    if (!(d > -9.2e18 && d < 9.2e18)) return 0; // NaN / out of range
+    return static_cast<int64_t>(d);
+}
+
+void ArrayTable::store(ArrayEntry& a, size_t i, const Value& v) {
+    if (a.kind == ArrayKind::VALUE) {
+        a.items[i] = v;
+        return;
+    }
+    if (!v.is_int() && !v.is_float()) return;
+    switch (a.kind) {
+        // int kinds wrap like a C cast
+        case ArrayKind::INT32: a.i32[i] = static_cast<int32_t>(static_cast<uint32_t>(to_int64(v))); break;
+        case ArrayKind::UINT8: a.u8[i] = static_cast<uint8_t>(to_int64(v)); break;
+        case ArrayKind::FLOAT64: a.f64[i] = v.is_int() ? static_cast<double>(v.as_integer()) : v.as_floating(); break;
+        default: break;
+    }
+}
+
 size_t ArrayTable::length(uint32_t id) const {
     if (id >= arrays_.size()) return 0;
-    return arrays_[id].items.size();
+    return length_of(arrays_[id]);
 }
 
 void ArrayTable::push_back(uint32_t id, const Value& v) {
     if (id >= arrays_.size()) return;
-    arrays_[id].items.push_back(v);
+    ArrayEntry& a = arrays_[id];
+    switch (a.kind) {
+        case ArrayKind::INT32: a.i32.push_back(0); break;
+        case ArrayKind::FLOAT64: a.f64.push_back(0.0); break;
+        case ArrayKind::UINT8: a.u8.push_back(0); break;
+        default: a.items.push_back(v); return;
+    }
+    store(a, length_of(a) - 1, v);
 }
 
 Value ArrayTable::pop_back(uint32_t id) {
     if (id >= arrays_.size()) return Value::nil();
-    auto &vec = arrays_[id].items;
-    if (vec.empty()) return Value::nil();
-    Value v = vec.back();
-    vec.pop_back();
+    ArrayEntry& a = arrays_[id];
+    size_t n = length_of(a);
+    if (n == 0) return Value::nil();
+    Value v = load(a, n - 1);
+    switch (a.kind) {
+        case ArrayKind::INT32: a.i32.pop_back(); break;
+        case ArrayKind::FLOAT64: a.f64.pop_back(); break;
+        case ArrayKind::UINT8: a.u8.pop_back(); break;
+        default: a.items.pop_back(); break;
+    }
     return v;
 }
 
@@ -312,41 +383,51 @@ static inline bool normalize_index(ssize_t& idx, size_t size) {
 
 Value ArrayTable::get(uint32_t id, ssize_t index) const {
     if (id >= arrays_.size()) return Value::nil();
-    const auto &vec = arrays_[id].items;
-    if (!normalize_index(index, vec.size())) return Value::nil();
-    return vec[static_cast<size_t>(index)];
+    const ArrayEntry& a = arrays_[id];
+    if (!normalize_index(index, length_of(a))) return Value::nil();
+    return load(a, static_cast<size_t>(index));
 }
 
 void ArrayTable::set(uint32_t id, ssize_t index, const Value& v) {
     if (id >= arrays_.size()) return;
-    auto &vec = arrays_[id].items;
+    ArrayEntry& a = arrays_[id];
+    size_t n = length_of(a);
     ssize_t idx = index;
     if (idx < 0) {
-        if (!normalize_index(idx, vec.size())) return;
+        if (!normalize_index(idx, n)) return;
     }
     size_t uidx = static_cast<size_t>(idx);
-    if (uidx == vec.size()) {
-        vec.push_back(v);
+    if (uidx == n) {
+        push_back(id, v);
         return;
     }
-    if (uidx < vec.size()) {
-        vec[uidx] = v;
+    if (uidx < n) {
+        store(a, uidx, v);
     }
 }
 
 Value ArrayTable::remove_at(uint32_t id, ssize_t index) {
     if (id >= arrays_.size()) return Value::nil();
-    auto &vec = arrays_[id].items;
-    if (!normalize_index(index, vec.size())) return Value::nil();
+    ArrayEntry& a = arrays_[id];
+    if (!normalize_index(index, length_of(a))) return Value::nil();
     size_t uidx = static_cast<size_t>(index);
-    Value v = vec[uidx];
-    vec.erase(vec.begin() + static_cast<ssize_t>(uidx));
+    Value v = load(a, uidx);
+    switch (a.kind) {
+        case ArrayKind::INT32: a.i32.erase(a.i32.begin() + static_cast<ssize_t>(uidx)); break;
+        case ArrayKind::FLOAT64: a.f64.erase(a.f64.begin() + static_cast<ssize_t>(uidx)); break;
+        case ArrayKind::UINT8: a.u8.erase(a.u8.begin() + static_cast<ssize_t>(uidx)); break;
+        default: a.items.erase(a.items.begin() + static_cast<ssize_t>(uidx)); break;
+    }
     return v;
 }
 
 void ArrayTable::clear(uint32_t id) {
     if (id >= arrays_.size()) return;
-    arrays_[id].items.clear();
+    ArrayEntry& a = arrays_[id];
+    a.items.clear();
+    a.i32.clear();
+    a.f64.clear();
+    a.u8.clear();
 }
 
 void ArrayTable::mark_array_reachable(uint32_t id) {
@@ -359,8 +440,29 @@ void ArrayTable::clear_gc_marks() {
 
 void ArrayTable::for_each(uint32_t id, const std::function<void(const Value&)>& fn) const {
     if (id >= arrays_.size()) return;
-    const auto &vec = arrays_[id].items;
-    for (const auto &val : vec) fn(val);
+    const ArrayEntry& a = arrays_[id];
+    if (a.kind != ArrayKind::VALUE) return; // typed arrays hold no references
+    for (const auto &val : a.items) fn(val);
+}
+
+std::vector<Value>* ArrayTable::values(uint32_t id) {
+    if (id >= arrays_.size() || arrays_[id].kind != ArrayKind::VALUE) return nullptr;
+    return &arrays_[id].items;
+}
+
+std::vector<int32_t>* ArrayTable::int32_data(uint32_t id) {
+    if (id >= arrays_.size() || arrays_[id].kind != ArrayKind::INT32) return nullptr;
+    return &arrays_[id].i32;
+}
+
+std::vector<double>* ArrayTable::float64_data(uint32_t id) {
+    if (id >= arrays_.size() || arrays_[id].kind != ArrayKind::FLOAT64) return nullptr;
+    return &arrays_[id].f64;
+}
+
+std::vector<uint8_t>* ArrayTable::uint8_data(uint32_t id) {
+    if (id >= arrays_.size() || arrays_[id].kind != ArrayKind::UINT8) return nullptr;
+    return &arrays_[id].u8;
 }
 
 uint32_t TableTable::create() {
@@ -5,6 +5,7 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <memory>
 
 #ifdef _WIN32
     #include <BaseTsd.h>
@@ -105,8 +106,42 @@ enum class OpCode : uint8_t {
     // Generic indexing
     OP_INDEX_GET,
     OP_INDEX_SET,
+
+    // Typed array indexing (falls back to OP_INDEX_* for anything else)
+    OP_TYPED_GET,
+    OP_TYPED_SET,
 };
 
+// Number of operand bytes that follow an opcode in the instruction stream
+inline int opcode_operand_bytes(OpCode op) {
+    switch (op) {
+        case OpCode::OP_CONSTANT:
+        case OpCode::OP_GET_GLOBAL:
+        case OpCode::OP_SET_GLOBAL:
+        case OpCode::OP_GET_LOCAL:
+        case OpCode::OP_SET_LOCAL:
+        case OpCode::OP_JUMP:
+        case OpCode::OP_JUMP_IF_FALSE:
+        case OpCode::OP_JUMP_BACK:
+        case OpCode::OP_ARRAY_CREATE:
+            return 1;
+        case OpCode::OP_CONSTANT_LONG:
+        case OpCode::OP_CALL_HOST:
+        case OpCode::OP_TAIL_CALL:
+        case OpCode::OP_ADD_LOCAL:
+        case OpCode::OP_ADD_FLOAT_LOCAL:
+        case OpCode::OP_ADD_STRING_LOCAL:
+        case OpCode::OP_CONSTANT_LOCAL:
+        case OpCode::OP_ADD_LOCAL_CONST:
+        case OpCode::OP_ADD_CONST_LOCAL:
+        case OpCode::OP_ADD_LOCAL_CONST_FLOAT:
+        case OpCode::OP_ADD_CONST_LOCAL_FLOAT:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
 // Value types (classification)
 enum class ValueType : uint8_t {
     NIL,
@@ -129,6 +164,7 @@ enum class ValueType : uint8_t {
 //     - TRUE  = QNAN | 0x3
 //    Tagged payloads (48-bit payload in low bits):
 //     - INT       = QNAN | (TAG_INT    << 48) | sign-extended 48-bit integer
+//                   (arithmetic that leaves this range promotes to FLOAT)
 //     - STRING_ID = QNAN | (TAG_STRING << 48) | uint32 payload (id)
 //     - TABLE_ID  = QNAN | (TAG_TABLE  << 48) | uint32 payload (id)
 struct Value {
@@ -190,6 +226,54 @@ public:
         Value v; v.bits_ = MAKE_FAMILY(TAG_FAMILY_ARRAY) | static_cast<uint64_t>(id); return v;
     }
 
+    // Integer range that fits the 48-bit payload
+    static constexpr int64_t INT48_MIN = -(1LL << 47);
+    static constexpr int64_t INT48_MAX = (1LL << 47) - 1;
+    static bool fits_int48(int64_t i) {
+        return static_cast<uint64_t>(i) + (1ULL << 47) < (1ULL << 48); // one add + compare
+    }
+
+    // Integer arithmetic results: stay INT when they fit, otherwise promote
+    // to a float (exact up to 2^53) instead of silently wrapping
+    static Value from_int64(int64_t i) {
+        if (fits_int48(i)) return integer(i);
+        return floating(static_cast<double>(i));
+    }
+    // add/sub of two 48-bit ints can't overflow int64, multiply can
+    static Value multiply_ints(int64_t a, int64_t b) {
+        int64_t r;
+        if (mul_overflows(a, b, r)) return floating(static_cast<double>(a) * static_cast<double>(b));
+        return from_int64(r);
+    }
+
+    // Full int64 add/multiply for running sums, true (out untouched) when the
+    // result doesn't fit
+    static bool add_overflows(int64_t a, int64_t b, int64_t& out) {
+#if defined(__GNUC__) || defined(__clang__)
+        int64_t r;
+        if (__builtin_add_overflow(a, b, &r)) return true;
+        out = r;
+        return false;
+#else
+        if (b > 0 ? a > INT64_MAX - b : a < INT64_MIN - b) return true;
+        out = a + b;
+        return false;
+#endif
+    }
+    static bool mul_overflows(int64_t a, int64_t b, int64_t& out) {
+#if defined(__GNUC__) || defined(__clang__)
+        int64_t r;
+        if (__builtin_mul_overflow(a, b, &r)) return true;
+        out = r;
+        return false;
+#else
+        double p = static_cast<double>(a) * static_cast<double>(b);
+        if (!(p > -9.0e18 && p < 9.0e18)) return true;
+        out = a * b;
+        return false;
+#endif
+    }
+
     // Classification
     ValueType type() const {
         if (!is_qnan(bits_)) return ValueType::FLOAT; // normal numbers, +/-inf, sNaN treated as float
@@ -234,8 +318,13 @@ public:
     uint32_t as_buffer_id() const { return static_cast<uint32_t>(bits_ & 0xFFFFFFFFULL); }
     uint32_t as_table_id() const { return static_cast<uint32_t>(bits_ & 0xFFFFFFFFULL); }
     uint32_t as_array_id() const { return static_cast<uint32_t>(bits_ & 0xFFFFFFFFULL); }
+
+    // Raw NaN-box bits (used by the JIT to embed constants and type tests)
+    uint64_t raw_bits() const { return bits_; }
 };
 
+struct JitFunction; // native code for a function body (jit.h)
+
 // Bytecode chunk (contains instructions + constants)
 class Chunk {
 public:
@@ -261,6 +350,15 @@ public:
     void add_function_name_to_child(size_t child_index, const std::string& name);
     size_t code_size() const { return code_.size(); }
     void patch_byte(size_t index, uint8_t byte);
+
+    // Per-function call counter and compiled code, owned by the chunk so the
+    // native code never outlives the bytecode it was translated from
+    struct JitState {
+        uint32_t call_count = 0;
+        bool rejected = false;
+        std::shared_ptr<JitFunction> code;
+    };
+    JitState& jit_state() const { return jit_state_; }
     
 private:
     std::vector<uint8_t> code_;      // bytecode instructions
@@ -271,6 +369,7 @@ private:
     std::vector<std::vector<std::string>> function_params_; // changed to vector of vectors
     std::vector<std::vector<std::string>> function_locals_; // local variable names per function
     std::vector<std::string> function_names_;
+    mutable JitState jit_state_;
 };
 
 // String intern table (for performance + GC)
@@ -339,9 +438,20 @@ private:
     std::vector<uint32_t> free_slots_;
 };
 
+// Element storage of an array. VALUE arrays hold any Value, typed arrays keep
+// raw numbers packed (no tags, no references for the GC to chase)
+enum class ArrayKind : uint8_t {
+    VALUE,
+    INT32,
+    FLOAT64,
+    UINT8,
+};
+
 class ArrayTable {
 public:
     uint32_t create(size_t reserve = 0);
+    uint32_t create_typed(ArrayKind kind, size_t length); // zero-filled
+    ArrayKind kind(uint32_t id) const;
     size_t length(uint32_t id) const;
     void push_back(uint32_t id, const Value& v);
     Value pop_back(uint32_t id);
@@ -356,12 +466,61 @@ public:
     // Traverse to mark contained references (strings/buffers/arrays)
     void for_each(uint32_t id, const std::function<void(const Value&)>& fn) const;
 
+    // Raw storage for bulk host operations, nullptr if the array is another kind
+    std::vector<Value>* values(uint32_t id);
+    std::vector<int32_t>* int32_data(uint32_t id);
+    std::vector<double>* float64_data(uint32_t id);
+    std::vector<uint8_t>* uint8_data(uint32_t id);
+
+    // Typed element access for OP_TYPED_GET/SET. Returns false when the array
+    // isn't typed, the index is out of range or the value isn't a number, so
+    // the caller can fall back
+    bool typed_get(uint32_t id, int64_t index, Value& out) const {
+        if (id >= arrays_.size()) return false;
+        const ArrayEntry& a = arrays_[id];
+        if (index < 0) return false;
+        size_t i = static_cast<size_t>(index);
+        switch (a.kind) {
+            case ArrayKind::INT32:
+                if (i >= a.i32.size()) return false;
+                out = Value::integer(a.i32[i]);
+                return true;
+            case ArrayKind::FLOAT64:
+                if (i >= a.f64.size()) return false;
+                out = Value::floating(a.f64[i]);
+                return true;
+            case ArrayKind::UINT8:
+                if (i >= a.u8.size()) return false;
+                out = Value::integer(a.u8[i]);
+                return true;
+            default:
+                return false;
+        }
+    }
+    bool typed_set(uint32_t id, int64_t index, const Value& v) {
+        if (id >= arrays_.size()) return false;
+        ArrayEntry& a = arrays_[id];
+        if (index < 0 || a.kind == ArrayKind::VALUE || (!v.is_int() && !v.is_float())) return false;
+        size_t i = static_cast<size_t>(index);
+        if (i >= length_of(a)) return false;
+        store(a, i, v);
+        return true;
+    }
+
 private:
     struct ArrayEntry {
-        std::vector<Value> items;
+        ArrayKind kind = ArrayKind::VALUE;
+        std::vector<Value> items;     // VALUE
+        std::vector<int32_t> i32;     // INT32
+        std::vector<double> f64;      // FLOAT64
+        std::vector<uint8_t> u8;      // UINT8
         bool gc_marked = false;
     };
 
+    static size_t length_of(const ArrayEntry& a);
+    static Value load(const ArrayEntry& a, size_t i);
+    static void store(ArrayEntry& a, size_t i, const Value& v); // numbers are converted, others ignored
+
     std::vector<ArrayEntry> arrays_;
     std::vector<uint32_t> free_slots_;
 };
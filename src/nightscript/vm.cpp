@@ -1,12 +1,16 @@
 #include "vm.h"
 #include "host_api.h"
+#include "jit.h"
 #include <iostream>
 #include <cstdarg>
+#include <cstdlib>
+#include <new>
 #include <cstring>
 #include <algorithm>
 #include <cctype>
 #include <charconv>
 #include <chrono>
+#include <cmath>
 
 // the evil class of unredability
 
@@ -17,7 +21,16 @@
 namespace nightforge {
 namespace nightscript {
 
-VM::VM(HostEnvironment* host_env) {
+// Mixed int/float comparisons (ints promoted past 48 bits become floats)
+static inline bool is_number(const Value& v) { return v.is_int() || v.is_float(); }
+static inline double number_of(const Value& v) { return v.is_float() ? v.as_floating() : static_cast<double>(v.as_integer()); }
+
+VM::VM(HostEnvironment* host_env, size_t stack_slots) {
+    // malloc instead of new[]: Value() writes nil, which would commit every page
+    if (stack_slots == 0) stack_slots = 1;
+    stack_ = static_cast<Value*>(std::malloc(stack_slots * sizeof(Value)));
+    if (!stack_) throw std::bad_alloc();
+    stack_limit_ = stack_ + stack_slots;
     host_env_ = host_env;
     current_frame_ = nullptr;
     reset_stack();
@@ -25,7 +38,61 @@ VM::VM(HostEnvironment* host_env) {
 }
 
 VM::~VM() {
-    // cleanup if needed
+    std::free(stack_);
+}
+
+bool VM::resolve_function(const std::string& name, ScriptFunction& out) const {
+    std::string lc = name;
+    std::transform(lc.begin(), lc.end(), lc.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    // Same search order as OP_CALL_HOST: calling chunk, then its parent
+    for (const Chunk* c : {host_chunk_, host_parent_}) {
+        if (!c) continue;
+        ssize_t index = c->get_function_index(lc);
+        if (index < 0) continue;
+        size_t i = static_cast<size_t>(index);
+        out.chunk = &c->get_function(i);
+        out.parent = c;
+        out.param_count = c->get_function_param_names(i).size();
+        out.slot_count = c->get_function_local_names(i).size();
+        return true;
+    }
+    return false;
+}
+
+VMResult VM::call_function(const ScriptFunction& fn, const Value* args, size_t arg_count, Value& result) {
+    result = Value::nil();
+    if (!fn.valid() || arg_count > 255) {
+        runtime_error("Invalid callback");
+        return VMResult::RUNTIME_ERROR;
+    }
+    if (stack_top_ + arg_count + fn.slot_count >= stack_limit_) {
+        runtime_error("Stack overflow");
+        return VMResult::RUNTIME_ERROR;
+    }
+    
+    // The host function that called us is still holding tmp_args_ by reference
+    std::vector<Value> saved_args;
+    saved_args.swap(tmp_args_);
+    const Chunk* saved_chunk = host_chunk_;
+    const Chunk* saved_parent = host_parent_;
+    
+    Value* base = stack_top_;
+    for (size_t i = 0; i < arg_count; ++i) push(args[i]);
+    VMResult r = VMResult::RUNTIME_ERROR;
+    if (push_call_frame(fn.chunk, static_cast<uint8_t>(arg_count), fn.slot_count)) {
+        r = execute(*fn.chunk, fn.parent);
+        pop_call_frame();
+    }
+    
+    // Return value convention matches OP_CALL_HOST
+    if (r == VMResult::OK && stack_top_ > base) result = stack_top_[-1];
+    stack_top_ = base;
+    
+    tmp_args_.swap(saved_args);
+    host_chunk_ = saved_chunk;
+    host_parent_ = saved_parent;
+    return r;
 }
 
 VMResult VM::execute(const Chunk& chunk) {
@@ -73,7 +140,7 @@ void VM::print_stack() {
 }
 
 void VM::push(const Value& value) {
-    if (stack_top_ >= stack_ + STACK_MAX) {
+    if (stack_top_ >= stack_limit_) {
         runtime_error("Stack overflow");
         has_runtime_error_ = true;
         return;
@@ -109,11 +176,21 @@ void VM::reset_stack() {
 VMResult VM::run(const Chunk& chunk, const Chunk* parent_chunk) {
     if (parent_chunk == nullptr) {
         reset_stack();
+        steps_left_ = step_budget_ ? step_budget_ : UINT64_MAX;
     }
 
     const uint8_t* ip = chunk.code().data();
     const uint8_t* end = ip + chunk.code().size();
     
+#if NIGHTSCRIPT_JIT_AVAILABLE
+    // Hot function bodies run natively; on a bailout we pick up where it left off
+    if (jit_enabled_ && parent_chunk != nullptr && current_frame_ && current_frame_->chunk == &chunk) {
+        int64_t resume = run_jit(chunk);
+        if (resume == JIT_DONE) return VMResult::OK;
+        ip += resume;
+    }
+#endif
+    
     // Pre-declare variables that are used in computed goto blocks to avoid scope issues
     std::string func_name_lc;
     std::string func_name_lc2; // For tail call
@@ -212,9 +289,12 @@ VMResult VM::run(const Chunk& chunk, const Chunk* parent_chunk) {
         // Generic indexing
         &&op_INDEX_GET,       // OP_INDEX_GET
         &&op_INDEX_SET,       // OP_INDEX_SET
+        // Typed arrays
+        &&op_TYPED_GET,       // OP_TYPED_GET
+        &&op_TYPED_SET,       // OP_TYPED_SET
     };
 
-    constexpr size_t OPCODE_COUNT = static_cast<size_t>(OpCode::OP_INDEX_SET) + 1;
+    constexpr size_t OPCODE_COUNT = static_cast<size_t>(OpCode::OP_TYPED_SET) + 1;
     static_assert(sizeof(dispatch_table) / sizeof(void*) == OPCODE_COUNT, "dispatch_table size must match OpCode count");
 
     if (ip >= end) return VMResult::OK;
@@ -346,10 +426,15 @@ op_MODULO: {
 op_ADD_INT: {
     COUNT_OPCODE(OP_ADD_INT);
     // Direct shot access (stack ahtually!! 🤓)
+    // Operands can be floats once a value has overflowed, generic path handles those
+    if (!stack_top_[-2].is_int() || !stack_top_[-1].is_int()) {
+        if (!binary_op(OpCode::OP_ADD)) return VMResult::RUNTIME_ERROR;
+        SAFE_DISPATCH();
+    }
     int64_t a_val = stack_top_[-2].as_integer();
     int64_t b_val = stack_top_[-1].as_integer();
     stack_top_ -= 2;
-    push(Value::integer(a_val + b_val));
+    push(Value::from_int64(a_val + b_val));
     SAFE_DISPATCH();
 }
 
@@ -398,10 +483,14 @@ op_ADD_STRING: {
 
 op_SUB_INT: {
     COUNT_OPCODE(OP_SUB_INT);
+    if (!stack_top_[-2].is_int() || !stack_top_[-1].is_int()) {
+        if (!binary_op(OpCode::OP_SUBTRACT)) return VMResult::RUNTIME_ERROR;
+        SAFE_DISPATCH();
+    }
     int64_t a_val = stack_top_[-2].as_integer();
     int64_t b_val = stack_top_[-1].as_integer();
     stack_top_ -= 2;
-    push(Value::integer(a_val - b_val));
+    push(Value::from_int64(a_val - b_val));
     SAFE_DISPATCH();
 }
 
@@ -420,10 +509,14 @@ op_SUB_FLOAT: {
 
 op_MUL_INT: {
     COUNT_OPCODE(OP_MUL_INT);
+    if (!stack_top_[-2].is_int() || !stack_top_[-1].is_int()) {
+        if (!binary_op(OpCode::OP_MULTIPLY)) return VMResult::RUNTIME_ERROR;
+        SAFE_DISPATCH();
+    }
     int64_t a_val = stack_top_[-2].as_integer();
     int64_t b_val = stack_top_[-1].as_integer();
     stack_top_ -= 2;
-    push(Value::integer(a_val * b_val));
+    push(Value::multiply_ints(a_val, b_val));
     SAFE_DISPATCH();
 }
 
@@ -442,11 +535,15 @@ op_MUL_FLOAT: {
 
 op_DIV_INT: {
     COUNT_OPCODE(OP_DIV_INT);
+    if (!stack_top_[-2].is_int() || !stack_top_[-1].is_int()) {
+        if (!binary_op(OpCode::OP_DIVIDE)) return VMResult::RUNTIME_ERROR;
+        SAFE_DISPATCH();
+    }
     int64_t a_val = stack_top_[-2].as_integer();
     int64_t b_val = stack_top_[-1].as_integer();
     stack_top_ -= 2;
     if (b_val == 0) { runtime_error("Division by zero"); return VMResult::RUNTIME_ERROR; }
-    push(Value::integer(a_val / b_val));
+    push(Value::from_int64(a_val / b_val)); // INT48_MIN / -1
     SAFE_DISPATCH();
 }
 
@@ -466,6 +563,10 @@ op_DIV_FLOAT: {
 
 op_MOD_INT: {
     COUNT_OPCODE(OP_MOD_INT);
+    if (!stack_top_[-2].is_int() || !stack_top_[-1].is_int()) {
+        if (!binary_op(OpCode::OP_MODULO)) return VMResult::RUNTIME_ERROR;
+        SAFE_DISPATCH();
+    }
     int64_t a_val = stack_top_[-2].as_integer();
     int64_t b_val = stack_top_[-1].as_integer();
     stack_top_ -= 2;
@@ -481,22 +582,22 @@ op_EQUAL: {
 
 op_GREATER: {
     COUNT_OPCODE(OP_GREATER);
-    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() > b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() > b.as_floating(); break; default: result = false; break; } } push(Value::boolean(result)); SAFE_DISPATCH();
+    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() > b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() > b.as_floating(); break; default: result = false; break; } } else if (is_number(a) && is_number(b)) { result = number_of(a) > number_of(b); } push(Value::boolean(result)); SAFE_DISPATCH();
 }
 
 op_GREATER_EQUAL: {
     COUNT_OPCODE(OP_GREATER_EQUAL);
-    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() >= b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() >= b.as_floating(); break; default: result = false; break; } } push(Value::boolean(result)); SAFE_DISPATCH();
+    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() >= b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() >= b.as_floating(); break; default: result = false; break; } } else if (is_number(a) && is_number(b)) { result = number_of(a) >= number_of(b); } push(Value::boolean(result)); SAFE_DISPATCH();
 }
 
 op_LESS_EQUAL: {
     COUNT_OPCODE(OP_LESS_EQUAL);
-    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() <= b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() <= b.as_floating(); break; default: result = false; break; } } push(Value::boolean(result)); SAFE_DISPATCH();
+    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() <= b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() <= b.as_floating(); break; default: result = false; break; } } else if (is_number(a) && is_number(b)) { result = number_of(a) <= number_of(b); } push(Value::boolean(result)); SAFE_DISPATCH();
 }
 
 op_LESS: {
     COUNT_OPCODE(OP_LESS);
-    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() < b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() < b.as_floating(); break; default: result = false; break; } } push(Value::boolean(result)); SAFE_DISPATCH();
+    Value b = pop(); Value a = pop(); bool result = false; if (a.type() == b.type()) { switch (a.type()) { case ValueType::INT: result = a.as_integer() < b.as_integer(); break; case ValueType::FLOAT: result = a.as_floating() < b.as_floating(); break; default: result = false; break; } } else if (is_number(a) && is_number(b)) { result = number_of(a) < number_of(b); } push(Value::boolean(result)); SAFE_DISPATCH();
 }
 
 op_NOT: {
@@ -534,7 +635,9 @@ op_JUMP_IF_FALSE: {
 
 op_JUMP_BACK: {
     COUNT_OPCODE(OP_JUMP_BACK);
-    uint8_t offset = read_byte(ip); ip -= offset; SAFE_DISPATCH();
+    uint8_t offset = read_byte(ip); ip -= offset;
+    if (!spend_step()) return VMResult::RUNTIME_ERROR;
+    SAFE_DISPATCH();
 }
 
 op_CALL_HOST: {
@@ -568,6 +671,8 @@ op_CALL_HOST: {
     
     // Try host function first (most common case for engine calls)
     if (host_env_) {
+        host_chunk_ = &chunk;
+        host_parent_ = parent_chunk;
         std::optional<Value> host_result = host_env_->call_host(func_name_lc, tmp_args_);
         if (host_result.has_value()) {
             push(*host_result);
@@ -587,7 +692,7 @@ op_CALL_HOST: {
         
         Value* stack_before_call = stack_top_ - arg_count;
         
-        push_call_frame(&fchunk, arg_count);
+        if (!push_call_frame(&fchunk, arg_count, chunk.get_function_local_names(static_cast<size_t>(func_index)).size())) return VMResult::RUNTIME_ERROR;
         VMResult r = execute(fchunk, &chunk);
         pop_call_frame();
         
@@ -621,7 +726,7 @@ op_CALL_HOST: {
             Value* stack_before_call = stack_top_ - arg_count;
             size_t initial_call_frames = call_frames_.size();
             
-            push_call_frame(&fchunk, arg_count);
+            if (!push_call_frame(&fchunk, arg_count, parent_chunk->get_function_local_names(static_cast<size_t>(parent_func_index)).size())) return VMResult::RUNTIME_ERROR;
             VMResult r = execute(fchunk, parent_chunk);
             pop_call_frame();
             
@@ -707,7 +812,7 @@ op_TAIL_CALL: {
         // Store stack state before call for proper cleanup
         Value* stack_before_call = stack_top_ - arg_count;
         
-        push_call_frame(&fchunk, arg_count);
+        if (!push_call_frame(&fchunk, arg_count, chunk.get_function_local_names(static_cast<size_t>(func_index)).size())) return VMResult::RUNTIME_ERROR;
         VMResult r = execute(fchunk, &chunk);
         pop_call_frame();
         
@@ -728,6 +833,8 @@ op_TAIL_CALL: {
 
     std::optional<Value> host_result;
     if (host_env_) {
+        host_chunk_ = &chunk;
+        host_parent_ = parent_chunk;
         host_result = host_env_->call_host(func_name_lc2, tmp_args_);
     }
     if (host_result.has_value()) {
@@ -832,7 +939,7 @@ op_ADD_LOCAL: {
     const Value& a = *local_a;
     const Value& b = *local_b;
     if (a.type() == ValueType::INT && b.type() == ValueType::INT) {
-        push(Value::integer(a.as_integer() + b.as_integer()));
+        push(Value::from_int64(a.as_integer() + b.as_integer()));
     } else {
         double da = (a.type() == ValueType::FLOAT) ? a.as_floating() : static_cast<double>(a.as_integer());
         double db = (b.type() == ValueType::FLOAT) ? b.as_floating() : static_cast<double>(b.as_integer());
@@ -903,7 +1010,7 @@ op_ADD_LOCAL_CONST: {
     }
     Value va = *local_ptr;
     if (va.type() == ValueType::INT && vc.type() == ValueType::INT) {
-        push(Value::integer(va.as_integer() + vc.as_integer()));
+        push(Value::from_int64(va.as_integer() + vc.as_integer()));
     } else if (va.type() == ValueType::FLOAT || vc.type() == ValueType::FLOAT) {
         double da = (va.type() == ValueType::FLOAT) ? va.as_floating() : static_cast<double>(va.as_integer());
         double dc = (vc.type() == ValueType::FLOAT) ? vc.as_floating() : static_cast<double>(vc.as_integer());
@@ -934,7 +1041,7 @@ op_ADD_CONST_LOCAL: {
     }
     Value va = *local_ptr;
     if (va.type() == ValueType::INT && vc.type() == ValueType::INT) {
-        push(Value::integer(vc.as_integer() + va.as_integer()));
+        push(Value::from_int64(vc.as_integer() + va.as_integer()));
     } else if (va.type() == ValueType::FLOAT || vc.type() == ValueType::FLOAT) {
         double da = (va.type() == ValueType::FLOAT) ? va.as_floating() : static_cast<double>(va.as_integer());
         double dc = (vc.type() == ValueType::FLOAT) ? vc.as_floating() : static_cast<double>(vc.as_integer());
@@ -1161,6 +1268,7 @@ op_TABLE_REMOVE: {
 
 op_INDEX_GET: {
     COUNT_OPCODE(OP_INDEX_GET);
+index_get_uncounted: // typed fallback lands here, already counted
     Value keyv = pop();
     Value objv = pop();
     
@@ -1186,6 +1294,7 @@ op_INDEX_GET: {
 
 op_INDEX_SET: {
     COUNT_OPCODE(OP_INDEX_SET);
+index_set_uncounted: // typed fallback lands here, already counted
     Value value = pop();
     Value keyv = pop();
     Value objv = pop();
@@ -1196,6 +1305,10 @@ op_INDEX_SET: {
         if (keyv.type() == ValueType::INT) index = static_cast<ssize_t>(keyv.as_integer());
         else if (keyv.type() == ValueType::FLOAT) index = static_cast<ssize_t>(keyv.as_floating());
         else { runtime_error("INDEX_SET: array index must be number"); return VMResult::RUNTIME_ERROR; }
+        if (!value.is_int() && !value.is_float() && arrays_.kind(objv.as_array_id()) != ArrayKind::VALUE) {
+            runtime_error("INDEX_SET: typed arrays only hold numbers");
+            return VMResult::RUNTIME_ERROR;
+        }
         arrays_.set(objv.as_array_id(), index, value);
         push(value); // leave value on stack
     } else if (objv.type() == ValueType::TABLE_ID) {
@@ -1209,6 +1322,35 @@ op_INDEX_SET: {
     }
     SAFE_DISPATCH();
 }
+
+op_TYPED_GET: {
+    COUNT_OPCODE(OP_TYPED_GET);
+    // Compiler emits this when the target is known to come from a typed array
+    // constructor; anything unexpected takes the generic path
+    const Value& arrv = stack_top_[-2];
+    const Value& idxv = stack_top_[-1];
+    Value out;
+    if (arrv.type() == ValueType::ARRAY && idxv.is_int() &&
+        arrays_.typed_get(arrv.as_array_id(), idxv.as_integer(), out)) {
+        stack_top_ -= 2;
+        push(out);
+        SAFE_DISPATCH();
+    }
+    goto index_get_uncounted;
+}
+
+op_TYPED_SET: {
+    COUNT_OPCODE(OP_TYPED_SET);
+    const Value& arrv = stack_top_[-3];
+    const Value& idxv = stack_top_[-2];
+    if (arrv.type() == ValueType::ARRAY && idxv.is_int() &&
+        arrays_.typed_set(arrv.as_array_id(), idxv.as_integer(), stack_top_[-1])) {
+        stack_top_[-3] = stack_top_[-1]; // leave value on stack
+        stack_top_ -= 2;
+        SAFE_DISPATCH();
+    }
+    goto index_set_uncounted;
+}
     return VMResult::OK;
 }
 
@@ -1228,17 +1370,55 @@ Value VM::read_constant_long(const Chunk& chunk, const uint8_t*& ip) {
     return chunk.get_constant(index);
 }
 
-void VM::push_call_frame(const Chunk* chunk, uint8_t arg_count) {
+int64_t VM::run_jit(const Chunk& chunk) {
+    Chunk::JitState& js = chunk.jit_state();
+    if (!js.code) {
+        if (js.rejected || ++js.call_count < jit_threshold_) return 0;
+        js.code = jit_compile(chunk);
+        if (!js.code) {
+            js.rejected = true;
+            return 0;
+        }
+        stats.jit_compiled++;
+    }
+    
+    JitFrame frame{current_frame_->base, stack_top_, stack_limit_};
+    stats.jit_entries++;
+    int64_t status = js.code->entry(&frame);
+    stack_top_ = frame.top;
+    if (status != JIT_DONE) stats.jit_bailouts++;
+    return status;
+}
+
+bool VM::out_of_steps() {
+    runtime_error("Script stopped: ran past its step budget");
+    return false;
+}
+
+bool VM::push_call_frame(const Chunk* chunk, uint8_t arg_count, size_t slot_count) {
     CallFrame frame;
     frame.base = stack_top_ - arg_count;
+    if (has_runtime_error_) return false; // a push already overflowed and reset the stack under us
+    if (call_frames_.size() >= MAX_CALL_DEPTH || slot_count > static_cast<size_t>(stack_limit_ - frame.base)) {
+        runtime_error("Stack overflow");
+        has_runtime_error_ = true;
+        return false;
+    }
+    if (!spend_step()) return false;
+    
+    // Reserve nil slots for declared locals so temporaries don't land on them
+    if (stack_top_ < frame.base + slot_count) {
+        Value* end = frame.base + slot_count;
+        std::fill_n(stack_top_, end - stack_top_, Value::nil());
+        stack_top_ = end;
+    }
     frame.top = stack_top_;
     frame.return_ip = nullptr;
     frame.chunk = chunk;
     
     call_frames_.push_back(frame);
     current_frame_ = &call_frames_.back();
-    
-    // Reserve space for local variables (parameters become locals 0, 1, 2, ...)
+    return true;
 }
 
 void VM::pop_call_frame() {
@@ -1256,7 +1436,7 @@ Value* VM::get_local(uint8_t slot) {
     if (!current_frame_) return nullptr;
     Value* local_ptr = current_frame_->base + slot;
     
-    if (local_ptr < stack_ || local_ptr >= stack_ + STACK_MAX) {
+    if (local_ptr < stack_ || local_ptr >= stack_limit_) {
         return nullptr;  // Out of VM stack bounds
     }
     return local_ptr;
@@ -1328,7 +1508,7 @@ bool VM::binary_op(OpCode op) {
         switch (op) {
             case OpCode::OP_ADD: result = a.as_integer() + b.as_integer(); break;
             case OpCode::OP_SUBTRACT: result = a.as_integer() - b.as_integer(); break;
-            case OpCode::OP_MULTIPLY: result = a.as_integer() * b.as_integer(); break;
+            case OpCode::OP_MULTIPLY: push(Value::multiply_ints(a.as_integer(), b.as_integer())); return true;
             case OpCode::OP_DIVIDE: 
                 if (b.as_integer() == 0) {
                     runtime_error("Don't divide by zero.");
@@ -1347,7 +1527,7 @@ bool VM::binary_op(OpCode op) {
                 runtime_error("Unknown binary operator");
                 return false;
         }
-        push(Value::integer(result));
+        push(Value::from_int64(result));
         return true;
     }
     
@@ -1367,6 +1547,14 @@ bool VM::binary_op(OpCode op) {
                 }
                 result = da / db; 
                 break;
+            case OpCode::OP_MODULO:
+                // ints promoted past 48 bits land here
+                if (db == 0.0) {
+                    runtime_error("Don't modulo by zero.");
+                    return false;
+                }
+                result = std::fmod(da, db);
+                break;
             default:
                 runtime_error("Unknown binary operator");
                 return false;
@@ -1458,6 +1646,22 @@ void VM::mark_reachable_strings(const Chunk* active_chunk) {
         }
     }
 
+    // Values host functions are holding on to across callbacks
+    for (const Value& v : host_roots_) {
+        if (v.type() == ValueType::STRING_ID) {
+            strings_.mark_string_reachable(v.as_string_id());
+        } else if (v.type() == ValueType::STRING_BUFFER) {
+            buffers_.mark_buffer_reachable(v.as_buffer_id());
+        } else if (v.type() == ValueType::ARRAY) {
+            arrays_.mark_array_reachable(v.as_array_id());
+            arrays_.for_each(v.as_array_id(), [this](const Value& e){
+                if (e.type() == ValueType::STRING_ID) strings_.mark_string_reachable(e.as_string_id());
+                else if (e.type() == ValueType::STRING_BUFFER) buffers_.mark_buffer_reachable(e.as_buffer_id());
+                else if (e.type() == ValueType::ARRAY) arrays_.mark_array_reachable(e.as_array_id());
+            });
+        }
+    }
+
     // Also mark any strings stored in the active chunk's constants (function names, string literals)
     if (active_chunk) {
         for (const auto& constant : active_chunk->constants()) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "value.h"
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <unordered_map>
@@ -35,10 +36,27 @@ struct CallFrame {
     const Chunk* chunk;
 };
 
+// A script function resolved once by host code, so callbacks (sort comparators,
+// map/filter functions) don't go through the by-name OP_CALL_HOST lookup per call
+struct ScriptFunction {
+    const Chunk* chunk = nullptr;   // function body
+    const Chunk* parent = nullptr;  // chunk it was declared in
+    size_t param_count = 0;
+    size_t slot_count = 0;          // params + declared locals
+    bool valid() const { return chunk != nullptr; }
+};
+
 class VM {
 public:
-    VM(HostEnvironment* host_env = nullptr);
+    static constexpr size_t STACK_MAX = 262144; // default slot count, enough for deep recursion
+    static constexpr size_t MAX_CALL_DEPTH = 4096; // every script call also recurses in C++ (~0.5KB a level)
+    
+    // The stack is heap allocated and pages are only touched as it grows, so
+    // VMs that never recurse deeply (one per server session) stay small
+    VM(HostEnvironment* host_env = nullptr, size_t stack_slots = STACK_MAX);
     ~VM();
+    VM(const VM&) = delete;
+    VM& operator=(const VM&) = delete;
     
     // Execute bytecode chunk
     VMResult execute(const Chunk& chunk);
@@ -47,6 +65,25 @@ public:
     // Assign a host environment
     void set_host_environment(HostEnvironment* env) { host_env_ = env; }
     
+    // Baseline JIT for hot functions (no-op on platforms without one)
+    void set_jit_enabled(bool enabled) { jit_enabled_ = enabled; }
+    void set_jit_threshold(uint32_t calls) { jit_threshold_ = calls; }
+    
+    // Loop iterations plus calls one top-level execute may take before the
+    // script is stopped with a runtime error, 0 = no limit. JIT-compiled loops
+    // don't count, so leave the JIT off where this matters
+    void set_step_budget(uint64_t steps) { step_budget_ = steps; }
+    
+    // Host -> script callbacks. Only valid while a host function is running:
+    // names resolve against the chunk that made the host call, like OP_CALL_HOST.
+    // call_function is reentrant and leaves the caller's args vector intact
+    bool resolve_function(const std::string& name, ScriptFunction& out) const;
+    VMResult call_function(const ScriptFunction& fn, const Value* args, size_t arg_count, Value& result);
+    
+    // Values host code holds across callbacks (a GC may run inside them)
+    void push_root(const Value& v) { host_roots_.push_back(v); }
+    void pop_roots(size_t count) { host_roots_.resize(host_roots_.size() - std::min(count, host_roots_.size())); }
+    
     // String and buffer management
     StringTable& strings() { return strings_; }
     BufferTable& buffers() { return buffers_; }
@@ -75,6 +112,9 @@ public:
         size_t bytes_allocated = 0;
         size_t bytes_freed = 0;
         double total_gc_time = 0.0;
+        size_t jit_compiled = 0;
+        uint64_t jit_entries = 0;
+        uint64_t jit_bailouts = 0;
         std::array<uint64_t, 256> op_counts = {};
     } stats;
     
@@ -90,15 +130,15 @@ private:
     CallFrame* current_frame_;
 
     // Call frame helpers (unified stack)
-    void push_call_frame(const Chunk* chunk, uint8_t arg_count);
+    bool push_call_frame(const Chunk* chunk, uint8_t arg_count, size_t slot_count = 0); // false on stack overflow
     void pop_call_frame();
     Value* get_local(uint8_t slot);  // Direct shot
     
 private:
-    static constexpr size_t STACK_MAX = 262144; // Increased to 256K for deep recursion support
     static constexpr size_t GC_THRESHOLD = 1024 * 1024; // 1MB threshold for GC
     
-    Value stack_[STACK_MAX];
+    Value* stack_;
+    Value* stack_limit_; // one past the last slot
     Value* stack_top_;
     
     std::unordered_map<std::string, Value> globals_;
@@ -117,6 +157,23 @@ private:
     std::vector<Value> tmp_args_;
     HostEnvironment* host_env_ = nullptr;
     
+    // Chunks active at the current host call (for resolve_function)
+    const Chunk* host_chunk_ = nullptr;
+    const Chunk* host_parent_ = nullptr;
+    std::vector<Value> host_roots_;
+    
+    bool jit_enabled_ = false;
+    uint32_t jit_threshold_ = 1000;
+    
+    uint64_t step_budget_ = 0;
+    uint64_t steps_left_ = UINT64_MAX;
+    bool spend_step() {
+        if (steps_left_ == 0) return out_of_steps();
+        --steps_left_;
+        return true;
+    }
+    bool out_of_steps();
+    
     // Stack operations
     void push(const Value& value);
     Value pop();
@@ -128,6 +185,7 @@ private:
     
     // Execution
     VMResult run(const Chunk& chunk, const Chunk* parent_chunk);
+    int64_t run_jit(const Chunk& chunk);
     uint8_t read_byte(const uint8_t*& ip);
     Value read_constant(const Chunk& chunk, const uint8_t*& ip);
     Value read_constant_long(const Chunk& chunk, const uint8_t*& ip);
@@ -0,0 +1,324 @@
+#include "ascii_anim.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+namespace ascii_art {
+
+// Unchanged cells shorter than this between two changed runs are sent again
+// instead of skipped, a cursor move costs more than a few plain characters
+static constexpr int RUN_MERGE_GAP = 6;
+
+static const char NFA_MAGIC[4] = {'N', 'F', 'A', '1'};
+static constexpr uint8_t NFA_COLOR = 1 << 0;
+
+Animation Animation::build(const uint8_t* pixels, int width, int height, int channels,
+                           const std::vector<int>& delays_ms, const Config& config, int threads) {
+    if (!pixels || width <= 0 || height <= 0 || delays_ms.empty()) {
+        throw std::invalid_argument("Invalid animation frames");
+    }
+    if (config.mode == Mode::HALF_BLOCK && config.use_color) {
+        throw std::invalid_argument("Half-block animations need background colors, use it without color");
+    }
+
+    // Frames are independent, each worker converts whole frames with its own
+    // interpreter (single threaded, the frames are the parallel part)
+    const size_t frames = delays_ms.size();
+    const size_t frame_bytes = static_cast<size_t>(width) * height * channels;
+    Config frame_config = config;
+    frame_config.threads = 1;
+
+    std::vector<Cells> cells(frames);
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        Interpreter interpreter(frame_config);
+        for (size_t f; (f = next++) < frames;) {
+            interpreter.convert_cells(pixels + f * frame_bytes, width, height, channels, cells[f]);
+        }
+    };
+
+    size_t workers = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, frames);
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < workers; ++i) helpers.emplace_back(work);
+    work();
+    for (auto& t : helpers) t.join();
+
+    if (cells[0].width <= 0 || cells[0].height <= 0) {
+        throw std::invalid_argument("Animation frames convert to no cells");
+    }
+
+    Animation animation;
+    animation.width_ = cells[0].width;
+    animation.height_ = cells[0].height;
+    animation.has_color_ = config.use_color;
+    animation.charset_ = Interpreter(frame_config).charset();
+    animation.delays_ms_ = delays_ms;
+
+    animation.add_delta(nullptr, cells[0]);
+    for (size_t f = 1; f < frames; ++f) animation.add_delta(&cells[f - 1], cells[f]);
+    animation.add_delta(&cells[frames - 1], cells[0]);
+    return animation;
+}
+
+void Animation::add_delta(const Cells* from, const Cells& to) {
+    Delta delta;
+    delta.first_run = runs_.size();
+    delta.first_cell = glyphs_.size();
+
+    auto differs = [&](size_t i) {
+        if (!from) return true;
+        return from->glyphs[i] != to.glyphs[i] || (has_color_ && from->colors[i] != to.colors[i]);
+    };
+
+    for (int y = 0; y < height_; ++y) {
+        const size_t row = static_cast<size_t>(y) * width_;
+        int x = 0;
+        while (x < width_) {
+            if (!differs(row + x)) {
+                ++x;
+                continue;
+            }
+            int end = x + 1;
+            while (end < width_) {
+                if (differs(row + end)) {
+                    ++end;
+                    continue;
+                }
+                int probe = end + 1;
+                while (probe < width_ && probe - end < RUN_MERGE_GAP && !differs(row + probe)) ++probe;
+                if (probe >= width_ || probe - end >= RUN_MERGE_GAP) break;
+                end = probe + 1;
+            }
+
+            runs_.push_back({static_cast<uint32_t>(row + x), static_cast<uint32_t>(end - x)});
+            glyphs_.insert(glyphs_.end(), to.glyphs.begin() + row + x, to.glyphs.begin() + row + end);
+            if (has_color_) colors_.insert(colors_.end(), to.colors.begin() + row + x, to.colors.begin() + row + end);
+            x = end;
+        }
+    }
+
+    delta.run_count = runs_.size() - delta.first_run;
+    deltas_.push_back(delta);
+}
+
+static void append_uint(std::string& out, unsigned v) {
+    char buf[10];
+    int n = 0;
+    do {
+        buf[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) out += buf[--n];
+}
+
+void Animation::emit(size_t delta, std::string& out) const {
+    const Delta& d = deltas_[delta];
+    size_t cell = d.first_cell;
+    bool have_pen = false;
+    uint32_t pen = 0;
+
+    for (size_t r = d.first_run; r < d.first_run + d.run_count; ++r) {
+        const Run& run = runs_[r];
+        out += "\x1b[";
+        append_uint(out, run.start / width_ + 1);
+        out += ';';
+        append_uint(out, run.start % width_ + 1);
+        out += 'H';
+
+        for (uint32_t i = 0; i < run.length; ++i, ++cell) {
+            if (has_color_ && (!have_pen || colors_[cell] != pen)) {
+                pen = colors_[cell];
+                have_pen = true;
+                out += "\x1b[38;2;";
+                append_uint(out, pen >> 16);
+                out += ';';
+                append_uint(out, (pen >> 8) & 0xFF);
+                out += ';';
+                append_uint(out, pen & 0xFF);
+                out += 'm';
+            }
+            out += charset_[glyphs_[cell]];
+        }
+    }
+    if (have_pen) out += "\x1b[0m";
+}
+
+void Animation::apply(size_t delta, uint8_t* glyphs, uint32_t* colors) const {
+    const Delta& d = deltas_[delta];
+    size_t cell = d.first_cell;
+    for (size_t r = d.first_run; r < d.first_run + d.run_count; ++r) {
+        const Run& run = runs_[r];
+        std::memcpy(glyphs + run.start, &glyphs_[cell], run.length);
+        if (has_color_ && colors) std::memcpy(colors + run.start, &colors_[cell], run.length * sizeof(uint32_t));
+        cell += run.length;
+    }
+}
+
+// .nfa layout, integers little-endian:
+//   "NFA1", u16 width, u16 height, u8 flags, u8 glyphs (0 = 256), then per
+//   glyph u8 length and its UTF-8 bytes
+//   u32 frames, u32 delay_ms per frame
+//   per change set (frames + 1): u32 runs, then u32 start and u32 length per run
+//   u8 glyph per stored cell, then with color 3 bytes (r, g, b) per stored cell
+static void put_u8(std::string& out, uint8_t v) { out += static_cast<char>(v); }
+
+static void put_u16(std::string& out, uint16_t v) {
+    put_u8(out, static_cast<uint8_t>(v));
+    put_u8(out, static_cast<uint8_t>(v >> 8));
+}
+
+static void put_u32(std::string& out, uint32_t v) {
+    put_u16(out, static_cast<uint16_t>(v));
+    put_u16(out, static_cast<uint16_t>(v >> 16));
+}
+
+void Animation::save(const std::string& filename) const {
+    if (width_ > 0xFFFF || height_ > 0xFFFF || charset_.size() > 0x100) {
+        throw std::runtime_error("Animation too large to save: " + filename);
+    }
+
+    std::string out(NFA_MAGIC, sizeof(NFA_MAGIC));
+    put_u16(out, static_cast<uint16_t>(width_));
+    put_u16(out, static_cast<uint16_t>(height_));
+    put_u8(out, has_color_ ? NFA_COLOR : 0);
+    put_u8(out, static_cast<uint8_t>(charset_.size())); // 256 (braille) wraps to 0
+    for (const auto& glyph : charset_) {
+        put_u8(out, static_cast<uint8_t>(glyph.size()));
+        out += glyph;
+    }
+
+    put_u32(out, static_cast<uint32_t>(delays_ms_.size()));
+    for (int delay : delays_ms_) put_u32(out, static_cast<uint32_t>(delay));
+    for (const Delta& d : deltas_) {
+        put_u32(out, static_cast<uint32_t>(d.run_count));
+        for (size_t r = d.first_run; r < d.first_run + d.run_count; ++r) {
+            put_u32(out, runs_[r].start);
+            put_u32(out, runs_[r].length);
+        }
+    }
+    out.append(reinterpret_cast<const char*>(glyphs_.data()), glyphs_.size());
+    for (uint32_t color : colors_) {
+        put_u8(out, static_cast<uint8_t>(color >> 16));
+        put_u8(out, static_cast<uint8_t>(color >> 8));
+        put_u8(out, static_cast<uint8_t>(color));
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file || !file.write(out.data(), out.size())) {
+        throw std::runtime_error("Cannot write file: " + filename);
+    }
+}
+
+// Bounds-checked reads over the whole file
+struct NfaReader {
+    const std::string& data;
+    const std::string& filename;
+    size_t pos = 0;
+
+    void need(size_t n) {
+        if (data.size() - pos < n) throw std::runtime_error("Corrupt animation file: " + filename);
+    }
+    uint8_t u8() {
+        need(1);
+        return static_cast<uint8_t>(data[pos++]);
+    }
+    uint16_t u16() {
+        uint16_t lo = u8();
+        return static_cast<uint16_t>(lo | (u8() << 8));
+    }
+    uint32_t u32() {
+        uint32_t lo = u16();
+        return lo | (static_cast<uint32_t>(u16()) << 16);
+    }
+};
+
+Animation Animation::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    NfaReader in{data, filename};
+    auto corrupt = [&]() { return std::runtime_error("Corrupt animation file: " + filename); };
+
+    in.need(sizeof(NFA_MAGIC));
+    if (std::memcmp(data.data(), NFA_MAGIC, sizeof(NFA_MAGIC)) != 0) {
+        throw std::runtime_error("Not an animation file: " + filename);
+    }
+    in.pos = sizeof(NFA_MAGIC);
+
+    Animation animation;
+    animation.width_ = in.u16();
+    animation.height_ = in.u16();
+    animation.has_color_ = (in.u8() & NFA_COLOR) != 0;
+    size_t glyph_count = in.u8();
+    if (glyph_count == 0) glyph_count = 0x100;
+    if (animation.width_ == 0 || animation.height_ == 0) throw corrupt();
+    for (size_t i = 0; i < glyph_count; ++i) {
+        size_t length = in.u8();
+        in.need(length);
+        animation.charset_.push_back(data.substr(in.pos, length));
+        in.pos += length;
+    }
+
+    size_t frames = in.u32();
+    if (frames == 0) throw corrupt();
+    in.need(frames * 4);
+    for (size_t f = 0; f < frames; ++f) animation.delays_ms_.push_back(static_cast<int>(in.u32()));
+
+    const size_t width = animation.width_;
+    const size_t cells = width * animation.height_;
+    size_t stored = 0;
+    for (size_t f = 0; f <= frames; ++f) {
+        Delta d;
+        d.first_run = animation.runs_.size();
+        d.first_cell = stored;
+        d.run_count = in.u32();
+        in.need(d.run_count * 8);
+        for (size_t r = 0; r < d.run_count; ++r) {
+            Run run;
+            run.start = in.u32();
+            run.length = in.u32();
+            if (run.length == 0 || run.start >= cells || run.start % width + run.length > width) throw corrupt();
+            animation.runs_.push_back(run);
+            stored += run.length;
+        }
+        animation.deltas_.push_back(d);
+    }
+
+    in.need(stored);
+    animation.glyphs_.assign(data.begin() + in.pos, data.begin() + in.pos + stored);
+    in.pos += stored;
+    for (uint8_t glyph : animation.glyphs_) {
+        if (glyph >= glyph_count) throw corrupt();
+    }
+    if (animation.has_color_) {
+        in.need(stored * 3);
+        animation.colors_.resize(stored);
+        for (auto& color : animation.colors_) {
+            uint32_t r = in.u8(), g = in.u8(), b = in.u8();
+            color = (r << 16) | (g << 8) | b;
+        }
+    }
+    return animation;
+}
+
+AnimationPlayer::AnimationPlayer(const Animation& animation) : animation_(animation) {
+    size_t cells = static_cast<size_t>(animation.width()) * animation.height();
+    glyphs_.assign(cells, 0);
+    colors_.assign(cells, 0);
+    animation_.apply(0, glyphs_.data(), colors_.data());
+}
+
+void AnimationPlayer::next() {
+    frame_ = (frame_ + 1) % animation_.frame_count();
+    animation_.apply(animation_.delta_into(frame_), glyphs_.data(), colors_.data());
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "ascii_art.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ascii_art {
+
+// A converted animation, every frame turned into cells once up front.
+// Frame 0 is kept whole, every later frame (and the wrap from the last frame
+// back to the first) only as the runs of cells that changed, so playing it
+// writes just those. Runs never cross a row.
+// Saved as a .nfa file it plays back without decoding any image
+class Animation {
+public:
+    // Converts frames of width x height interleaved pixels laid out back to
+    // back, on up to threads workers (0 = one per core). Cells carry no
+    // background, so HALF_BLOCK only works without color
+    static Animation build(const uint8_t* pixels, int width, int height, int channels,
+                           const std::vector<int>& delays_ms, const Config& config, int threads = 1);
+
+    // .nfa files, both throw std::runtime_error
+    static Animation load(const std::string& filename);
+    void save(const std::string& filename) const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    bool has_color() const { return has_color_; }
+    size_t frame_count() const { return delays_ms_.size(); }
+    int delay_ms(size_t frame) const { return delays_ms_[frame]; }
+    const std::vector<std::string>& charset() const { return charset_; }
+
+    // Change sets: 0 draws frame 0 from scratch, f (1..frame_count()-1) goes
+    // from frame f-1 to f, and frame_count() from the last frame back to 0
+    size_t delta_count() const { return deltas_.size(); }
+    size_t delta_into(size_t frame) const { return frame == 0 ? deltas_.size() - 1 : frame; }
+
+    // Terminal output for a change set, cells placed from row 1, column 1
+    void emit(size_t delta, std::string& out) const;
+    // Writes a change set into width() * height() cell planes (colors may be
+    // null, and is ignored without color)
+    void apply(size_t delta, uint8_t* glyphs, uint32_t* colors) const;
+
+    size_t stored_cells() const { return glyphs_.size(); }
+
+private:
+    struct Run {
+        uint32_t start;  // first cell, row-major
+        uint32_t length;
+    };
+    struct Delta {
+        size_t first_run = 0;
+        size_t run_count = 0;
+        size_t first_cell = 0; // into glyphs_ / colors_
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    bool has_color_ = false;
+    std::vector<std::string> charset_;
+    std::vector<int> delays_ms_;
+    std::vector<Delta> deltas_;    // frame_count() + 1
+    std::vector<Run> runs_;
+    std::vector<uint8_t> glyphs_;  // cells of every run, in order
+    std::vector<uint32_t> colors_; // same, empty without color
+
+    void add_delta(const Cells* from, const Cells& to);
+};
+
+// Keeps the cells of the frame on screen while stepping through an animation
+class AnimationPlayer {
+public:
+    explicit AnimationPlayer(const Animation& animation);
+
+    // Moves on to the next frame, wrapping at the end
+    void next();
+    size_t frame() const { return frame_; }
+    int delay_ms() const { return animation_.delay_ms(frame_); }
+
+    const std::vector<uint8_t>& glyphs() const { return glyphs_; }
+    const std::vector<uint32_t>& colors() const { return colors_; }
+    const Animation& animation() const { return animation_; }
+
+private:
+    const Animation& animation_;
+    size_t frame_ = 0;
+    std::vector<uint8_t> glyphs_;
+    std::vector<uint32_t> colors_;
+};
+
+}
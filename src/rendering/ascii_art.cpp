@@ -1,11 +1,17 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "ascii_art.h"
+#include "ascii_palette.h"
+#include "ascii_simd.h"
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <cstring>
+#include <thread>
 
 // Compatibility for older C++ standards
 #if __cplusplus < 201703L && !defined(__cpp_lib_clamp)
@@ -19,103 +25,281 @@ namespace std {
 
 namespace ascii_art {
 
+// Helper threads for band conversion. run() hands task indices to the helpers
+// and to the calling thread (worker 0) and returns once all of them are done
+class BandPool {
+public:
+    explicit BandPool(int workers) {
+        for (int i = 1; i < workers; ++i) threads_.emplace_back([this, i] { loop(i); });
+    }
+    
+    ~BandPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+    
+    int size() const { return static_cast<int>(threads_.size()) + 1; }
+    
+    void run(int tasks, const std::function<void(int task, int worker)>& fn) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_ = &fn;
+        tasks_ = pending_ = tasks;
+        next_ = 0;
+        wake_.notify_all();
+        work(lock, 0);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+    }
+    
+private:
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<void(int, int)>* job_ = nullptr; // guarded by mutex_
+    int tasks_ = 0, next_ = 0, pending_ = 0;              // guarded by mutex_
+    bool stopping_ = false;                               // guarded by mutex_
+    
+    // Bands are coarse, so claiming them under the lock costs nothing
+    void work(std::unique_lock<std::mutex>& lock, int worker) {
+        while (next_ < tasks_) {
+            int task = next_++;
+            const auto& fn = *job_;
+            lock.unlock();
+            fn(task, worker);
+            lock.lock();
+            if (--pending_ == 0) done_.notify_all();
+        }
+    }
+    
+    void loop(int worker) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return stopping_ || next_ < tasks_; });
+            if (stopping_) return;
+            work(lock, worker);
+        }
+    }
+};
+
+// Several bands per worker so an uneven band doesn't leave the others idle,
+// but not so thin that the per-band overhead shows
+static int band_count(int height, int workers) {
+    constexpr int MIN_BAND_ROWS = 8;
+    return std::max(1, std::min(workers * 4, height / MIN_BAND_ROWS));
+}
+
 Interpreter::Interpreter(const Config& config) : config_(config) {}
 
+Interpreter::~Interpreter() = default;
+
+BandPool* Interpreter::pool() {
+    int threads = config_.threads;
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (threads == 1) {
+        pool_.reset();
+        return nullptr;
+    }
+    if (!pool_ || pool_->size() != threads) pool_ = std::make_unique<BandPool>(threads);
+    return pool_.get();
+}
+
+// Pixels sampled per cell, across and down
+static void dot_grid(Mode mode, int& dots_x, int& dots_y) {
+    dots_x = mode == Mode::BRAILLE ? 2 : 1;
+    dots_y = mode == Mode::BRAILLE ? 4 : (mode == Mode::HALF_BLOCK ? 2 : 1);
+}
+
+// Rows of an interleaved buffer that stays put, safe to read from any thread
+static auto buffer_rows(const uint8_t* pixels, size_t stride) {
+    return [pixels, stride](int first, int count, const uint8_t** rows) {
+        for (int k = 0; k < count; ++k) rows[k] = pixels + (first + k) * stride;
+    };
+}
+
 std::string Interpreter::convert(const Image& image) {
     if (image.data.empty() || image.width <= 0 || image.height <= 0) {
         throw std::invalid_argument("Invalid image data");
     }
     
-    int target_width = config_.target_width;
-    int target_height = config_.target_height;
+    const size_t stride = static_cast<size_t>(image.width) * image.channels;
+    return convert_rows(image.width, image.height, image.channels, buffer_rows(image.data.data(), stride), true);
+}
+
+void Interpreter::convert_cells(const uint8_t* pixels, int width, int height, int channels, Cells& out) {
+    if (!pixels || width <= 0 || height <= 0) {
+        throw std::invalid_argument("Invalid image data");
+    }
+    
+    const size_t stride = static_cast<size_t>(width) * channels;
+    target_size(width, height, out.width, out.height);
+    int dots_x, dots_y;
+    dot_grid(config_.mode, dots_x, dots_y);
+    resample_and_classify(width, height, channels, out.width * dots_x, out.height * dots_y, buffer_rows(pixels, stride), true);
+    if (dots_x * dots_y > 1) pack_dots(out.width, out.height);
+    out.glyphs = glyphs_;
+    out.colors = colors_;
+    if (config_.mode == Mode::HALF_BLOCK && config_.use_color) {
+        out.backgrounds = backgrounds_;
+    } else {
+        out.backgrounds.clear();
+    }
+}
+
+void Interpreter::target_size(int width, int height, int& target_width, int& target_height) const {
+    target_width = config_.target_width;
+    target_height = config_.target_height;
     
     if (config_.maintain_aspect && target_height == 0) {
-        target_height = static_cast<int>(target_width * image.height * config_.char_aspect_ratio / image.width);
+        target_height = static_cast<int>(target_width * height * config_.char_aspect_ratio / width);
     }
+}
+
+std::string Interpreter::convert_rows(int width, int height, int channels, const RowFetch& fetch, bool shared_fetch) {
+    int target_width, target_height;
+    target_size(width, height, target_width, target_height);
     
-    Image processed_image = resize_image(image, target_width, target_height);
+    int dots_x, dots_y;
+    dot_grid(config_.mode, dots_x, dots_y);
+    resample_and_classify(width, height, channels, target_width * dots_x, target_height * dots_y, fetch, shared_fetch);
+    if (dots_x * dots_y > 1) pack_dots(target_width, target_height);
+    return emit(target_width, target_height);
+}
+
+const std::vector<uint8_t>& Interpreter::tone_lut() {
+    ToneKey key;
+    key.gamma = config_.gamma;
+    key.contrast = config_.contrast;
+    key.brightness = config_.brightness;
+    key.use_gamma = config_.use_gamma_correction;
+    key.levels = tone_levels();
+    if (!tone_lut_.empty() && key == tone_key_) return tone_lut_;
     
-    // Process image (im not doing dithering now because ughghhggg)
+    // Every step is evaluated at its midpoint, the float chain runs 4096 times
+    // here instead of once per pixel
+    std::vector<float> luminance(simd::TONE_LUT_SIZE);
+    for (size_t i = 0; i < luminance.size(); ++i) {
+        float l = std::min(1.0f, (static_cast<float>(i) + 0.5f) / simd::LUMA_LEVELS);
+        luminance[i] = config_.use_gamma_correction ? apply_gamma_correction(l) : l;
+    }
+    tone_lut_.resize(simd::TONE_LUT_SIZE);
+    simd::tone_to_glyph(luminance.data(), luminance.size(), config_.contrast, config_.brightness,
+                        static_cast<int>(key.levels), tone_lut_.data());
+    level_lut_.resize(simd::TONE_LUT_SIZE);
+    simd::tone_to_level(luminance.data(), luminance.size(), config_.contrast, config_.brightness,
+                        static_cast<int>(key.levels), level_lut_.data());
+    tone_key_ = key;
+    return tone_lut_;
+}
 
-    std::string result;
-    // Reserve an estimated capacity when colored escapes add bytes per character
-    result.reserve(static_cast<size_t>(target_height) * (target_width * (config_.use_color ? 8 : 1) + 1));
+const std::vector<uint16_t>& Interpreter::level_lut() {
+    tone_lut();
+    return level_lut_;
+}
 
-    // cached charset may be accessed via map_intensity_to_char()
-    auto& color_cache = color_escape_cache_;
+std::string Interpreter::emit(int width, int height) {
+    BandPool* workers = pool();
+    color_escape_caches_.resize(workers ? workers->size() : 1);
+    
+    std::string result;
+    if (!workers) {
+        emit_rows(width, 0, height, color_escape_caches_[0], result);
+        return result;
+    }
+    
+    int bands = band_count(height, workers->size());
+    band_text_.resize(bands);
+    workers->run(bands, [&](int band, int worker) {
+        band_text_[band].clear();
+        emit_rows(width, height * band / bands, height * (band + 1) / bands, color_escape_caches_[worker], band_text_[band]);
+    });
+    
+    size_t size = 0;
+    for (int band = 0; band < bands; ++band) size += band_text_[band].size();
+    result.reserve(size);
+    for (int band = 0; band < bands; ++band) result += band_text_[band];
+    return result;
+}
 
-    for (int y = 0; y < target_height; ++y) {
+void Interpreter::emit_rows(int width, int y_begin, int y_end, std::unordered_map<uint32_t, std::string>& color_cache,
+                            std::string& result) const {
+    const auto& charset = get_charset();
+    
+    // Reserve an estimated capacity when colored escapes add bytes per character
+    result.reserve(result.size() + static_cast<size_t>(y_end - y_begin) * (width * (config_.use_color ? 8 : 1) + 1));
+    
+    // With a palette runs break on the palette entry instead of the exact color
+    const uint8_t* lut = config_.palette != Palette::TRUECOLOR ? palette::lut(config_.palette) : nullptr;
+    auto key = [lut](uint32_t color) { return lut ? palette::index(lut, color) : color; };
+    // Only HALF_BLOCK with color paints backgrounds
+    const bool background = config_.use_color && config_.mode == Mode::HALF_BLOCK;
+    
+    // Truecolor escapes are cached, background ones under bit 24
+    auto put_escape = [&](uint32_t color, bool back) {
+        if (lut) {
+            uint8_t index = static_cast<uint8_t>(color);
+            result += back ? palette::background_escape(config_.palette, index) : palette::escape(config_.palette, index);
+            return;
+        }
+        uint32_t cache_key = back ? color | 0x1000000 : color;
+        auto it = color_cache.find(cache_key);
+        if (it == color_cache.end()) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "\x1b[%u;2;%u;%u;%um", back ? 48u : 38u, color >> 16, (color >> 8) & 0xFF, color & 0xFF);
+            it = color_cache.emplace(cache_key, std::string(buf)).first;
+        }
+        result += it->second;
+    };
+    
+    for (int y = y_begin; y < y_end; ++y) {
+        const uint8_t* glyphs = glyphs_.data() + static_cast<size_t>(y) * width;
+        const uint32_t* colors = colors_.data() + static_cast<size_t>(y) * width;
+        const uint32_t* backs = background ? backgrounds_.data() + static_cast<size_t>(y) * width : nullptr;
+        
+        // The pens carry over between runs, an escape only goes out when a
+        // color changes and the row ends with a single reset
+        bool have_pen = false;
+        uint32_t pen = 0, back_pen = 0;
         int x = 0;
-        while (x < target_width) {
-            // compute properties of first pixel in run
-            uint8_t r = 0, g = 0, b = 0;
-            float luminance;
-            if (processed_image.channels >= 3) {
-                r = get_pixel_value(processed_image, x, y, 0);
-                g = get_pixel_value(processed_image, x, y, 1);
-                b = get_pixel_value(processed_image, x, y, 2);
-                luminance = get_luminance(r, g, b);
-            } else {
-                luminance = get_pixel_value(processed_image, x, y, 0) / 255.0f;
-                r = g = b = static_cast<uint8_t>(luminance * 255.0f);
-            }
-            if (config_.use_gamma_correction) luminance = apply_gamma_correction(luminance);
-            luminance = std::clamp(luminance * config_.contrast + config_.brightness, 0.0f, 1.0f);
-            luminance = apply_perceptual_mapping(luminance);
-
-            const std::string& ch = map_intensity_to_char(luminance);
-
-            // extend run while glyph and color match (this is ripped lol)
+        while (x < width) {
+            // extend run while glyph and color match
             int run_start = x;
+            uint8_t glyph = glyphs[x];
+            uint32_t color = key(colors[x]);
+            uint32_t back = backs ? key(backs[x]) : 0;
             ++x;
-            while (x < target_width) {
-                uint8_t nr = 0, ng = 0, nb = 0;
-                float nl;
-                if (processed_image.channels >= 3) {
-                    nr = get_pixel_value(processed_image, x, y, 0);
-                    ng = get_pixel_value(processed_image, x, y, 1);
-                    nb = get_pixel_value(processed_image, x, y, 2);
-                    nl = get_luminance(nr, ng, nb);
-                } else {
-                    nl = get_pixel_value(processed_image, x, y, 0) / 255.0f;
-                    nr = ng = nb = static_cast<uint8_t>(nl * 255.0f);
-                }
-                if (config_.use_gamma_correction) nl = apply_gamma_correction(nl);
-                nl = std::clamp(nl * config_.contrast + config_.brightness, 0.0f, 1.0f);
-                nl = apply_perceptual_mapping(nl);
-                const std::string& nch = map_intensity_to_char(nl);
-                if (config_.use_color) {
-                    if (nr != r || ng != g || nb != b || nch != ch) break;
-                } else {
-                    if (nch != ch) break;
-                }
-                ++x;
+            if (backs) {
+                while (x < width && glyphs[x] == glyph && key(colors[x]) == color && key(backs[x]) == back) ++x;
+            } else if (config_.use_color) {
+                while (x < width && glyphs[x] == glyph && key(colors[x]) == color) ++x;
+            } else {
+                while (x < width && glyphs[x] == glyph) ++x;
             }
-
-            int run_len = x - run_start;
-
+            
+            size_t run_len = static_cast<size_t>(x - run_start);
+            const std::string& ch = charset[glyph];
+            
             if (config_.use_color) {
-                uint32_t key = (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
-                auto it = color_cache.find(key);
-                if (it == color_cache.end()) {
-                    char buf[32];
-                    std::snprintf(buf, sizeof(buf), "\x1b[38;2;%u;%u;%um", r, g, b);
-                    it = color_cache.emplace(key, std::string(buf)).first;
-                }
-                result += it->second;
-                for (int i = 0; i < run_len; ++i) result += ch;
-                result += "\x1b[0m";
+                if (!have_pen || color != pen) put_escape(color, false);
+                if (backs && (!have_pen || back != back_pen)) put_escape(back, true);
+                pen = color;
+                back_pen = back;
+                have_pen = true;
+            }
+            if (ch.size() == 1) {
+                result.append(run_len, ch[0]);
             } else {
-                for (int i = 0; i < run_len; ++i) result += ch;
+                for (size_t i = 0; i < run_len; ++i) result += ch;
             }
         }
+        if (have_pen) result += "\x1b[0m";
         result += '\n';
     }
-
-    return result;
 }
 
-
 std::string Interpreter::convert_from_file(const std::string& filename) {
     std::string extension = filename.substr(filename.find_last_of('.') + 1);
     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
@@ -126,25 +310,59 @@ std::string Interpreter::convert_from_file(const std::string& filename) {
             throw std::runtime_error("Cannot open file: " + filename);
         }
         std::string magic;
-        int width, height, max_val;
+        int width = 0, height = 0, max_val = 0;
         file >> magic >> width >> height >> max_val;
         file.ignore();
         if (magic != "P6") {
             throw std::runtime_error("Unsupported PPM format");
         }
-        Image image(width, height, 3);
-        file.read(reinterpret_cast<char*>(image.data.data()), image.data.size());
-        return convert(image);
+        if (!file || width <= 0 || height <= 0) {
+            throw std::runtime_error("Invalid PPM header: " + filename);
+        }
+        
+        // Rows are read from the file as the resize asks for them, into a
+        // ring big enough for one output row's taps. Only that window of the
+        // picture is ever in memory
+        const std::streamoff pixels_at = file.tellg();
+        const size_t stride = static_cast<size_t>(width) * 3;
+        std::vector<uint8_t> ring;
+        std::vector<int> ring_rows;
+        int next_row = 0;
+        return convert_rows(width, height, 3, [&](int first, int count, const uint8_t** rows) {
+            if (static_cast<size_t>(count) > ring_rows.size()) {
+                std::vector<uint8_t>().swap(ring);
+                ring.resize(count * stride);
+                ring_rows.assign(count, -1);
+            }
+            for (int k = 0; k < count; ++k) {
+                int y = first + k;
+                size_t slot = y % ring_rows.size();
+                uint8_t* row = ring.data() + slot * stride;
+                if (ring_rows[slot] != y) {
+                    if (y != next_row) {
+                        file.clear();
+                        file.seekg(pixels_at + static_cast<std::streamoff>(y * stride));
+                    }
+                    // A short file reads as black, like it always did
+                    if (!file.read(reinterpret_cast<char*>(row), stride)) {
+                        std::memset(row + file.gcount(), 0, stride - file.gcount());
+                    }
+                    ring_rows[slot] = y;
+                    next_row = y + 1;
+                }
+                rows[k] = row;
+            }
+        }, false);
     } else {
+        // stb decodes the whole picture up front, the resize reads straight
+        // from its buffer instead of a copy
         int width, height, channels;
-        unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 3);
+        std::unique_ptr<stbi_uc, void (*)(void*)> data(stbi_load(filename.c_str(), &width, &height, &channels, 3),
+                                                       stbi_image_free);
         if (!data) {
             throw std::runtime_error("Failed to load image: " + filename);
         }
-        Image image(width, height, 3);
-        std::memcpy(image.data.data(), data, width * height * 3);
-        stbi_image_free(data);
-        return convert(image);
+        return convert_rows(width, height, 3, buffer_rows(data.get(), static_cast<size_t>(width) * 3), true);
     }
 }
 
@@ -169,25 +387,26 @@ void Interpreter::set_color(bool use_color) {
     config_.use_color = use_color;
 }
 
-float Interpreter::apply_gamma_correction(float value) const {
-    if (value <= 0.0f) return 0.0f;
-    if (value >= 1.0f) return 1.0f;
-    return std::pow(value, 1.0f / config_.gamma);
+void Interpreter::set_filter(Filter filter) {
+    config_.filter = filter;
 }
 
-float Interpreter::apply_perceptual_mapping(float intensity) const {
-    float x = intensity;
-    return std::clamp(3.0f * x * x - 2.0f * x * x * x, 0.0f, 1.0f);
+void Interpreter::set_dither(Dither dither) {
+    config_.dither = dither;
 }
 
-std::string Interpreter::get_color_escape_code(uint8_t r, uint8_t g, uint8_t b) const {
-    uint32_t key = (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
-    auto it = color_escape_cache_.find(key);
-    if (it != color_escape_cache_.end()) return it->second;
-    char buf[32];
-    std::snprintf(buf, sizeof(buf), "\x1b[38;2;%u;%u;%um", r, g, b);
-    auto em = color_escape_cache_.emplace(key, std::string(buf));
-    return em.first->second;
+void Interpreter::set_palette(Palette palette) {
+    config_.palette = palette;
+}
+
+void Interpreter::set_threads(int threads) {
+    config_.threads = threads;
+}
+
+float Interpreter::apply_gamma_correction(float value) const {
+    if (value <= 0.0f) return 0.0f;
+    if (value >= 1.0f) return 1.0f;
+    return std::pow(value, 1.0f / config_.gamma);
 }
 
 const std::vector<std::string>& Interpreter::get_charset() const {
@@ -199,55 +418,338 @@ const std::vector<std::string>& Interpreter::get_charset() const {
                     "O", "Z", "m", "w", "q", "p", "d", "b", "k", "h", "a",
                     "o", "*", "#", "M", "W", "&", "8", "%", "B", "@", "$"};
     static const std::vector<std::string> block = {" ", "░", "▒", "▓", "█"};
+    // Indexed by the top and bottom dot, bit 0 and 1
+    static const std::vector<std::string> half_block = {" ", "▀", "▄", "█"};
+    // Indexed by the dot pattern, U+2800 + bits
+    static const std::vector<std::string> braille = [] {
+        std::vector<std::string> set(256);
+        set[0] = " "; // blank either way, a space is a third of the bytes
+        for (int bits = 1; bits < 256; ++bits) {
+            int cp = 0x2800 + bits;
+            set[bits] = {static_cast<char>(0xE0 | (cp >> 12)), static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+                         static_cast<char>(0x80 | (cp & 0x3F))};
+        }
+        return set;
+    }();
     switch (config_.mode) {
         case Mode::CLEAN: return clean;
         case Mode::HIGH_FIDELITY: return high;
         case Mode::BLOCK: return block;
+        case Mode::HALF_BLOCK: return half_block;
+        case Mode::BRAILLE: return braille;
     }
     return clean;
 }
 
-float Interpreter::get_luminance(uint8_t r, uint8_t g, uint8_t b) const {
-    return 0.299f * r / 255.0f + 0.587f * g / 255.0f + 0.114f * b / 255.0f;
+int Interpreter::tone_levels() const {
+    if (config_.mode == Mode::HALF_BLOCK || config_.mode == Mode::BRAILLE) return 2;
+    return static_cast<int>(get_charset().size());
 }
 
-const std::string& Interpreter::map_intensity_to_char(float intensity) const {
-    const auto& charset = get_charset();
-    int index = static_cast<int>(intensity * (charset.size() - 1));
-    index = std::clamp(index, 0, static_cast<int>(charset.size() - 1));
-    return charset[index];
+// Separable resampling in 2.14 fixed point. Each output pixel of a pass has
+// a run of source taps starting at start[i], weights padded to max_taps
+struct ResampleTaps {
+    std::vector<int> start;
+    std::vector<int> count;
+    std::vector<int16_t> weights; // out_size * max_taps
+    int max_taps = 0;
+};
+
+static constexpr int WEIGHT_ONE = 1 << 14;
+
+// 4x4 Bayer matrix as thresholds in 1/256 glyph steps, (b + 0.5) / 16
+static constexpr uint16_t BAYER_THRESHOLDS[4][4] = {
+    {  8, 136,  40, 168},
+    {200,  72, 232, 104},
+    { 56, 184,  24, 152},
+    {248, 120, 216,  88},
+};
+static constexpr uint16_t ROUND_THRESHOLD[4] = {128, 128, 128, 128};
+
+static double filter_support(Filter filter) {
+    switch (filter) {
+        case Filter::BILINEAR: return 1.0;
+        case Filter::LANCZOS: return 3.0;
+        default: return 0.5;
+    }
 }
 
-Image Interpreter::resize_image(const Image& image, int new_width, int new_height) const {
-    Image resized(new_width, new_height, image.channels);
+static double sinc(double x) {
+    if (x == 0.0) return 1.0;
+    x *= 3.14159265358979323846;
+    return std::sin(x) / x;
+}
+
+static double filter_weight(Filter filter, double x) {
+    switch (filter) {
+        case Filter::BILINEAR:
+            x = std::fabs(x);
+            return x < 1.0 ? 1.0 - x : 0.0;
+        case Filter::LANCZOS:
+            return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+        default:
+            return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+    }
+}
+
+// When downscaling the filter is stretched to cover the whole source
+// footprint of an output pixel, so every source pixel contributes
+static ResampleTaps compute_taps(int in_size, int out_size, Filter filter) {
+    ResampleTaps taps;
+    double scale = static_cast<double>(in_size) / out_size;
+    double filter_scale = std::max(scale, 1.0);
+    double support = filter_support(filter) * filter_scale;
+    // Rounded up to 8 so the horizontal kernel's vector steps can always run
+    // over a pixel's zero padding instead of finishing tap by tap
+    taps.max_taps = (static_cast<int>(std::ceil(support)) * 2 + 1 + 7) & ~7;
+    taps.start.resize(out_size);
+    taps.count.resize(out_size);
+    taps.weights.assign(static_cast<size_t>(out_size) * taps.max_taps, 0);
     
-    float x_ratio = static_cast<float>(image.width) / new_width;
-    float y_ratio = static_cast<float>(image.height) / new_height;
+    std::vector<double> w(taps.max_taps);
+    for (int i = 0; i < out_size; ++i) {
+        double center = (i + 0.5) * scale;
+        int first = std::max(static_cast<int>(center - support + 0.5), 0);
+        int last = std::min(static_cast<int>(center + support + 0.5), in_size);
+        int n = std::min(last - first, taps.max_taps);
+        
+        double total = 0.0;
+        for (int k = 0; k < n; ++k) {
+            w[k] = filter_weight(filter, (first + k - center + 0.5) / filter_scale);
+            total += w[k];
+        }
+        if (n <= 0 || total == 0.0) {
+            // Footprint between two pixels: take the nearest one
+            first = std::clamp(static_cast<int>(center), 0, in_size - 1);
+            n = 1;
+            w[0] = total = 1.0;
+        }
+        
+        // Quantize, then push the rounding error into the biggest weight so
+        // flat areas stay exactly flat
+        int16_t* out = &taps.weights[static_cast<size_t>(i) * taps.max_taps];
+        int sum = 0, biggest = 0;
+        for (int k = 0; k < n; ++k) {
+            out[k] = static_cast<int16_t>(std::lround(w[k] / total * WEIGHT_ONE));
+            sum += out[k];
+            if (out[k] > out[biggest]) biggest = k;
+        }
+        out[biggest] = static_cast<int16_t>(out[biggest] + (WEIGHT_ONE - sum));
+        
+        // Zero weights at the edges cost a multiply each for nothing
+        int skip = 0;
+        while (skip < n - 1 && out[skip] == 0) ++skip;
+        while (n - 1 > skip && out[n - 1] == 0) --n;
+        if (skip > 0) {
+            std::memmove(out, out + skip, sizeof(int16_t) * (n - skip));
+            std::fill(out + (n - skip), out + n, static_cast<int16_t>(0));
+        }
+        taps.start[i] = first + skip;
+        taps.count[i] = n - skip;
+    }
+    return taps;
+}
+
+// Horizontal pass first: every source row a band needs is reduced once to
+// width pixels, kept in a ring as long as the vertical taps still reach it,
+// so the vertical pass only runs over width columns per output row
+void Interpreter::resample_and_classify(int src_width, int src_height, int channels,
+                                        int width, int height, const RowFetch& fetch, bool shared_fetch) {
+    const size_t cells = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0);
+    colors_.resize(cells);
+    glyphs_.resize(cells);
+    if (cells == 0) return;
     
-    for (int y = 0; y < new_height; ++y) {
-        for (int x = 0; x < new_width; ++x) {
-            int src_x = static_cast<int>(x * x_ratio);
-            int src_y = static_cast<int>(y * y_ratio);
-            
-            src_x = std::clamp(src_x, 0, image.width - 1);
-            src_y = std::clamp(src_y, 0, image.height - 1);
+    const uint8_t* lut = tone_lut().data();
+    // Dots are always decided from levels, plain rounding is a flat threshold
+    const bool dots = config_.mode == Mode::HALF_BLOCK || config_.mode == Mode::BRAILLE;
+    const uint16_t* level_lut = config_.dither != Dither::NONE || dots ? this->level_lut().data() : nullptr;
+    const bool diffuse = config_.dither == Dither::FLOYD_STEINBERG || config_.dither == Dither::ATKINSON;
+    if (diffuse) levels_.resize(cells);
+    const int max_glyph = tone_levels() - 1;
+    const bool nearest = config_.filter == Filter::NEAREST;
+    ResampleTaps vertical, horizontal;
+    if (!nearest) {
+        vertical = compute_taps(src_height, height, config_.filter);
+        horizontal = compute_taps(src_width, width, config_.filter);
+    }
+    
+    // Rows y_begin..y_end-1, with their own scratch so bands can run side by side
+    auto band = [&](int y_begin, int y_end) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * channels);
+        std::vector<uint16_t> levels(level_lut && !diffuse ? width : 0);
+        
+        // Ordered dithering only looks at its own cell, so it is done right
+        // here; error diffusion waits for the whole levels_ plane
+        auto classify = [&](int y) {
+            size_t at = static_cast<size_t>(y) * width;
+            if (!level_lut) {
+                simd::classify(pixels.data(), channels, width, lut, glyphs_.data() + at, colors_.data() + at);
+            } else if (diffuse) {
+                simd::classify_levels(pixels.data(), channels, width, level_lut, levels_.data() + at, colors_.data() + at);
+            } else {
+                simd::classify_levels(pixels.data(), channels, width, level_lut, levels.data(), colors_.data() + at);
+                const uint16_t* threshold = config_.dither == Dither::BAYER ? BAYER_THRESHOLDS[y & 3] : ROUND_THRESHOLD;
+                simd::dither_ordered(levels.data(), width, threshold, max_glyph, glyphs_.data() + at);
+            }
+        };
+        
+        if (nearest) {
+            float x_ratio = static_cast<float>(src_width) / width;
+            float y_ratio = static_cast<float>(src_height) / height;
             
-            for (int c = 0; c < image.channels; ++c) {
-                int src_index = (src_y * image.width + src_x) * image.channels + c;
-                int dst_index = (y * new_width + x) * image.channels + c;
-                resized.data[dst_index] = image.data[src_index];
+            for (int y = y_begin; y < y_end; ++y) {
+                const uint8_t* row;
+                fetch(std::clamp(static_cast<int>(y * y_ratio), 0, src_height - 1), 1, &row);
+                for (int x = 0; x < width; ++x) {
+                    int src_x = std::clamp(static_cast<int>(x * x_ratio), 0, src_width - 1);
+                    std::memcpy(&pixels[x * channels], row + src_x * channels, channels);
+                }
+                classify(y);
             }
+            return;
         }
-    }
+        
+        // An output row's taps are consecutive source rows, so max_taps slots
+        // never collide within one row
+        const size_t src_row = static_cast<size_t>(src_width) * channels;
+        const size_t out_row = static_cast<size_t>(width) * channels;
+        std::vector<uint8_t> reduced(out_row * vertical.max_taps);
+        std::vector<int> reduced_rows(vertical.max_taps, -1);
+        std::vector<const uint8_t*> rows(vertical.max_taps);
+        for (int y = y_begin; y < y_end; ++y) {
+            int taps = vertical.count[y];
+            for (int k = 0; k < taps; ++k) {
+                int src_y = vertical.start[y] + k;
+                size_t slot = src_y % vertical.max_taps;
+                uint8_t* out = reduced.data() + slot * out_row;
+                if (reduced_rows[slot] != src_y) {
+                    const uint8_t* src;
+                    fetch(src_y, 1, &src);
+                    simd::resample_pixels(src, src_row, channels, horizontal.start.data(), horizontal.count.data(),
+                                          horizontal.weights.data(), horizontal.max_taps, width, out);
+                    reduced_rows[slot] = src_y;
+                }
+                rows[k] = out;
+            }
+            simd::resample_rows(rows.data(), &vertical.weights[static_cast<size_t>(y) * vertical.max_taps], taps, out_row, pixels.data());
+            classify(y);
+        }
+    };
     
-    return resized;
+    BandPool* workers = shared_fetch ? pool() : nullptr;
+    if (!workers) {
+        band(0, height);
+    } else {
+        int bands = band_count(height, workers->size());
+        workers->run(bands, [&](int b, int) { band(height * b / bands, height * (b + 1) / bands); });
+    }
+    if (diffuse) diffuse_error(width, height);
 }
 
+// Error is kept in 1/256 glyph steps. Each row reads the error the rows above
+// left for it and only writes ahead, so three rolling rows (two margin cells
+// each side) are all the state there is
+void Interpreter::diffuse_error(int width, int height) {
+    const int max_glyph = tone_levels() - 1;
+    const bool atkinson = config_.dither == Dither::ATKINSON;
+    const size_t span = static_cast<size_t>(width) + 4;
+    std::vector<int> error(span * 3, 0);
+    
+    for (int y = 0; y < height; ++y) {
+        int* cur = &error[(y % 3) * span + 2];
+        int* next = &error[((y + 1) % 3) * span + 2];
+        int* after = &error[((y + 2) % 3) * span + 2];
+        const uint16_t* level = levels_.data() + static_cast<size_t>(y) * width;
+        uint8_t* glyph = glyphs_.data() + static_cast<size_t>(y) * width;
+        
+        for (int x = 0; x < width; ++x) {
+            int v = level[x] + cur[x];
+            int q = std::clamp((v + 128) >> 8, 0, max_glyph);
+            glyph[x] = static_cast<uint8_t>(q);
+            int e = v - (q << 8);
+            if (atkinson) {
+                // 6/8 of the error, the rest is dropped, which keeps contrast
+                e /= 8;
+                cur[x + 1] += e;
+                cur[x + 2] += e;
+                next[x - 1] += e;
+                next[x] += e;
+                next[x + 1] += e;
+                after[x] += e;
+            } else {
+                cur[x + 1] += e * 7 / 16;
+                next[x - 1] += e * 3 / 16;
+                next[x] += e * 5 / 16;
+                next[x + 1] += e / 16;
+            }
+        }
+        // This row's slot comes back around as the row after next
+        std::fill(cur - 2, cur + width + 2, 0);
+    }
+}
 
-
-uint8_t Interpreter::get_pixel_value(const Image& image, int x, int y, int channel) const {
-    int index = (y * image.width + x) * image.channels + channel;
-    return image.data[index];
+// Every cell reads whole dot rows: 2 of width dots for HALF_BLOCK, 4 of
+// 2 * width for BRAILLE, whose bits go through the packing kernel
+void Interpreter::pack_dots(int width, int height) {
+    dots_.swap(glyphs_);
+    dot_colors_.swap(colors_);
+    const size_t cells = static_cast<size_t>(width) * height;
+    glyphs_.resize(cells);
+    colors_.resize(cells);
+    const bool braille = config_.mode == Mode::BRAILLE;
+    const bool background = !braille && config_.use_color;
+    backgrounds_.resize(background ? cells : 0);
+    
+    auto pack = [&](int y_begin, int y_end) {
+        for (int y = y_begin; y < y_end; ++y) {
+            uint8_t* glyph = glyphs_.data() + static_cast<size_t>(y) * width;
+            uint32_t* color = colors_.data() + static_cast<size_t>(y) * width;
+            if (!braille) {
+                const size_t top = static_cast<size_t>(y) * 2 * width, bottom = top + width;
+                for (int x = 0; x < width; ++x) {
+                    // With color the two halves are the two colors of "▀"
+                    glyph[x] = background ? 1 : static_cast<uint8_t>(dots_[top + x] | dots_[bottom + x] << 1);
+                    color[x] = dot_colors_[top + x];
+                    if (background) backgrounds_[static_cast<size_t>(y) * width + x] = dot_colors_[bottom + x];
+                }
+                continue;
+            }
+            
+            const size_t first = static_cast<size_t>(y) * 4 * (2 * width);
+            const uint8_t* rows[4];
+            for (int k = 0; k < 4; ++k) rows[k] = dots_.data() + first + k * (2 * width);
+            simd::pack_braille(rows, width, glyph);
+            if (!config_.use_color) continue;
+            
+            // The color of the dots that are on (of all 8 when none is)
+            for (int x = 0; x < width; ++x) {
+                uint32_t r = 0, g = 0, b = 0, n = 0;
+                for (int pass = 0; pass < 2 && n == 0; ++pass) {
+                    for (int k = 0; k < 4; ++k) {
+                        for (int d = 0; d < 2; ++d) {
+                            size_t at = first + k * (2 * width) + 2 * x + d;
+                            if (pass == 0 && !dots_[at]) continue;
+                            uint32_t c = dot_colors_[at];
+                            r += c >> 16;
+                            g += (c >> 8) & 0xFF;
+                            b += c & 0xFF;
+                            ++n;
+                        }
+                    }
+                }
+                color[x] = ((r + n / 2) / n) << 16 | ((g + n / 2) / n) << 8 | ((b + n / 2) / n);
+            }
+        }
+    };
+    
+    BandPool* workers = pool();
+    if (!workers) {
+        pack(0, height);
+        return;
+    }
+    int bands = band_count(height, workers->size());
+    workers->run(bands, [&](int b, int) { pack(height * b / bands, height * (b + 1) / bands); });
 }
 
-}
\ No newline at end of file
+}
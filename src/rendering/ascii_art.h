@@ -2,6 +2,8 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
 extern "C" {
@@ -15,10 +17,42 @@ namespace ascii_art {
 using ::stbi_load;
 using ::stbi_image_free;
 
+// The sub-cell modes sample several pixels per cell: HALF_BLOCK two stacked
+// ones (top as the foreground of "▀", bottom as the background; without color
+// one of " ▀▄█"), BRAILLE a 2x4 grid of dots that are on or off
 enum class Mode {
     CLEAN,
     HIGH_FIDELITY,
-    BLOCK
+    BLOCK,
+    HALF_BLOCK,
+    BRAILLE
+};
+
+// How the source is sampled down to cells. NEAREST picks one pixel per cell, the
+// others average every source pixel under the cell's filter footprint
+enum class Filter {
+    NEAREST,
+    BOX,      // area average
+    BILINEAR, // triangle
+    LANCZOS   // Lanczos-3, sharpest
+};
+
+// How tones between two glyphs are spread over neighbouring cells. BAYER adds
+// a fixed 4x4 threshold pattern, the error diffusion modes push each cell's
+// rounding error onto the cells right of and below it
+enum class Dither {
+    NONE,
+    BAYER,
+    FLOYD_STEINBERG,
+    ATKINSON
+};
+
+// Colors of the output. The indexed palettes emit short 256/16-color SGR
+// codes, and cells that land on the same entry share one run
+enum class Palette {
+    TRUECOLOR,
+    XTERM256,
+    ANSI16
 };
 
 struct Image {
@@ -43,36 +77,111 @@ struct Config {
     float char_aspect_ratio = 0.43f;
     bool use_gamma_correction = true;
     bool use_color = false;
+    Filter filter = Filter::NEAREST;
+    Dither dither = Dither::NONE;
+    Palette palette = Palette::TRUECOLOR;
+    int threads = 1; // bands converted in parallel, 0 = one per core
+};
+
+// Glyph indices (into Interpreter::charset()) and 0xRRGGBB colors of the
+// converted cells, row-major
+struct Cells {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> glyphs;
+    std::vector<uint32_t> colors;
+    std::vector<uint32_t> backgrounds; // HALF_BLOCK with color only, else empty
 };
 
+class BandPool;
+
 class Interpreter {
 public:
     Interpreter(const Config& config = Config{});
+    ~Interpreter();
     
     std::string convert(const Image& image);
     std::string convert_from_file(const std::string& filename);
+    // Converts interleaved pixels without building any text
+    void convert_cells(const uint8_t* pixels, int width, int height, int channels, Cells& out);
+    const std::vector<std::string>& charset() const { return get_charset(); }
     
     void set_mode(Mode mode);
     void set_target_size(int width, int height = 0);
     void set_contrast(float contrast);
     void set_brightness(float brightness);
     void set_color(bool use_color);
+    void set_filter(Filter filter);
+    void set_dither(Dither dither);
+    void set_palette(Palette palette);
+    void set_threads(int threads);
     
 private:
     Config config_;
     
+    // Planar per-cell results of resample_and_classify(), reused between conversions
+    std::vector<uint32_t> colors_; // 0xRRGGBB
+    std::vector<uint8_t> glyphs_;  // index into get_charset()
+    std::vector<uint16_t> levels_; // glyph level * 256, before error diffusion
+    std::vector<uint32_t> backgrounds_; // HALF_BLOCK with color only
+    // Sub-cell modes classify dots (0 or 1) first, then pack them into cells
+    std::vector<uint8_t> dots_;
+    std::vector<uint32_t> dot_colors_;
+    
+    // Luma step -> glyph index for the whole tone chain (gamma, contrast,
+    // brightness, perceptual curve), rebuilt when one of its inputs changes
+    struct ToneKey {
+        float gamma = 0.0f, contrast = 0.0f, brightness = 0.0f;
+        bool use_gamma = false;
+        size_t levels = 0;
+        bool operator==(const ToneKey& o) const {
+            return gamma == o.gamma && contrast == o.contrast && brightness == o.brightness &&
+                   use_gamma == o.use_gamma && levels == o.levels;
+        }
+    };
+    std::vector<uint8_t> tone_lut_;
+    std::vector<uint16_t> level_lut_; // same chain, glyph level * 256 for dithering
+    ToneKey tone_key_;
+    
     const std::vector<std::string>& get_charset() const;
-    float get_luminance(uint8_t r, uint8_t g, uint8_t b) const;
-    const std::string& map_intensity_to_char(float intensity) const;
-    Image resize_image(const Image& image, int new_width, int new_height) const;
+    // What the tone chain quantizes to: the charset, or on/off for dots
+    int tone_levels() const;
     float apply_gamma_correction(float value) const;
-    float apply_perceptual_mapping(float intensity) const;
-    std::string get_color_escape_code(uint8_t r, uint8_t g, uint8_t b) const;
-
-    // cache for color escape sequences (key = 0xRRGGBB)
-    mutable std::unordered_map<uint32_t, std::string> color_escape_cache_;
+    
+    const std::vector<uint8_t>& tone_lut();
+    const std::vector<uint16_t>& level_lut();
+    
+    // Source rows for the fused resize: fills rows[0..count) with rows
+    // first..first+count-1 of the source, valid until the next call on the
+    // same thread. Only fetches that can run on several threads at once
+    // (shared_fetch) let bands resample in parallel
+    using RowFetch = std::function<void(int first, int count, const uint8_t** rows)>;
+    
+    void target_size(int width, int height, int& target_width, int& target_height) const;
+    std::string convert_rows(int width, int height, int channels, const RowFetch& fetch, bool shared_fetch);
+    // Resizes one output row at a time and classifies it straight into the
+    // cell planes, so the resized image never exists as a whole
+    void resample_and_classify(int src_width, int src_height, int channels,
+                               int width, int height, const RowFetch& fetch, bool shared_fetch);
+    // Cells of a width x height grid from the classified dots
+    void pack_dots(int width, int height);
+    // Turns levels_ into glyphs_ one row after the other, carrying the error
+    // down in a few rolling rows
+    void diffuse_error(int width, int height);
+    // Run-length encodes the classified cells into text (and color escapes)
+    std::string emit(int width, int height);
+    void emit_rows(int width, int y_begin, int y_end, std::unordered_map<uint32_t, std::string>& color_cache,
+                   std::string& out) const;
+    
+    // With threads != 1 the output rows are cut into bands that the pool's
+    // workers resample, classify and emit on their own, each with its own
+    // escape cache. Band strings are joined in order at the end
+    std::unique_ptr<BandPool> pool_;
+    BandPool* pool();
+    std::vector<std::string> band_text_;
 
-    uint8_t get_pixel_value(const Image& image, int x, int y, int channel = 0) const;
+    // cache for color escape sequences (key = 0xRRGGBB), one per worker
+    std::vector<std::unordered_map<uint32_t, std::string>> color_escape_caches_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "ascii_palette.h"
+#include <vector>
+
+namespace ascii_art {
+namespace palette {
+
+// xterm's default colors for the 16 basic entries
+static const uint32_t ANSI16[16] = {
+    0x000000, 0xCD0000, 0x00CD00, 0xCDCD00, 0x0000EE, 0xCD00CD, 0x00CDCD, 0xE5E5E5,
+    0x7F7F7F, 0xFF0000, 0x00FF00, 0xFFFF00, 0x5C5CFF, 0xFF00FF, 0x00FFFF, 0xFFFFFF,
+};
+
+static const int CUBE_LEVELS[6] = {0, 95, 135, 175, 215, 255};
+
+// Everything known about one indexed palette, built once
+struct Table {
+    std::vector<uint32_t> colors;
+    std::vector<std::string> escapes;
+    std::vector<std::string> background_escapes;
+    std::vector<uint8_t> lut;
+};
+
+static int distance(uint32_t a, uint32_t b) {
+    int dr = static_cast<int>(a >> 16) - static_cast<int>(b >> 16);
+    int dg = static_cast<int>((a >> 8) & 0xFF) - static_cast<int>((b >> 8) & 0xFF);
+    int db = static_cast<int>(a & 0xFF) - static_cast<int>(b & 0xFF);
+    // Rough perceptual weights, green matters most
+    return 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+}
+
+static Table build(Palette palette) {
+    Table table;
+    if (palette == Palette::ANSI16) {
+        for (int i = 0; i < 16; ++i) {
+            table.colors.push_back(ANSI16[i]);
+            table.escapes.push_back("\x1b[" + std::to_string(i < 8 ? 30 + i : 90 + i - 8) + "m");
+            table.background_escapes.push_back("\x1b[" + std::to_string(i < 8 ? 40 + i : 100 + i - 8) + "m");
+        }
+    } else {
+        // Entries 0-15 are left out: users and themes redefine them, the
+        // cube (16-231) and gray ramp (232-255) look the same everywhere
+        table.colors.assign(16, 0);
+        for (int r = 0; r < 6; ++r)
+            for (int g = 0; g < 6; ++g)
+                for (int b = 0; b < 6; ++b)
+                    table.colors.push_back((CUBE_LEVELS[r] << 16) | (CUBE_LEVELS[g] << 8) | CUBE_LEVELS[b]);
+        for (int i = 0; i < 24; ++i) {
+            uint32_t v = 8 + 10 * i;
+            table.colors.push_back((v << 16) | (v << 8) | v);
+        }
+        for (int i = 0; i < 256; ++i) {
+            table.escapes.push_back("\x1b[38;5;" + std::to_string(i) + "m");
+            table.background_escapes.push_back("\x1b[48;5;" + std::to_string(i) + "m");
+        }
+    }
+
+    // Each LUT cell takes the entry nearest to its center
+    const size_t first = palette == Palette::ANSI16 ? 0 : 16;
+    table.lut.resize(32 * 32 * 32);
+    for (uint32_t i = 0; i < table.lut.size(); ++i) {
+        uint32_t center = ((((i >> 10) & 31) * 8 + 4) << 16) | ((((i >> 5) & 31) * 8 + 4) << 8) | ((i & 31) * 8 + 4);
+        size_t best = first;
+        int best_distance = distance(center, table.colors[first]);
+        for (size_t k = first + 1; k < table.colors.size(); ++k) {
+            int d = distance(center, table.colors[k]);
+            if (d < best_distance) {
+                best_distance = d;
+                best = k;
+            }
+        }
+        table.lut[i] = static_cast<uint8_t>(best);
+    }
+    return table;
+}
+
+static const Table& table(Palette palette) {
+    if (palette == Palette::ANSI16) {
+        static const Table ansi16 = build(Palette::ANSI16);
+        return ansi16;
+    }
+    static const Table xterm256 = build(Palette::XTERM256);
+    return xterm256;
+}
+
+const uint8_t* lut(Palette palette) {
+    return table(palette).lut.data();
+}
+
+const std::string& escape(Palette palette, uint8_t index) {
+    return table(palette).escapes[index];
+}
+
+const std::string& background_escape(Palette palette, uint8_t index) {
+    return table(palette).background_escapes[index];
+}
+
+uint32_t color(Palette palette, uint8_t index) {
+    return table(palette).colors[index];
+}
+
+} // namespace palette
+} // namespace ascii_art
@@ -0,0 +1,24 @@
+#pragma once
+#include "ascii_art.h"
+#include <cstdint>
+#include <string>
+
+namespace ascii_art {
+namespace palette {
+
+// 0xRRGGBB -> palette index through a 32x32x32 LUT (5 bits per channel),
+// built on first use. Only for the indexed palettes, not TRUECOLOR
+const uint8_t* lut(Palette palette);
+
+inline uint8_t index(const uint8_t* lut, uint32_t color) {
+    return lut[((color >> 9) & 0x7C00) | ((color >> 6) & 0x3E0) | ((color >> 3) & 0x1F)];
+}
+
+// Foreground and background SGR sequences and the RGB the terminal shows for
+// an index
+const std::string& escape(Palette palette, uint8_t index);
+const std::string& background_escape(Palette palette, uint8_t index);
+uint32_t color(Palette palette, uint8_t index);
+
+} // namespace palette
+} // namespace ascii_art
@@ -0,0 +1,628 @@
+#include "ascii_simd.h"
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define ASCII_SIMD_X86 1
+    #include <immintrin.h>
+    #define AA_SSE41 __attribute__((target("sse4.1")))
+    #define AA_AVX2 __attribute__((target("avx2")))
+#else
+    #define ASCII_SIMD_X86 0
+#endif
+
+namespace ascii_art {
+namespace simd {
+
+// Plain loops. Used on other architectures, for odd channel counts and for
+// the tails of the wide kernels
+namespace scalar {
+
+// 4899 + 9617 + 1868 = 16384, so white lands on step (16384 * 255) >> 10 = 4080,
+// the same as gray's v << 4
+static constexpr int WEIGHT_R = 4899;
+static constexpr int WEIGHT_G = 9617;
+static constexpr int WEIGHT_B = 1868;
+static constexpr int LUMA_SHIFT = 10;
+
+// T is uint8_t for glyph indices, uint16_t for 8.8 glyph levels
+template <typename T>
+static void classify(const uint8_t* src, int channels, size_t n, const T* lut, T* glyph, uint32_t* color) {
+    if (channels >= 3) {
+        for (size_t i = 0; i < n; ++i, src += channels) {
+            int step = (WEIGHT_R * src[0] + WEIGHT_G * src[1] + WEIGHT_B * src[2]) >> LUMA_SHIFT;
+            glyph[i] = lut[step];
+            color[i] = (uint32_t(src[0]) << 16) | (uint32_t(src[1]) << 8) | uint32_t(src[2]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i, src += channels) {
+            glyph[i] = lut[src[0] << 4];
+            color[i] = (uint32_t(src[0]) << 16) | (uint32_t(src[0]) << 8) | uint32_t(src[0]);
+        }
+    }
+}
+
+static void tone_to_glyph(const float* lum, size_t n, float contrast, float brightness, int levels, uint8_t* glyph) {
+    float scale = static_cast<float>(levels - 1);
+    for (size_t i = 0; i < n; ++i) {
+        float x = std::clamp(lum[i] * contrast + brightness, 0.0f, 1.0f);
+        x = std::clamp(3.0f * x * x - 2.0f * x * x * x, 0.0f, 1.0f);
+        int index = static_cast<int>(x * scale);
+        glyph[i] = static_cast<uint8_t>(std::clamp(index, 0, levels - 1));
+    }
+}
+
+static void dither_ordered(const uint16_t* level, size_t n, const uint16_t* threshold, int max_glyph, uint8_t* glyph) {
+    for (size_t x = 0; x < n; ++x) {
+        int q = (level[x] + threshold[x & 3]) >> 8;
+        glyph[x] = static_cast<uint8_t>(q < max_glyph ? q : max_glyph);
+    }
+}
+
+static constexpr int WEIGHT_BITS = 14;
+
+static inline uint8_t clamp_u8(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// out[x] for x in [begin, end)
+static void resample_span(const uint8_t* const* rows, const int16_t* weights, int taps, size_t begin, size_t end, uint8_t* out) {
+    for (size_t x = begin; x < end; ++x) {
+        int acc = 1 << (WEIGHT_BITS - 1);
+        for (int k = 0; k < taps; ++k) acc += weights[k] * rows[k][x];
+        out[x] = clamp_u8(acc >> WEIGHT_BITS);
+    }
+}
+
+static void resample_rows(const uint8_t* const* rows, const int16_t* weights, int taps, size_t n, uint8_t* out) {
+    resample_span(rows, weights, taps, 0, n, out);
+}
+
+// Taps k..taps-1 of one output pixel added to acc, a sum per channel
+static inline void pixel_taps(const uint8_t* in, int channels, const int16_t* w, int k, int taps, int* acc) {
+    for (; k < taps; ++k) {
+        for (int c = 0; c < channels; ++c) acc[c] += w[k] * in[k * channels + c];
+    }
+}
+
+static void resample_pixels(const uint8_t* row, size_t row_bytes, int channels, const int* start, const int* count,
+                            const int16_t* weights, int max_taps, size_t n, uint8_t* out) {
+    (void)row_bytes;
+    for (size_t x = 0; x < n; ++x, out += channels) {
+        int acc[4] = {0, 0, 0, 0};
+        pixel_taps(row + static_cast<size_t>(start[x]) * channels, channels, weights + x * max_taps, 0, count[x], acc);
+        for (int c = 0; c < channels; ++c) out[c] = clamp_u8((acc[c] + (1 << (WEIGHT_BITS - 1))) >> WEIGHT_BITS);
+    }
+}
+
+static void pack_braille(const uint8_t* const* rows, size_t n, uint8_t* out) {
+    for (size_t x = 0; x < n; ++x) {
+        const size_t l = 2 * x, r = l + 1;
+        out[x] = static_cast<uint8_t>(rows[0][l] | rows[1][l] << 1 | rows[2][l] << 2 | rows[0][r] << 3 |
+                                      rows[1][r] << 4 | rows[2][r] << 5 | rows[3][l] << 6 | rows[3][r] << 7);
+    }
+}
+
+} // namespace scalar
+
+#if ASCII_SIMD_X86
+
+namespace sse41 {
+
+// Splits 16 interleaved RGB pixels (48 bytes) into planar r, g, b
+AA_SSE41 static inline void deinterleave_rgb(const uint8_t* src, __m128i& r, __m128i& g, __m128i& b) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+    const char z = -128; // pshufb zero lane
+    r = _mm_or_si128(_mm_or_si128(
+            _mm_shuffle_epi8(a, _mm_setr_epi8(0, 3, 6, 9, 12, 15, z, z, z, z, z, z, z, z, z, z)),
+            _mm_shuffle_epi8(m, _mm_setr_epi8(z, z, z, z, z, z, 2, 5, 8, 11, 14, z, z, z, z, z))),
+            _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, 1, 4, 7, 10, 13)));
+    g = _mm_or_si128(_mm_or_si128(
+            _mm_shuffle_epi8(a, _mm_setr_epi8(1, 4, 7, 10, 13, z, z, z, z, z, z, z, z, z, z, z)),
+            _mm_shuffle_epi8(m, _mm_setr_epi8(z, z, z, z, z, 0, 3, 6, 9, 12, 15, z, z, z, z, z))),
+            _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, 2, 5, 8, 11, 14)));
+    b = _mm_or_si128(_mm_or_si128(
+            _mm_shuffle_epi8(a, _mm_setr_epi8(2, 5, 8, 11, 14, z, z, z, z, z, z, z, z, z, z, z)),
+            _mm_shuffle_epi8(m, _mm_setr_epi8(z, z, z, z, z, 1, 4, 7, 10, 13, z, z, z, z, z, z))),
+            _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, 0, 3, 6, 9, 12, 15)));
+}
+
+// Eight pixels: 16-bit r, g, b lanes -> luma steps
+AA_SSE41 static inline __m128i luma_steps8(__m128i r, __m128i g, __m128i b) {
+    const __m128i wrg = _mm_set1_epi32((scalar::WEIGHT_G << 16) | scalar::WEIGHT_R);
+    const __m128i wb = _mm_set1_epi32(scalar::WEIGHT_B);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(r, g), wrg), _mm_madd_epi16(_mm_unpacklo_epi16(b, zero), wb));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(r, g), wrg), _mm_madd_epi16(_mm_unpackhi_epi16(b, zero), wb));
+    return _mm_packus_epi32(_mm_srli_epi32(lo, scalar::LUMA_SHIFT), _mm_srli_epi32(hi, scalar::LUMA_SHIFT));
+}
+
+// Four pixels: 8-bit r, g, b in the low lanes -> packed colors
+AA_SSE41 static inline __m128i pack4(__m128i r, __m128i g, __m128i b) {
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_cvtepu8_epi32(r), 16), _mm_slli_epi32(_mm_cvtepu8_epi32(g), 8)),
+                        _mm_cvtepu8_epi32(b));
+}
+
+template <typename T>
+AA_SSE41 static void classify(const uint8_t* src, int channels, size_t n, const T* lut, T* glyph, uint32_t* color) {
+    if (channels != 3) {
+        scalar::classify(src, channels, n, lut, glyph, color);
+        return;
+    }
+    alignas(16) uint16_t steps[16];
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i r, g, b;
+        deinterleave_rgb(src + i * 3, r, g, b);
+        _mm_store_si128(reinterpret_cast<__m128i*>(steps),
+                        luma_steps8(_mm_cvtepu8_epi16(r), _mm_cvtepu8_epi16(g), _mm_cvtepu8_epi16(b)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(steps + 8),
+                        luma_steps8(_mm_cvtepu8_epi16(_mm_srli_si128(r, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(g, 8)),
+                                    _mm_cvtepu8_epi16(_mm_srli_si128(b, 8))));
+        for (int k = 0; k < 16; ++k) glyph[i + k] = lut[steps[k]];
+        for (int q = 0; q < 4; ++q) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(color + i + q * 4), pack4(r, g, b));
+            r = _mm_srli_si128(r, 4);
+            g = _mm_srli_si128(g, 4);
+            b = _mm_srli_si128(b, 4);
+        }
+    }
+    scalar::classify(src + i * 3, channels, n - i, lut, glyph + i, color + i);
+}
+
+AA_SSE41 static inline __m128i tone4(__m128 x, __m128 contrast, __m128 brightness, __m128 scale) {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    x = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(x, contrast), brightness), zero), one);
+    __m128 x2 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(3.0f), x), x);
+    __m128 x3 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), x), x), x);
+    x = _mm_min_ps(_mm_max_ps(_mm_sub_ps(x2, x3), zero), one);
+    return _mm_cvttps_epi32(_mm_mul_ps(x, scale));
+}
+
+AA_SSE41 static void tone_to_glyph(const float* lum, size_t n, float contrast, float brightness, int levels, uint8_t* glyph) {
+    const __m128 c = _mm_set1_ps(contrast), br = _mm_set1_ps(brightness);
+    const __m128 scale = _mm_set1_ps(static_cast<float>(levels - 1));
+    const __m128i top = _mm_set1_epi32(levels - 1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i i0 = _mm_min_epi32(tone4(_mm_loadu_ps(lum + i), c, br, scale), top);
+        __m128i i1 = _mm_min_epi32(tone4(_mm_loadu_ps(lum + i + 4), c, br, scale), top);
+        __m128i i2 = _mm_min_epi32(tone4(_mm_loadu_ps(lum + i + 8), c, br, scale), top);
+        __m128i i3 = _mm_min_epi32(tone4(_mm_loadu_ps(lum + i + 12), c, br, scale), top);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(glyph + i), packed);
+    }
+    scalar::tone_to_glyph(lum + i, n - i, contrast, brightness, levels, glyph + i);
+}
+
+// The threshold pattern repeats every 4 cells, so one vector covers a row
+AA_SSE41 static void dither_ordered(const uint16_t* level, size_t n, const uint16_t* threshold, int max_glyph, uint8_t* glyph) {
+    const __m128i t = _mm_setr_epi16(threshold[0], threshold[1], threshold[2], threshold[3],
+                                     threshold[0], threshold[1], threshold[2], threshold[3]);
+    const __m128i top = _mm_set1_epi16(static_cast<int16_t>(max_glyph));
+    size_t x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(level + x));
+        v = _mm_min_epu16(_mm_srli_epi16(_mm_add_epi16(v, t), 8), top);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(glyph + x), _mm_packus_epi16(v, v));
+    }
+    scalar::dither_ordered(level + x, n - x, threshold, max_glyph, glyph + x);
+}
+
+// Taps go in pairs through pmaddwd: rows k and k+1 interleaved as 16-bit
+// lanes against (w[k], w[k+1])
+AA_SSE41 static void resample_rows(const uint8_t* const* rows, const int16_t* weights, int taps, size_t n, uint8_t* out) {
+    const __m128i round = _mm_set1_epi32(1 << (scalar::WEIGHT_BITS - 1));
+    const __m128i zero = _mm_setzero_si128();
+    size_t x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m128i lo = round, hi = round;
+        for (int k = 0; k < taps; k += 2) {
+            __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k] + x)));
+            __m128i b = zero;
+            int32_t pair = static_cast<uint16_t>(weights[k]);
+            if (k + 1 < taps) {
+                b = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k + 1] + x)));
+                pair |= static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint16_t>(weights[k + 1])) << 16);
+            }
+            __m128i w = _mm_set1_epi32(pair);
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+        __m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, scalar::WEIGHT_BITS), _mm_srai_epi32(hi, scalar::WEIGHT_BITS));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(v, v));
+    }
+    scalar::resample_span(rows, weights, taps, x, n, out);
+}
+
+// pshufb masks that pair taps up for pmaddwd: taps 0 and 1 (lo) or 2 and 3
+// (hi) of 4 interleaved pixels as 16-bit lanes (c0 t0, c0 t1, c1 t0, ...)
+struct TapMasks {
+    __m128i lo, hi;
+};
+
+AA_SSE41 static inline TapMasks tap_masks(int channels) {
+    const char z = -128;
+    if (channels == 3) {
+        return {_mm_setr_epi8(0, z, 3, z, 1, z, 4, z, 2, z, 5, z, z, z, z, z),
+                _mm_setr_epi8(6, z, 9, z, 7, z, 10, z, 8, z, 11, z, z, z, z, z)};
+    }
+    return {_mm_setr_epi8(0, z, 4, z, 1, z, 5, z, 2, z, 6, z, 3, z, 7, z),
+            _mm_setr_epi8(8, z, 12, z, 9, z, 13, z, 10, z, 14, z, 11, z, 15, z)};
+}
+
+// Taps of a pixel rounded up to whole vector steps of `step` taps, which
+// only reads zero weights when that stays within max_taps
+static inline int padded_taps(int taps, int step, int max_taps) {
+    int padded = (taps + step - 1) / step * step;
+    return padded <= max_taps ? padded : taps;
+}
+
+// Finishes one output pixel from tap k on. acc holds a sum per channel for
+// 3 and 4 channels, partial sums to add up for 1. Four taps (eight for one
+// channel) per step while the loads stay inside the row, the rest one by one.
+// Always inlined: the AVX2 kernel finishes with it too, and a call into
+// non-VEX code with the upper halves dirty stalls on every pixel
+AA_SSE41 __attribute__((always_inline)) static inline void pixel_taps(const uint8_t* in, const uint8_t* end, int channels, const TapMasks& masks,
+                                       const int16_t* w, int k, int taps, int max_taps, __m128i acc, uint8_t* out) {
+    const __m128i round = _mm_set1_epi32(1 << (scalar::WEIGHT_BITS - 1));
+    if (channels == 1) {
+        const int padded = padded_taps(taps, 8, max_taps);
+        for (; k + 8 <= padded && in + k + 8 <= end; k += 8) {
+            __m128i px = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + k)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + k))));
+        }
+        acc = _mm_hadd_epi32(acc, acc);
+        acc = _mm_hadd_epi32(acc, acc);
+    } else {
+        const int padded = padded_taps(taps, 4, max_taps);
+        for (; k + 4 <= padded && in + k * channels + 16 <= end; k += 4) {
+            __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + k * channels));
+            __m128i pairs = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(w + k)); // (w0, w1), (w2, w3)
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_shuffle_epi8(px, masks.lo), _mm_shuffle_epi32(pairs, 0x00)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_shuffle_epi8(px, masks.hi), _mm_shuffle_epi32(pairs, 0x55)));
+        }
+    }
+    if (k < taps) {
+        // Near the end of the row, where a full load would run past it
+        int32_t sums[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), acc);
+        scalar::pixel_taps(in, channels, w, k, taps, sums);
+        acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums));
+    }
+    __m128i v = _mm_srai_epi32(_mm_add_epi32(acc, round), scalar::WEIGHT_BITS);
+    v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+    int32_t bytes = _mm_cvtsi128_si32(v);
+    if (channels == 4) std::memcpy(out, &bytes, 4);
+    else if (channels == 3) std::memcpy(out, &bytes, 3);
+    else out[0] = static_cast<uint8_t>(bytes);
+}
+
+AA_SSE41 static void resample_pixels(const uint8_t* row, size_t row_bytes, int channels, const int* start, const int* count,
+                                     const int16_t* weights, int max_taps, size_t n, uint8_t* out) {
+    if (channels != 1 && channels != 3 && channels != 4) {
+        scalar::resample_pixels(row, row_bytes, channels, start, count, weights, max_taps, n, out);
+        return;
+    }
+    const TapMasks masks = tap_masks(channels);
+    const uint8_t* end = row + row_bytes;
+    for (size_t x = 0; x < n; ++x, out += channels) {
+        pixel_taps(row + static_cast<size_t>(start[x]) * channels, end, channels, masks, weights + x * max_taps, 0,
+                   count[x], max_taps, _mm_setzero_si128(), out);
+    }
+}
+
+// A 16-bit lane holds one cell's left dot (low byte) and right dot (high
+// byte) of a row. Shifting whole lanes builds both columns' bits at once
+AA_SSE41 static void pack_braille(const uint8_t* const* rows, size_t n, uint8_t* out) {
+    const __m128i low3 = _mm_set1_epi16(0x07), high3 = _mm_set1_epi16(0x38);
+    const __m128i bit6 = _mm_set1_epi16(0x40), bit7 = _mm_set1_epi16(0x80);
+    size_t x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[0] + 2 * x));
+        __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[1] + 2 * x));
+        __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[2] + 2 * x));
+        __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[3] + 2 * x));
+        __m128i a = _mm_or_si128(r0, _mm_or_si128(_mm_slli_epi16(r1, 1), _mm_slli_epi16(r2, 2)));
+        __m128i v = _mm_or_si128(_mm_and_si128(a, low3), _mm_and_si128(_mm_srli_epi16(a, 5), high3));
+        v = _mm_or_si128(v, _mm_and_si128(_mm_slli_epi16(r3, 6), bit6));
+        v = _mm_or_si128(v, _mm_and_si128(_mm_srli_epi16(r3, 1), bit7));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(v, v));
+    }
+    const uint8_t* tail[4] = {rows[0] + 2 * x, rows[1] + 2 * x, rows[2] + 2 * x, rows[3] + 2 * x};
+    scalar::pack_braille(tail, n - x, out + x);
+}
+
+} // namespace sse41
+
+namespace avx2 {
+
+// Sixteen pixels: 8-bit r, g, b -> luma steps. unpacklo/hi work per 128-bit
+// half and packus puts the halves back in pixel order
+AA_AVX2 static inline __m256i luma_steps16(__m128i r8, __m128i g8, __m128i b8) {
+    const __m256i wrg = _mm256_set1_epi32((scalar::WEIGHT_G << 16) | scalar::WEIGHT_R);
+    const __m256i wb = _mm256_set1_epi32(scalar::WEIGHT_B);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i r = _mm256_cvtepu8_epi16(r8), g = _mm256_cvtepu8_epi16(g8), b = _mm256_cvtepu8_epi16(b8);
+    __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(r, g), wrg),
+                                  _mm256_madd_epi16(_mm256_unpacklo_epi16(b, zero), wb));
+    __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(r, g), wrg),
+                                  _mm256_madd_epi16(_mm256_unpackhi_epi16(b, zero), wb));
+    return _mm256_packus_epi32(_mm256_srli_epi32(lo, scalar::LUMA_SHIFT), _mm256_srli_epi32(hi, scalar::LUMA_SHIFT));
+}
+
+AA_AVX2 static inline __m256i pack8(__m128i r, __m128i g, __m128i b) {
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(_mm256_cvtepu8_epi32(r), 16),
+                                           _mm256_slli_epi32(_mm256_cvtepu8_epi32(g), 8)),
+                           _mm256_cvtepu8_epi32(b));
+}
+
+template <typename T>
+AA_AVX2 static void classify(const uint8_t* src, int channels, size_t n, const T* lut, T* glyph, uint32_t* color) {
+    if (channels != 3) {
+        scalar::classify(src, channels, n, lut, glyph, color);
+        return;
+    }
+    alignas(32) uint16_t steps[16];
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i r, g, b;
+        sse41::deinterleave_rgb(src + i * 3, r, g, b);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(steps), luma_steps16(r, g, b));
+        for (int k = 0; k < 16; ++k) glyph[i + k] = lut[steps[k]];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(color + i), pack8(r, g, b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(color + i + 8),
+                            pack8(_mm_srli_si128(r, 8), _mm_srli_si128(g, 8), _mm_srli_si128(b, 8)));
+    }
+    scalar::classify(src + i * 3, channels, n - i, lut, glyph + i, color + i);
+}
+
+AA_AVX2 static inline __m256i tone8(__m256 x, __m256 contrast, __m256 brightness, __m256 scale) {
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    x = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(x, contrast), brightness), zero), one);
+    __m256 x2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(3.0f), x), x);
+    __m256 x3 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), x), x), x);
+    x = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(x2, x3), zero), one);
+    return _mm256_cvttps_epi32(_mm256_mul_ps(x, scale));
+}
+
+AA_AVX2 static void tone_to_glyph(const float* lum, size_t n, float contrast, float brightness, int levels, uint8_t* glyph) {
+    const __m256 c = _mm256_set1_ps(contrast), br = _mm256_set1_ps(brightness);
+    const __m256 scale = _mm256_set1_ps(static_cast<float>(levels - 1));
+    const __m256i top = _mm256_set1_epi32(levels - 1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i i0 = _mm256_min_epi32(tone8(_mm256_loadu_ps(lum + i), c, br, scale), top);
+        __m256i i1 = _mm256_min_epi32(tone8(_mm256_loadu_ps(lum + i + 8), c, br, scale), top);
+        __m256i i2 = _mm256_min_epi32(tone8(_mm256_loadu_ps(lum + i + 16), c, br, scale), top);
+        __m256i i3 = _mm256_min_epi32(tone8(_mm256_loadu_ps(lum + i + 24), c, br, scale), top);
+        // pack works per 128-bit half, the permute puts the bytes back in order
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(i0, i1), _mm256_packs_epi32(i2, i3));
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(glyph + i), packed);
+    }
+    scalar::tone_to_glyph(lum + i, n - i, contrast, brightness, levels, glyph + i);
+}
+
+AA_AVX2 static void dither_ordered(const uint16_t* level, size_t n, const uint16_t* threshold, int max_glyph, uint8_t* glyph) {
+    const __m256i t = _mm256_setr_epi16(threshold[0], threshold[1], threshold[2], threshold[3],
+                                        threshold[0], threshold[1], threshold[2], threshold[3],
+                                        threshold[0], threshold[1], threshold[2], threshold[3],
+                                        threshold[0], threshold[1], threshold[2], threshold[3]);
+    const __m256i top = _mm256_set1_epi16(static_cast<int16_t>(max_glyph));
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(level + x));
+        v = _mm256_min_epu16(_mm256_srli_epi16(_mm256_add_epi16(v, t), 8), top);
+        v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(glyph + x), _mm256_castsi256_si128(v));
+    }
+    scalar::dither_ordered(level + x, n - x, threshold, max_glyph, glyph + x);
+}
+
+AA_AVX2 static void resample_rows(const uint8_t* const* rows, const int16_t* weights, int taps, size_t n, uint8_t* out) {
+    const __m256i round = _mm256_set1_epi32(1 << (scalar::WEIGHT_BITS - 1));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        // lo holds x 0-3 and 8-11, hi 4-7 and 12-15 (unpack works per 128-bit half)
+        __m256i lo = round, hi = round;
+        for (int k = 0; k < taps; k += 2) {
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + x)));
+            __m256i b = zero;
+            int32_t pair = static_cast<uint16_t>(weights[k]);
+            if (k + 1 < taps) {
+                b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + x)));
+                pair |= static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint16_t>(weights[k + 1])) << 16);
+            }
+            __m256i w = _mm256_set1_epi32(pair);
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+        }
+        __m256i v = _mm256_packs_epi32(_mm256_srai_epi32(lo, scalar::WEIGHT_BITS), _mm256_srai_epi32(hi, scalar::WEIGHT_BITS));
+        v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm256_castsi256_si128(v));
+    }
+    scalar::resample_span(rows, weights, taps, x, n, out);
+}
+
+// Two output pixels side by side, one per 128-bit half, four taps each per
+// step with the SSE4.1 masks. Sharing the setup and the packing at the end
+// is what pays at small footprints. One channel sums sixteen taps per step
+AA_AVX2 static void resample_pixels(const uint8_t* row, size_t row_bytes, int channels, const int* start, const int* count,
+                                    const int16_t* weights, int max_taps, size_t n, uint8_t* out) {
+    if (channels != 1 && channels != 3 && channels != 4) {
+        scalar::resample_pixels(row, row_bytes, channels, start, count, weights, max_taps, n, out);
+        return;
+    }
+    const sse41::TapMasks masks = sse41::tap_masks(channels);
+    const uint8_t* end = row + row_bytes;
+    size_t x = 0;
+    if (channels == 1) {
+        for (; x < n; ++x, ++out) {
+            const uint8_t* in = row + start[x];
+            const int16_t* w = weights + x * max_taps;
+            const int padded = sse41::padded_taps(count[x], 16, max_taps);
+            __m256i acc = _mm256_setzero_si256();
+            int k = 0;
+            for (; k + 16 <= padded && in + k + 16 <= end; k += 16) {
+                __m256i px = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + k)));
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(px, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + k))));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+            sse41::pixel_taps(in, end, 1, masks, w, k, count[x], max_taps, half, out);
+        }
+        return;
+    }
+    
+    const __m256i lo_mask = _mm256_broadcastsi128_si256(masks.lo);
+    const __m256i hi_mask = _mm256_broadcastsi128_si256(masks.hi);
+    const __m256i round = _mm256_set1_epi32(1 << (scalar::WEIGHT_BITS - 1));
+    for (; x + 2 <= n; x += 2, out += 2 * channels) {
+        const uint8_t* in0 = row + static_cast<size_t>(start[x]) * channels;
+        const uint8_t* in1 = row + static_cast<size_t>(start[x + 1]) * channels;
+        const int16_t* w0 = weights + x * max_taps;
+        const int16_t* w1 = w0 + max_taps;
+        const int steps = std::max(sse41::padded_taps(count[x], 4, max_taps), sse41::padded_taps(count[x + 1], 4, max_taps));
+        __m256i acc = _mm256_setzero_si256();
+        int k = 0;
+        for (; k + 4 <= steps && in0 + k * channels + 16 <= end && in1 + k * channels + 16 <= end; k += 4) {
+            __m256i px = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in0 + k * channels))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in1 + k * channels)), 1);
+            __m256i pairs = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(w0 + k))),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(w1 + k)), 1);
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_shuffle_epi8(px, lo_mask), _mm256_shuffle_epi32(pairs, 0x00)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_shuffle_epi8(px, hi_mask), _mm256_shuffle_epi32(pairs, 0x55)));
+        }
+        if (k < count[x] || k < count[x + 1]) {
+            // Near the end of the row, one pixel at a time from here
+            sse41::pixel_taps(in0, end, channels, masks, w0, k, count[x], max_taps, _mm256_castsi256_si128(acc), out);
+            sse41::pixel_taps(in1, end, channels, masks, w1, k, count[x + 1], max_taps, _mm256_extracti128_si256(acc, 1),
+                              out + channels);
+            continue;
+        }
+        __m256i v = _mm256_srai_epi32(_mm256_add_epi32(acc, round), scalar::WEIGHT_BITS);
+        v = _mm256_packus_epi16(_mm256_packs_epi32(v, v), v);
+        int32_t first = _mm256_cvtsi256_si32(v);
+        int32_t second = _mm_cvtsi128_si32(_mm256_extracti128_si256(v, 1));
+        std::memcpy(out, &first, channels);
+        std::memcpy(out + channels, &second, channels);
+    }
+    for (; x < n; ++x, out += channels) {
+        sse41::pixel_taps(row + static_cast<size_t>(start[x]) * channels, end, channels, masks, weights + x * max_taps, 0,
+                          count[x], max_taps, _mm_setzero_si128(), out);
+    }
+}
+
+AA_AVX2 static void pack_braille(const uint8_t* const* rows, size_t n, uint8_t* out) {
+    const __m256i low3 = _mm256_set1_epi16(0x07), high3 = _mm256_set1_epi16(0x38);
+    const __m256i bit6 = _mm256_set1_epi16(0x40), bit7 = _mm256_set1_epi16(0x80);
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[0] + 2 * x));
+        __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[1] + 2 * x));
+        __m256i r2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[2] + 2 * x));
+        __m256i r3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[3] + 2 * x));
+        __m256i a = _mm256_or_si256(r0, _mm256_or_si256(_mm256_slli_epi16(r1, 1), _mm256_slli_epi16(r2, 2)));
+        __m256i v = _mm256_or_si256(_mm256_and_si256(a, low3), _mm256_and_si256(_mm256_srli_epi16(a, 5), high3));
+        v = _mm256_or_si256(v, _mm256_and_si256(_mm256_slli_epi16(r3, 6), bit6));
+        v = _mm256_or_si256(v, _mm256_and_si256(_mm256_srli_epi16(r3, 1), bit7));
+        v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm256_castsi256_si128(v));
+    }
+    const uint8_t* tail[4] = {rows[0] + 2 * x, rows[1] + 2 * x, rows[2] + 2 * x, rows[3] + 2 * x};
+    scalar::pack_braille(tail, n - x, out + x);
+}
+
+} // namespace avx2
+
+#endif // ASCII_SIMD_X86
+
+struct Kernels {
+    Level level;
+    void (*classify)(const uint8_t*, int, size_t, const uint8_t*, uint8_t*, uint32_t*);
+    void (*classify_levels)(const uint8_t*, int, size_t, const uint16_t*, uint16_t*, uint32_t*);
+    void (*tone_to_glyph)(const float*, size_t, float, float, int, uint8_t*);
+    void (*dither_ordered)(const uint16_t*, size_t, const uint16_t*, int, uint8_t*);
+    void (*resample_rows)(const uint8_t* const*, const int16_t*, int, size_t, uint8_t*);
+    void (*resample_pixels)(const uint8_t*, size_t, int, const int*, const int*, const int16_t*, int, size_t, uint8_t*);
+    void (*pack_braille)(const uint8_t* const*, size_t, uint8_t*);
+};
+
+static Kernels select_kernels() {
+#if ASCII_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Kernels{Level::AVX2, avx2::classify<uint8_t>, avx2::classify<uint16_t>, avx2::tone_to_glyph,
+                       avx2::dither_ordered, avx2::resample_rows, avx2::resample_pixels, avx2::pack_braille};
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Kernels{Level::SSE41, sse41::classify<uint8_t>, sse41::classify<uint16_t>, sse41::tone_to_glyph,
+                       sse41::dither_ordered, sse41::resample_rows, sse41::resample_pixels, sse41::pack_braille};
+    }
+#endif
+    return Kernels{Level::SCALAR, scalar::classify<uint8_t>, scalar::classify<uint16_t>, scalar::tone_to_glyph,
+                   scalar::dither_ordered, scalar::resample_rows, scalar::resample_pixels, scalar::pack_braille};
+}
+
+static const Kernels& kernels() {
+    static const Kernels k = select_kernels();
+    return k;
+}
+
+Level level() { return kernels().level; }
+
+const char* level_name() {
+    switch (level()) {
+        case Level::AVX2: return "avx2";
+        case Level::SSE41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+void classify(const uint8_t* src, int channels, size_t n, const uint8_t* lut, uint8_t* glyph, uint32_t* color) {
+    kernels().classify(src, channels, n, lut, glyph, color);
+}
+
+void classify_levels(const uint8_t* src, int channels, size_t n, const uint16_t* lut, uint16_t* level, uint32_t* color) {
+    kernels().classify_levels(src, channels, n, lut, level, color);
+}
+
+void tone_to_glyph(const float* lum, size_t n, float contrast, float brightness, int levels, uint8_t* glyph) {
+    kernels().tone_to_glyph(lum, n, contrast, brightness, levels, glyph);
+}
+
+// Only runs when the tone settings change, not worth vectorizing
+void tone_to_level(const float* lum, size_t n, float contrast, float brightness, int levels, uint16_t* level) {
+    const int top = (levels - 1) * 256;
+    for (size_t i = 0; i < n; ++i) {
+        float x = std::clamp(lum[i] * contrast + brightness, 0.0f, 1.0f);
+        x = std::clamp(3.0f * x * x - 2.0f * x * x * x, 0.0f, 1.0f);
+        int v = static_cast<int>(x * static_cast<float>(levels - 1) * 256.0f);
+        level[i] = static_cast<uint16_t>(std::clamp(v, 0, top));
+    }
+}
+
+void dither_ordered(const uint16_t* level, size_t n, const uint16_t* threshold, int max_glyph, uint8_t* glyph) {
+    kernels().dither_ordered(level, n, threshold, max_glyph, glyph);
+}
+
+void resample_rows(const uint8_t* const* rows, const int16_t* weights, int taps, size_t n, uint8_t* out) {
+    kernels().resample_rows(rows, weights, taps, n, out);
+}
+
+void resample_pixels(const uint8_t* row, size_t row_bytes, int channels, const int* start, const int* count,
+                     const int16_t* weights, int max_taps, size_t n, uint8_t* out) {
+    kernels().resample_pixels(row, row_bytes, channels, start, count, weights, max_taps, n, out);
+}
+
+void pack_braille(const uint8_t* const* rows, size_t n, uint8_t* out) {
+    kernels().pack_braille(rows, n, out);
+}
+
+} // namespace simd
+} // namespace ascii_art
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace ascii_art {
+namespace simd {
+
+// Per-pixel conversion kernels over flat arrays. The best variant for the
+// running CPU (AVX2, SSE4.1, plain C++) is picked once on first use, and all
+// variants give the same results
+enum class Level : uint8_t { SCALAR, SSE41, AVX2 };
+
+Level level();
+const char* level_name();
+
+// Luminance is quantized to steps 0..LUMA_LEVELS (white is LUMA_LEVELS itself):
+// Rec.601 weights in 2.14 fixed point, shifted down by 10. A tone LUT of
+// TONE_LUT_SIZE entries maps a step to a glyph
+constexpr int LUMA_LEVELS = 4080;
+constexpr size_t TONE_LUT_SIZE = 4096;
+
+// Glyph (lut[luma step]) and packed 0xRRGGBB color of n interleaved pixels.
+// channels is 1 (gray, color is the gray level), 3 or 4 (alpha ignored)
+void classify(const uint8_t* src, int channels, size_t n, const uint8_t* lut, uint8_t* glyph, uint32_t* color);
+
+// Same, but through a LUT of glyph levels in 8.8 fixed point, for dithering
+void classify_levels(const uint8_t* src, int channels, size_t n, const uint16_t* lut, uint16_t* level, uint32_t* color);
+
+// Luminance -> glyph index: contrast and brightness, clamp, smoothstep, then
+// scaled to [0, levels - 1]. levels is 1..256
+void tone_to_glyph(const float* lum, size_t n, float contrast, float brightness, int levels, uint8_t* glyph);
+// The same curve without the final truncation: glyph level * 256
+void tone_to_level(const float* lum, size_t n, float contrast, float brightness, int levels, uint16_t* level);
+
+// Ordered dithering of one row: glyph[x] = min((level[x] + threshold[x % 4]) >> 8,
+// max_glyph), threshold in 1/256 glyph steps
+void dither_ordered(const uint16_t* level, size_t n, const uint16_t* threshold, int max_glyph, uint8_t* glyph);
+
+// One output row of a vertical resampling pass: out[x] is the sum of
+// weights[k] * rows[k][x] over the taps, weights in 2.14 fixed point (they
+// sum to 1 << 14, and may be negative), rounded and clamped to 0..255
+void resample_rows(const uint8_t* const* rows, const int16_t* weights, int taps, size_t n, uint8_t* out);
+
+// One output row of a horizontal resampling pass over a row of interleaved
+// pixels (row_bytes long): channel c of output pixel x is the sum of
+// weights[x * max_taps + k] * row[(start[x] + k) * channels + c] for k below
+// count[x], in 2.14 fixed point, rounded and clamped. channels is 1 to 4.
+// Each pixel's weights are padded with zeros up to max_taps, the kernels may
+// run over those in whole vector steps
+void resample_pixels(const uint8_t* row, size_t row_bytes, int channels, const int* start, const int* count,
+                     const int16_t* weights, int max_taps, size_t n, uint8_t* out);
+
+// Braille patterns of n cells from 4 rows of 2n dots (each 0 or 1): the
+// Unicode dot bits, 0x01-0x04 down the left column, 0x08-0x20 down the right,
+// 0x40 and 0x80 for the bottom pair
+void pack_braille(const uint8_t* const* rows, size_t n, uint8_t* out);
+
+} // namespace simd
+} // namespace ascii_art
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace nightforge {
+
+// Lock-free triple buffer for handing finished frames from one producer thread
+// to one consumer thread. The producer always has a slot to write into and the
+// consumer always gets the newest published frame, older ones are dropped.
+// Neither side ever waits on the other
+template <typename T>
+class FrameMailbox {
+public:
+    // Producer side: fill write_slot(), then publish() it
+    T& write_slot() { return slots_[back_]; }
+    void publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+    }
+    
+    // Consumer side: take the newest frame if one came in since the last call.
+    // read_slot() stays valid (and unchanged) until the next successful acquire
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+        return true;
+    }
+    const T& read_slot() const { return slots_[front_]; }
+    
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4; // middle slot holds a frame the consumer hasn't seen
+    
+    T slots_[3];
+    uint8_t back_ = 0;                 // producer only
+    uint8_t front_ = 1;                // consumer only
+    std::atomic<uint8_t> middle_{2};   // the one being handed over
+};
+
+} // namespace nightforge
@@ -0,0 +1,101 @@
+#include "render_thread.h"
+#include "../core/terminal.h"
+#include <algorithm>
+#include <chrono>
+
+namespace nightforge {
+
+RenderThread::RenderThread(Terminal& terminal) : terminal_(terminal) {
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::start(int frame_interval_ms) {
+    if (running_.load()) return;
+    frame_interval_ms_ = frame_interval_ms > 0 ? frame_interval_ms : 1;
+    running_.store(true);
+    thread_ = std::thread(&RenderThread::loop, this);
+}
+
+void RenderThread::stop() {
+    if (!running_.exchange(false)) return;
+    wake();
+    if (thread_.joinable()) thread_.join();
+}
+
+void RenderThread::publish(const Grid& grid) {
+    Frame& frame = mailbox_.write_slot();
+    frame.width = grid.width();
+    frame.height = grid.height();
+    frame.cells = grid.cells(); // same size as last time reuses the slot's storage
+    mailbox_.publish();
+    wake();
+}
+
+void RenderThread::pause() {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    paused_ = true;
+}
+
+void RenderThread::resume() {
+    {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        paused_ = false;
+        redraw_ = true;
+    }
+    wake();
+}
+
+void RenderThread::wake() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_pending_ = true;
+    }
+    wake_.notify_one();
+}
+
+void RenderThread::loop() {
+    auto interval = std::chrono::milliseconds(frame_interval_ms_);
+    auto next = std::chrono::steady_clock::now();
+    
+    while (running_.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait(lock, [this] { return wake_pending_; });
+            wake_pending_ = false;
+        }
+        present_latest();
+        
+        // At most one present per interval, the first one after a quiet spell goes out right away
+        auto now = std::chrono::steady_clock::now();
+        next = std::max(next + interval, now);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void RenderThread::present_latest() {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if (paused_) return;
+    
+    bool fresh = mailbox_.acquire();
+    if (!fresh && !redraw_) return;
+    
+    const Frame& frame = mailbox_.read_slot();
+    if (frame.width <= 0 || frame.height <= 0) return;
+    
+    if (!presented_) {
+        presented_ = std::make_unique<Grid>(frame.width, frame.height); // starts with a full redraw
+    } else if (presented_->width() != frame.width || presented_->height() != frame.height) {
+        presented_->resize(frame.width, frame.height);
+    } else if (redraw_) {
+        presented_->invalidate();
+    }
+    redraw_ = false;
+    
+    presented_->load(frame.cells);
+    presented_->render_to_terminal(terminal_);
+}
+
+} // namespace nightforge
@@ -0,0 +1,62 @@
+#pragma once
+#include "frame_mailbox.h"
+#include "tui_renderer.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace nightforge {
+
+class Terminal;
+
+// Presents grids on its own thread so slow terminal output (SSH, big frames)
+// never blocks the game loop, and a busy game loop never stops output.
+// The game thread publishes finished grids, the render thread writes the
+// newest one at most once per frame interval and sleeps while nothing is published
+class RenderThread {
+public:
+    explicit RenderThread(Terminal& terminal);
+    ~RenderThread();
+    
+    void start(int frame_interval_ms = 16);
+    void stop();
+    
+    // Game thread: snapshot a finished grid, never waits on output
+    void publish(const Grid& grid);
+    
+    // Game thread: stop presenting so the terminal can be written directly.
+    // Waits for a frame that's mid-write to finish
+    void pause();
+    // Start presenting again, the screen is assumed wiped so the next frame is drawn in full
+    void resume();
+    
+private:
+    struct Frame {
+        int width = 0;
+        int height = 0;
+        CellPlanes cells;
+    };
+    
+    Terminal& terminal_;
+    FrameMailbox<Frame> mailbox_;
+    std::unique_ptr<Grid> presented_; // render thread only, diffed against the terminal
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    int frame_interval_ms_ = 16;
+    
+    std::mutex output_mutex_; // held while writing a frame and while pausing
+    bool paused_ = false;     // guarded by output_mutex_
+    bool redraw_ = false;     // guarded by output_mutex_
+    
+    std::mutex wake_mutex_;   // only ever held for a flag flip, never during output
+    std::condition_variable wake_;
+    bool wake_pending_ = false; // guarded by wake_mutex_
+    
+    void wake();
+    void loop();
+    void present_latest();
+};
+
+} // namespace nightforge
@@ -1,75 +1,213 @@
 #include "tui_renderer.h"
+#include "../core/terminal.h"
 #include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <cstdio>
+#include <cstring>
 
 // custom renderer instead of using ncurses for more control (also no dependencies yayyyy (lua has done irreversible damage))
 
 namespace nightforge {
 
 Grid::Grid(int width, int height) : width_(width), height_(height) {
-    cells_.resize(width * height);
+    back_.resize(static_cast<size_t>(width) * height);
+    front_.resize(static_cast<size_t>(width) * height);
+    dirty_.resize(height);
+    mark_all_dirty();
+    // Room for a full plain frame plus some color changes, grows if a frame needs more
+    frame_.resize(static_cast<size_t>(width) * height * 2 + static_cast<size_t>(height) * 16 + 64);
+}
+
+template <typename T>
+static void reshape_plane(std::vector<T>& plane, int old_width, int old_height, int width, int height, T blank) {
+    int rows = std::min(old_height, height);
+    int cols = std::min(old_width, width);
+    size_t size = static_cast<size_t>(width) * height;
+    
+    // Rows move toward the start when the grid narrows and toward the end when
+    // it widens, walk them in the order that never overwrites an unmoved row
+    if (width <= old_width) {
+        for (int y = 1; y < rows; ++y) {
+            std::memmove(&plane[static_cast<size_t>(y) * width], &plane[static_cast<size_t>(y) * old_width], cols * sizeof(T));
+        }
+        plane.resize(size, blank);
+    } else {
+        plane.resize(size, blank);
+        for (int y = rows - 1; y >= 1; --y) {
+            std::memmove(&plane[static_cast<size_t>(y) * width], &plane[static_cast<size_t>(y) * old_width], cols * sizeof(T));
+        }
+    }
+    
+    for (int y = 0; y < rows; ++y) {
+        std::fill(plane.begin() + static_cast<size_t>(y) * width + cols, plane.begin() + static_cast<size_t>(y + 1) * width, blank);
+    }
+    std::fill(plane.begin() + static_cast<size_t>(rows) * width, plane.end(), blank);
+}
+
+void CellPlanes::reshape(int old_width, int old_height, int width, int height) {
+    reshape_plane<uint32_t>(glyph, old_width, old_height, width, height, ' ');
+    reshape_plane<uint32_t>(fg, old_width, old_height, width, height, DEFAULT_COLOR);
+    reshape_plane<uint32_t>(bg, old_width, old_height, width, height, DEFAULT_COLOR);
+    reshape_plane<uint8_t>(attrs, old_width, old_height, width, height, ATTR_NONE);
+}
+
+void Grid::resize(int width, int height) {
+    if (width == width_ && height == height_) return;
+    back_.reshape(width_, height_, width, height);
+    front_.reshape(width_, height_, width, height);
+    width_ = width;
+    height_ = height;
+    dirty_.resize(height);
+    // The terminal reflowed whatever it showed, so nothing on screen can be trusted
+    invalidate();
 }
 
 void Grid::clear() {
-    for (auto& cell : cells_) {
-        cell.character = ' ';
-        cell.has_color = false;
-        cell.fg_r = cell.fg_g = cell.fg_b = 255;
+    back_.fill(0, back_.glyph.size(), ' ', Style());
+    mark_all_dirty();
+}
+
+void Grid::mark_all_dirty() {
+    for (auto& d : dirty_) {
+        d.min_x = 0;
+        d.max_x = width_ - 1;
     }
 }
 
-Grid::Cell& Grid::get_cell(int x, int y) {
-    return cells_[y * width_ + x];
+void Grid::invalidate() {
+    full_redraw_ = true;
+    mark_all_dirty();
 }
 
-const Grid::Cell& Grid::get_cell(int x, int y) const {
-    return cells_[y * width_ + x];
+void Grid::load(const CellPlanes& cells) {
+    if (cells.glyph.size() != back_.glyph.size()) return;
+    back_.copy(0, cells, 0, back_.glyph.size());
+    mark_all_dirty();
 }
 
 bool Grid::is_valid_pos(int x, int y) const {
     return x >= 0 && x < width_ && y >= 0 && y < height_;
 }
 
-void Grid::set_char(int x, int y, char c) {
+void Grid::set_cell(int x, int y, uint32_t codepoint, const Style& style) {
     if (is_valid_pos(x, y)) {
-        get_cell(x, y).character = c;
+        size_t i = y * width_ + x;
+        back_.glyph[i] = codepoint;
+        back_.fg[i] = style.fg;
+        back_.bg[i] = style.bg;
+        back_.attrs[i] = style.attrs;
+        mark_dirty(y, x, x);
     }
 }
 
+void Grid::set_char(int x, int y, char c) {
+    set_cell(x, y, static_cast<unsigned char>(c));
+}
+
 void Grid::set_char_with_color(int x, int y, char c, uint8_t fg_r, uint8_t fg_g, uint8_t fg_b) {
-    if (is_valid_pos(x, y)) {
-        auto& cell = get_cell(x, y);
-        cell.character = c;
-        cell.has_color = true;
-        cell.fg_r = fg_r;
-        cell.fg_g = fg_g;
-        cell.fg_b = fg_b;
+    set_cell(x, y, static_cast<unsigned char>(c), Style(rgb(fg_r, fg_g, fg_b)));
+}
+
+void Grid::fill_rect(int x, int y, int width, int height, uint32_t codepoint, const Style& style) {
+    int x0 = std::max(x, 0), x1 = std::min(x + width, width_);
+    int y0 = std::max(y, 0), y1 = std::min(y + height, height_);
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    for (int row = y0; row < y1; ++row) {
+        back_.fill(static_cast<size_t>(row) * width_ + x0, x1 - x0, codepoint, style);
+        mark_dirty(row, x0, x1 - 1);
     }
 }
 
-void Grid::draw_text(int x, int y, const std::string& text) {
-    for (size_t i = 0; i < text.length() && x + i < static_cast<size_t>(width_); ++i) {
-        set_char(x + i, y, text[i]);
+void Grid::blit(const Grid& src, int src_x, int src_y, int width, int height, int dst_x, int dst_y) {
+    // Clip against both grids, shifting the other side along with it
+    if (src_x < 0) { width += src_x; dst_x -= src_x; src_x = 0; }
+    if (src_y < 0) { height += src_y; dst_y -= src_y; src_y = 0; }
+    if (dst_x < 0) { width += dst_x; src_x -= dst_x; dst_x = 0; }
+    if (dst_y < 0) { height += dst_y; src_y -= dst_y; dst_y = 0; }
+    width = std::min({width, src.width_ - src_x, width_ - dst_x});
+    height = std::min({height, src.height_ - src_y, height_ - dst_y});
+    if (width <= 0 || height <= 0) return;
+    
+    // Blitting a grid onto itself downwards has to go bottom-up
+    bool reverse = (&src == this && dst_y > src_y);
+    for (int r = 0; r < height; ++r) {
+        int row = reverse ? height - 1 - r : r;
+        back_.copy(static_cast<size_t>(dst_y + row) * width_ + dst_x, src.back_,
+                   static_cast<size_t>(src_y + row) * src.width_ + src_x, width);
+        mark_dirty(dst_y + row, dst_x, dst_x + width - 1);
+    }
+}
+
+// Decodes one UTF-8 sequence and advances s, malformed bytes come out as U+FFFD
+static uint32_t next_codepoint(const unsigned char*& s, const unsigned char* end) {
+    unsigned char lead = *s++;
+    if (lead < 0x80) return lead;
+    
+    int extra;
+    uint32_t cp;
+    if ((lead & 0xE0) == 0xC0) { extra = 1; cp = lead & 0x1F; }
+    else if ((lead & 0xF0) == 0xE0) { extra = 2; cp = lead & 0x0F; }
+    else if ((lead & 0xF8) == 0xF0) { extra = 3; cp = lead & 0x07; }
+    else return 0xFFFD;
+    
+    if (end - s < extra) return 0xFFFD;
+    for (int i = 0; i < extra; ++i) {
+        if ((s[i] & 0xC0) != 0x80) return 0xFFFD;
+        cp = (cp << 6) | (s[i] & 0x3F);
     }
+    s += extra;
+    return cp;
 }
 
-void Grid::draw_text_centered(int y, const std::string& text) {
-    int start_x = std::max(0, (width_ - static_cast<int>(text.length())) / 2);
-    draw_text(start_x, y, text);
+uint32_t first_codepoint(const std::string& utf8) {
+    if (utf8.empty()) return ' ';
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(utf8.data());
+    return next_codepoint(s, s + utf8.size());
 }
 
-void Grid::draw_box(int x, int y, int width, int height, char border_char) {
-    // Draw borders
-    for (int i = 0; i < width; ++i) {
-        set_char(x + i, y, border_char);                    // Top
-        set_char(x + i, y + height - 1, border_char);       // Bottom
+static int utf8_length(const std::string& text) {
+    int n = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) ++n;
     }
-    for (int i = 0; i < height; ++i) {
-        set_char(x, y + i, border_char);                    // Left
-        set_char(x + width - 1, y + i, border_char);        // Right
+    return n;
+}
+
+void Grid::draw_text(int x, int y, const std::string& text, const Style& style) {
+    if (y < 0 || y >= height_ || x >= width_ || text.empty()) return;
+    
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = s + text.size();
+    while (x < 0 && s < end) {
+        next_codepoint(s, end);
+        ++x;
+    }
+    
+    size_t row = static_cast<size_t>(y) * width_;
+    int col = x;
+    while (s < end && col < width_) {
+        back_.glyph[row + col++] = next_codepoint(s, end);
     }
+    if (col == x) return;
+    
+    back_.fill_style(row + x, col - x, style);
+    mark_dirty(y, x, col - 1);
+}
+
+void Grid::draw_text_centered(int y, const std::string& text, const Style& style) {
+    int start_x = std::max(0, (width_ - utf8_length(text)) / 2);
+    draw_text(start_x, y, text, style);
+}
+
+void Grid::draw_box(int x, int y, int width, int height, char border_char, const Style& style) {
+    if (width <= 0 || height <= 0) return;
+    uint32_t c = static_cast<unsigned char>(border_char);
+    fill_rect(x, y, width, 1, c, style);                        // Top
+    fill_rect(x, y + height - 1, width, 1, c, style);           // Bottom
+    fill_rect(x, y + 1, 1, height - 2, c, style);               // Left
+    fill_rect(x + width - 1, y + 1, 1, height - 2, c, style);   // Right
 }
 
 void Grid::draw_ascii_art(int x, int y, const std::string& ascii_art, bool center) {
@@ -78,88 +216,354 @@ void Grid::draw_ascii_art(int x, int y, const std::string& ascii_art, bool cente
     int current_y = y;
     
     while (std::getline(stream, line) && current_y < height_) {
-        int start_x = center ? std::max(0, (width_ - static_cast<int>(line.length())) / 2) : x;
+        int start_x = center ? std::max(0, (width_ - utf8_length(line)) / 2) : x;
         draw_text(start_x, current_y, line);
         ++current_y;
     }
 }
 
-void Grid::render_to_terminal() {
-    // Position cursor at top-left
-    printf("\033[H");
+// Unchanged cells shorter than this between two changed runs get rewritten
+// instead of skipped, a cursor move costs more than a few plain characters
+static constexpr int RUN_MERGE_GAP = 6;
+
+// Worst cases for sizing the frame buffer: an SGR with a reset, every attribute
+// and both truecolors plus a 4-byte glyph, and ESC[row;colH with two full ints
+static constexpr size_t MAX_CELL_BYTES = 56;
+static constexpr size_t MAX_MOVE_BYTES = 24;
+static constexpr size_t RESET_BYTES = 4;
+
+// 0..255 as ASCII so SGR parameters don't go through snprintf
+struct DecimalTable {
+    char text[256][3];
+    uint8_t length[256];
+};
+
+static constexpr DecimalTable make_decimal_table() {
+    DecimalTable t{};
+    for (int i = 0; i < 256; ++i) {
+        int n = 0;
+        if (i >= 100) t.text[i][n++] = static_cast<char>('0' + i / 100);
+        if (i >= 10) t.text[i][n++] = static_cast<char>('0' + i / 10 % 10);
+        t.text[i][n++] = static_cast<char>('0' + i % 10);
+        t.length[i] = static_cast<uint8_t>(n);
+    }
+    return t;
+}
+
+static constexpr DecimalTable DECIMAL = make_decimal_table();
+
+static inline char* put_u8(char* p, uint8_t v) {
+    std::memcpy(p, DECIMAL.text[v], 3); // always room for 3, advance by the real length
+    return p + DECIMAL.length[v];
+}
+
+static inline char* put_uint(char* p, unsigned v) {
+    if (v < 256) return put_u8(p, static_cast<uint8_t>(v));
+    char tmp[10];
+    int n = 0;
+    while (v) { tmp[n++] = static_cast<char>('0' + v % 10); v /= 10; }
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+template <size_t N>
+static inline char* put_str(char* p, const char (&s)[N]) {
+    std::memcpy(p, s, N - 1);
+    return p + N - 1;
+}
+
+static inline char* put_utf8(char* p, uint32_t cp) {
+    if (cp < 0x80) {
+        *p++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *p++ = static_cast<char>(0xC0 | (cp >> 6));
+        *p++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *p++ = static_cast<char>(0xE0 | (cp >> 12));
+        *p++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *p++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *p++ = static_cast<char>(0xF0 | ((cp >> 18) & 0x07));
+        *p++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *p++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *p++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return p;
+}
+
+static inline char* put_color(char* p, uint32_t color) {
+    p = put_u8(p, static_cast<uint8_t>(color >> 16));
+    *p++ = ';';
+    p = put_u8(p, static_cast<uint8_t>(color >> 8));
+    *p++ = ';';
+    p = put_u8(p, static_cast<uint8_t>(color));
+    *p++ = ';';
+    return p;
+}
+
+// One SGR sequence taking the terminal from pen to want (they must differ)
+static char* put_style(char* p, Style& pen, const Style& want) {
+    p = put_str(p, "\033[");
+    if (pen.attrs & ~want.attrs) {
+        // No cheap per-attribute off that works everywhere, reset and rebuild
+        p = put_str(p, "0;");
+        pen = Style();
+    }
+    uint8_t added = want.attrs & ~pen.attrs;
+    if (added & ATTR_BOLD) p = put_str(p, "1;");
+    if (added & ATTR_DIM) p = put_str(p, "2;");
+    if (added & ATTR_ITALIC) p = put_str(p, "3;");
+    if (added & ATTR_UNDERLINE) p = put_str(p, "4;");
+    if (added & ATTR_REVERSE) p = put_str(p, "7;");
+    if (want.fg != pen.fg) {
+        if (want.fg == DEFAULT_COLOR) {
+            p = put_str(p, "39;");
+        } else {
+            p = put_str(p, "38;2;");
+            p = put_color(p, want.fg);
+        }
+    }
+    if (want.bg != pen.bg) {
+        if (want.bg == DEFAULT_COLOR) {
+            p = put_str(p, "49;");
+        } else {
+            p = put_str(p, "48;2;");
+            p = put_color(p, want.bg);
+        }
+    }
+    p[-1] = 'm'; // last parameter's ';'
+    pen = want;
+    return p;
+}
+
+char* Grid::frame_reserve(size_t bytes) {
+    if (frame_size_ + bytes > frame_.size()) {
+        frame_.resize(std::max(frame_.size() * 2, frame_size_ + bytes));
+    }
+    return frame_.data() + frame_size_;
+}
+
+void Grid::emit_cells(int y, int x0, int x1, int& cursor_x, int& cursor_y, Style& pen) {
+    char* p = frame_reserve(static_cast<size_t>(x1 - x0 + 1) * MAX_CELL_BYTES + MAX_MOVE_BYTES);
+    
+    if (cursor_y != y || cursor_x != x0) {
+        p = put_str(p, "\033[");
+        p = put_uint(p, static_cast<unsigned>(y + 1));
+        *p++ = ';';
+        p = put_uint(p, static_cast<unsigned>(x0 + 1));
+        *p++ = 'H';
+    }
+    
+    size_t row = static_cast<size_t>(y) * width_;
+    for (size_t i = row + x0; i <= row + x1; ++i) {
+        if (back_.fg[i] != pen.fg || back_.bg[i] != pen.bg || back_.attrs[i] != pen.attrs) {
+            p = put_style(p, pen, Style(back_.fg[i], back_.bg[i], back_.attrs[i]));
+        }
+        p = put_utf8(p, back_.glyph[i]);
+    }
     
-    std::string last_color_code;
+    frame_size_ = static_cast<size_t>(p - frame_.data());
+    cursor_x = x1 + 1;
+    cursor_y = y;
+}
+
+bool Grid::compose_frame() {
+    frame_size_ = 0;
+    
+    int cursor_x = -1, cursor_y = -1; // unknown until the first move
+    Style pen;                        // active SGR state, frames start at the defaults
     
     for (int y = 0; y < height_; ++y) {
-        for (int x = 0; x < width_; ++x) {
-            const auto& cell = get_cell(x, y);
-            
-            if (cell.has_color) {
-                // Create color escape code
-                char color_code[32];
-                snprintf(color_code, sizeof(color_code), "\033[38;2;%d;%d;%dm", 
-                        cell.fg_r, cell.fg_g, cell.fg_b);
-                
-                if (last_color_code != color_code) {
-                    printf("%s", color_code);
-                    last_color_code = color_code;
+        DirtySpan& span = dirty_[y];
+        if (span.min_x > span.max_x) continue;
+        
+        size_t row = static_cast<size_t>(y) * width_;
+        
+        if (full_redraw_) {
+            emit_cells(y, 0, width_ - 1, cursor_x, cursor_y, pen);
+        } else {
+            int x = span.min_x;
+            while (x <= span.max_x) {
+                if (!differs(row + x)) {
+                    ++x;
+                    continue;
                 }
-            } else if (!last_color_code.empty()) {
-                // Reset to default color
-                printf("\033[39m");
-                last_color_code.clear();
+                // Grow the run over short stretches of unchanged cells
+                int run_end = x;
+                for (int probe = x + 1; probe <= span.max_x && probe - run_end <= RUN_MERGE_GAP; ++probe) {
+                    if (differs(row + probe)) run_end = probe;
+                }
+                emit_cells(y, x, run_end, cursor_x, cursor_y, pen);
+                x = run_end + 1;
             }
-            
-            putchar(cell.character);
-        }
-        if (y < height_ - 1) {
-            putchar('\n');
         }
+        
+        front_.copy(row + span.min_x, back_, row + span.min_x, span.max_x - span.min_x + 1);
+        span.min_x = width_;
+        span.max_x = -1;
     }
+    full_redraw_ = false;
     
-    // Reset color at end
-    if (!last_color_code.empty()) {
-        printf("\033[39m");
+    if (frame_size_ == 0) return false;
+    if (pen != Style()) {
+        char* p = frame_reserve(RESET_BYTES);
+        p = put_str(p, "\033[0m");
+        frame_size_ = static_cast<size_t>(p - frame_.data());
+    }
+    return true;
+}
+
+void Grid::render_to_terminal(Terminal& terminal) {
+    if (compose_frame()) {
+        terminal.write_output(frame_.data(), frame_size_);
     }
-    
-    fflush(stdout);
 }
 
 // TUIRenderer implementation
 TUIRenderer::TUIRenderer(int width, int height) 
     : grid_(width, height), width_(width), height_(height) {
+    create_layers();
+}
+
+void TUIRenderer::create_layers() {
+    layers_.clear();
+    layers_.reserve(static_cast<size_t>(LayerId::COUNT));
+    z_order_.clear();
+    for (int i = 0; i < static_cast<int>(LayerId::COUNT); ++i) {
+        layers_.emplace_back(width_, height_);
+        layers_.back().z = i * 10;
+    }
+    for (auto& layer : layers_) z_order_.push_back(&layer);
+    composite_dirty_ = true;
 }
 
 void TUIRenderer::resize(int width, int height) {
+    if (width == width_ && height == height_) return;
     width_ = width;
     height_ = height;
-    grid_ = Grid(width, height);
+    grid_.resize(width, height);
+    for (auto& layer : layers_) {
+        layer.grid.resize(width, height);
+        if (layer.follows_size) layer.dirty = true;
+    }
+    composite_dirty_ = true;
 }
 
 void TUIRenderer::clear() {
-    grid_.clear();
+    for (auto& layer : layers_) {
+        layer.submitted = false;
+    }
+}
+
+void TUIRenderer::render(Terminal& terminal) {
+    compose();
+    grid_.render_to_terminal(terminal);
+}
+
+void TUIRenderer::invalidate() {
+    grid_.invalidate();
+}
+
+void TUIRenderer::set_layer_z(LayerId id, int z) {
+    Layer& layer = layers_[static_cast<size_t>(id)];
+    if (layer.z == z) return;
+    layer.z = z;
+    std::stable_sort(z_order_.begin(), z_order_.end(),
+                     [](const Layer* a, const Layer* b) { return a->z < b->z; });
+    composite_dirty_ = true;
+}
+
+void TUIRenderer::invalidate_layer(LayerId id) {
+    layers_[static_cast<size_t>(id)].dirty = true;
+}
+
+TUIRenderer::Layer* TUIRenderer::begin_layer(LayerId id, std::string key, int x, int y, int width, int height) {
+    Layer& layer = layers_[static_cast<size_t>(id)];
+    layer.submitted = true;
+    
+    bool moved = layer.x != x || layer.y != y || layer.width != width || layer.height != height;
+    if (!layer.visible || moved) {
+        layer.visible = true;
+        layer.x = x;
+        layer.y = y;
+        layer.width = width;
+        layer.height = height;
+        composite_dirty_ = true;
+    }
+    
+    if (!layer.dirty && !moved && layer.key == key) return nullptr;
+    
+    layer.key = std::move(key);
+    layer.dirty = false;
+    layer.grid.clear();
+    composite_dirty_ = true;
+    return &layer;
 }
 
-void TUIRenderer::render() {
-    grid_.render_to_terminal();
+bool TUIRenderer::compose() {
+    for (auto& layer : layers_) {
+        if (layer.visible && !layer.submitted) {
+            layer.visible = false;
+            composite_dirty_ = true;
+        }
+    }
+    if (!composite_dirty_) return false;
+    
+    // Rebuilding the whole output is just row copies, the diff in
+    // compose_frame keeps what reaches the terminal down to real changes
+    grid_.clear();
+    for (Layer* layer : z_order_) {
+        if (!layer->visible) continue;
+        grid_.blit(layer->grid, layer->x, layer->y, layer->width, layer->height, layer->x, layer->y);
+    }
+    composite_dirty_ = false;
+    return true;
 }
 
 void TUIRenderer::draw_background(const std::string& ascii_art) {
-    grid_.draw_ascii_art(0, 0, ascii_art, true);
+    Layer* layer = begin_layer(LayerId::BACKGROUND, ascii_art, 0, 0, width_, height_);
+    if (!layer) return;
+    layer->grid.draw_ascii_art(0, 0, ascii_art, true);
+}
+
+void TUIRenderer::draw_background_cells(const std::string& key, int cols, int rows, const uint8_t* glyphs,
+                                        const uint32_t* colors, const std::vector<std::string>& charset) {
+    Layer* layer = begin_layer(LayerId::BACKGROUND, key, 0, 0, width_, height_);
+    if (!layer) return;
+    
+    std::vector<uint32_t> codepoints;
+    for (const auto& glyph : charset) codepoints.push_back(first_codepoint(glyph));
+    
+    int left = std::max(0, (width_ - cols) / 2);
+    for (int y = 0; y < std::min(rows, height_); ++y) {
+        for (int x = 0; x < cols && left + x < width_; ++x) {
+            size_t i = static_cast<size_t>(y) * cols + x;
+            layer->grid.set_cell(left + x, y, codepoints[glyphs[i]], Style(colors ? colors[i] : DEFAULT_COLOR));
+        }
+    }
+}
+
+void TUIRenderer::draw_background_runs(const std::string& key, int cols, int rows, const std::vector<CellRun>& runs) {
+    Layer* layer = begin_layer(LayerId::BACKGROUND, key, 0, 0, width_, height_);
+    if (!layer) return;
+    
+    int left = std::max(0, (width_ - cols) / 2);
+    for (const CellRun& run : runs) {
+        if (run.y >= std::min(rows, height_)) break; // row-major, the rest is off screen
+        layer->grid.fill_rect(left + run.x, run.y, std::min<int>(run.length, cols - run.x), 1, run.codepoint,
+                              Style(run.fg, run.bg));
+    }
 }
 
 void TUIRenderer::draw_dialog_box(const std::string& text, int dialog_height) {
     int dialog_y = height_ - dialog_height;
     int dialog_width = width_ - (DIALOG_MARGIN * 2);
     
-    // Draw dialog box background and border
-    for (int y = dialog_y; y < height_; ++y) {
-        for (int x = DIALOG_MARGIN; x < width_ - DIALOG_MARGIN; ++x) {
-            grid_.set_char(x, y, ' ');
-        }
-    }
+    Layer* layer = begin_layer(LayerId::DIALOG, text, DIALOG_MARGIN, dialog_y, dialog_width, dialog_height);
+    if (!layer) return;
+    Grid& grid = layer->grid;
     
-    grid_.draw_box(DIALOG_MARGIN, dialog_y, dialog_width, dialog_height, '#');
+    grid.draw_box(DIALOG_MARGIN, dialog_y, dialog_width, dialog_height, '#');
     
     std::istringstream words(text);
     std::string word;
@@ -174,7 +578,7 @@ void TUIRenderer::draw_dialog_box(const std::string& text, int dialog_height) {
             current_line += " " + word;
         } else {
             // Draw current line and start new one
-            grid_.draw_text(DIALOG_MARGIN + 2, line_y, current_line);
+            grid.draw_text(DIALOG_MARGIN + 2, line_y, current_line);
             current_line = word;
             ++line_y;
         }
@@ -182,7 +586,7 @@ void TUIRenderer::draw_dialog_box(const std::string& text, int dialog_height) {
     
     // Draw last line
     if (!current_line.empty() && line_y < height_ - 1) {
-        grid_.draw_text(DIALOG_MARGIN + 2, line_y, current_line);
+        grid.draw_text(DIALOG_MARGIN + 2, line_y, current_line);
     }
 }
 
@@ -191,36 +595,39 @@ void TUIRenderer::draw_choices(const std::vector<std::string>& choices, int sele
     int dialog_y = height_ - dialog_height;
     int dialog_width = width_ - (DIALOG_MARGIN * 2);
     
-    // Clear and draw choice box
-    for (int y = dialog_y; y < height_; ++y) {
-        for (int x = DIALOG_MARGIN; x < width_ - DIALOG_MARGIN; ++x) {
-            grid_.set_char(x, y, ' ');
-        }
+    std::string key = std::to_string(selected_index);
+    for (const auto& choice : choices) {
+        key += '\n';
+        key += choice;
     }
+    Layer* layer = begin_layer(LayerId::CHOICES, std::move(key), DIALOG_MARGIN, dialog_y, dialog_width, dialog_height);
+    if (!layer) return;
+    Grid& grid = layer->grid;
     
-    grid_.draw_box(DIALOG_MARGIN, dialog_y, dialog_width, dialog_height, '#');
+    grid.draw_box(DIALOG_MARGIN, dialog_y, dialog_width, dialog_height, '#');
     
     // Draw choices
     for (size_t i = 0; i < choices.size() && dialog_y + 1 + i < static_cast<size_t>(height_ - 1); ++i) {
         char prefix = (static_cast<int>(i) == selected_index) ? '>' : ' ';
         std::string choice_text = std::string(1, prefix) + " " + choices[i];
-        grid_.draw_text(DIALOG_MARGIN + 2, dialog_y + 1 + i, choice_text);
+        grid.draw_text(DIALOG_MARGIN + 2, dialog_y + 1 + i, choice_text);
     }
 }
 
 void TUIRenderer::draw_status_bar(const std::string& scene_name, bool has_memory_indicator) {
-    // Clear status bar
-    for (int x = 0; x < width_; ++x) {
-        grid_.set_char(x, 0, ' ');
-    }
+    std::string key = scene_name;
+    key += has_memory_indicator ? "\n1" : "\n0";
+    Layer* layer = begin_layer(LayerId::STATUS_BAR, std::move(key), 0, 0, width_, STATUS_BAR_HEIGHT);
+    if (!layer) return;
+    Grid& grid = layer->grid;
     
     // Draw scene name on left
-    grid_.draw_text(1, 0, scene_name);
+    grid.draw_text(1, 0, scene_name);
     
     // Draw memory indicator on right
     if (has_memory_indicator) {
         std::string indicator = "[MEMORY]";
-        grid_.draw_text(width_ - indicator.length() - 1, 0, indicator);
+        grid.draw_text(width_ - indicator.length() - 1, 0, indicator);
     }
 }
 
@@ -230,22 +637,25 @@ void TUIRenderer::draw_clue_panel(const std::vector<std::string>& clues, bool vi
     int panel_x = width_ - CLUE_PANEL_WIDTH;
     int panel_height = height_ - STATUS_BAR_HEIGHT;
     
-    for (int y = STATUS_BAR_HEIGHT; y < height_; ++y) {
-        for (int x = panel_x; x < width_; ++x) {
-            grid_.set_char(x, y, ' ');
-        }
+    std::string key;
+    for (const auto& clue : clues) {
+        key += clue;
+        key += '\n';
     }
+    Layer* layer = begin_layer(LayerId::CLUE_PANEL, std::move(key), panel_x, STATUS_BAR_HEIGHT, CLUE_PANEL_WIDTH, panel_height);
+    if (!layer) return;
+    Grid& grid = layer->grid;
     
-    grid_.draw_box(panel_x, STATUS_BAR_HEIGHT, CLUE_PANEL_WIDTH, panel_height, '|');
+    grid.draw_box(panel_x, STATUS_BAR_HEIGHT, CLUE_PANEL_WIDTH, panel_height, '|');
     
-    grid_.draw_text(panel_x + 2, STATUS_BAR_HEIGHT + 1, "CLUES");
+    grid.draw_text(panel_x + 2, STATUS_BAR_HEIGHT + 1, "CLUES");
     
     for (size_t i = 0; i < clues.size() && i < static_cast<size_t>(panel_height - 4); ++i) {
         std::string clue_text = "- " + clues[i];
         if (clue_text.length() > CLUE_PANEL_WIDTH - 4) {
             clue_text = clue_text.substr(0, CLUE_PANEL_WIDTH - 4);
         }
-        grid_.draw_text(panel_x + 2, STATUS_BAR_HEIGHT + 3 + i, clue_text);
+        grid.draw_text(panel_x + 2, STATUS_BAR_HEIGHT + 3 + i, clue_text);
     }
 }
 
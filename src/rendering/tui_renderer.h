@@ -3,68 +3,241 @@
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 namespace nightforge {
 
+class Terminal;
+
+// Text attributes, combined as a bitmask in Style::attrs
+enum CellAttr : uint8_t {
+    ATTR_NONE      = 0,
+    ATTR_BOLD      = 1 << 0,
+    ATTR_DIM       = 1 << 1,
+    ATTR_ITALIC    = 1 << 2,
+    ATTR_UNDERLINE = 1 << 3,
+    ATTR_REVERSE   = 1 << 4,
+};
+
+// Colors are packed 0xRRGGBB, DEFAULT_COLOR means "whatever the terminal uses"
+static constexpr uint32_t DEFAULT_COLOR = 0xFF000000u;
+
+inline uint32_t rgb(uint8_t r, uint8_t g, uint8_t b) {
+    return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+}
+
+// First codepoint of a UTF-8 string, ' ' if it's empty
+uint32_t first_codepoint(const std::string& utf8);
+
+// A horizontal run of identical cells, for art converted ahead of time
+struct CellRun {
+    uint16_t x, y, length;
+    uint32_t codepoint;
+    uint32_t fg; // 0xRRGGBB or DEFAULT_COLOR
+    uint32_t bg;
+};
+
+struct Style {
+    uint32_t fg = DEFAULT_COLOR;
+    uint32_t bg = DEFAULT_COLOR;
+    uint8_t attrs = ATTR_NONE;
+    
+    Style() = default;
+    Style(uint32_t fg, uint32_t bg = DEFAULT_COLOR, uint8_t attrs = ATTR_NONE) : fg(fg), bg(bg), attrs(attrs) {}
+    
+    bool operator==(const Style& o) const { return fg == o.fg && bg == o.bg && attrs == o.attrs; }
+    bool operator!=(const Style& o) const { return !(*this == o); }
+};
+
+// One plane per cell property, row-major
+struct CellPlanes {
+    std::vector<uint32_t> glyph;
+    std::vector<uint32_t> fg;
+    std::vector<uint32_t> bg;
+    std::vector<uint8_t> attrs;
+
+    void resize(size_t n) {
+        glyph.assign(n, ' ');
+        fg.assign(n, DEFAULT_COLOR);
+        bg.assign(n, DEFAULT_COLOR);
+        attrs.assign(n, ATTR_NONE);
+    }
+    void fill(size_t at, size_t n, uint32_t codepoint, const Style& style) {
+        std::fill_n(&glyph[at], n, codepoint);
+        fill_style(at, n, style);
+    }
+    void fill_style(size_t at, size_t n, const Style& style) {
+        std::fill_n(&fg[at], n, style.fg);
+        std::fill_n(&bg[at], n, style.bg);
+        std::memset(&attrs[at], style.attrs, n);
+    }
+    // Re-lays the planes out for a new size in place, keeping the overlapping
+    // cells and blanking the rest. Capacity is only ever grown
+    void reshape(int old_width, int old_height, int width, int height);
+    void copy(size_t to, const CellPlanes& src, size_t from, size_t n) {
+        std::memmove(&glyph[to], &src.glyph[from], n * sizeof(uint32_t));
+        std::memmove(&fg[to], &src.fg[from], n * sizeof(uint32_t));
+        std::memmove(&bg[to], &src.bg[from], n * sizeof(uint32_t));
+        std::memmove(&attrs[to], &src.attrs[from], n);
+    }
+};
+
+// Cells are stored as planes (codepoint, fg, bg, attrs) so row operations are
+// plain fills/copies. Every write sets the whole cell, glyph and style.
+// One column per codepoint, wide (CJK/emoji) glyphs aren't measured
 class Grid {
 public:
     Grid(int width, int height);
     
+    // Keeps what fits, reuses storage, and redraws everything on the next render
+    void resize(int width, int height);
     void clear();
     void set_char(int x, int y, char c);
     void set_char_with_color(int x, int y, char c, uint8_t fg_r, uint8_t fg_g, uint8_t fg_b);
-    void draw_text(int x, int y, const std::string& text);
-    void draw_text_centered(int y, const std::string& text);
-    void draw_box(int x, int y, int width, int height, char border_char = '#');
+    void set_cell(int x, int y, uint32_t codepoint, const Style& style = Style());
+    
+    // Bulk row operations, clipped to the grid once instead of per cell
+    void fill_rect(int x, int y, int width, int height, uint32_t codepoint = ' ', const Style& style = Style());
+    void blit(const Grid& src, int src_x, int src_y, int width, int height, int dst_x, int dst_y);
+    void draw_text(int x, int y, const std::string& text, const Style& style = Style()); // UTF-8
+    void draw_text_centered(int y, const std::string& text, const Style& style = Style());
+    void draw_box(int x, int y, int width, int height, char border_char = '#', const Style& style = Style());
     void draw_ascii_art(int x, int y, const std::string& ascii_art, bool center = false);
     
-    void render_to_terminal();
+    uint32_t codepoint_at(int x, int y) const { return back_.glyph[y * width_ + x]; }
+    Style style_at(int x, int y) const {
+        size_t i = y * width_ + x;
+        return Style(back_.fg[i], back_.bg[i], back_.attrs[i]);
+    }
+    
+    // Whole-grid snapshot in and out, load() needs matching dimensions
+    const CellPlanes& cells() const { return back_; }
+    void load(const CellPlanes& cells);
+    
+    // Builds one byte buffer holding only the cells that differ from what the
+    // terminal already shows. Returns false (and an empty frame) if nothing changed
+    bool compose_frame();
+    const char* frame_data() const { return frame_.data(); }
+    size_t frame_size() const { return frame_size_; }
+    
+    // compose_frame + a single write through the terminal
+    void render_to_terminal(Terminal& terminal);
+    // Terminal contents are unknown (cleared, resized): next render redraws everything
+    void invalidate();
     
     int width() const { return width_; }
     int height() const { return height_; }
+    size_t last_render_bytes() const { return frame_size_; }
     
 private:
-    struct Cell {
-        char character = ' ';
-        bool has_color = false;
-        uint8_t fg_r = 255, fg_g = 255, fg_b = 255;
+    // Columns written since the last render, per row (min > max = untouched)
+    struct DirtySpan {
+        int min_x;
+        int max_x;
     };
     
     int width_;
     int height_;
-    std::vector<Cell> cells_;
+    CellPlanes back_;   // what's being drawn
+    CellPlanes front_;  // what the terminal shows right now
+    std::vector<DirtySpan> dirty_;
+    bool full_redraw_ = true;
+    std::vector<char> frame_;  // frame output, grown rarely and reused across renders
+    size_t frame_size_ = 0;
     
-    Cell& get_cell(int x, int y);
-    const Cell& get_cell(int x, int y) const;
     bool is_valid_pos(int x, int y) const;
+    bool differs(size_t i) const {
+        return back_.glyph[i] != front_.glyph[i] || back_.fg[i] != front_.fg[i] ||
+               back_.bg[i] != front_.bg[i] || back_.attrs[i] != front_.attrs[i];
+    }
+    void mark_dirty(int y, int x0, int x1) {
+        DirtySpan& d = dirty_[y];
+        if (x0 < d.min_x) d.min_x = x0;
+        if (x1 > d.max_x) d.max_x = x1;
+    }
+    void mark_all_dirty();
+    void emit_cells(int y, int x0, int x1, int& cursor_x, int& cursor_y, Style& pen);
+    char* frame_reserve(size_t bytes);
 };
 
+// Built-in layers, default z-order is the declaration order (lowest first)
+enum class LayerId : uint8_t {
+    BACKGROUND,
+    CLUE_PANEL,
+    DIALOG,
+    CHOICES,
+    STATUS_BAR,
+    COUNT
+};
+
+// Each UI element draws into its own layer grid. A layer is only rasterized
+// again when what it was drawn from changes, otherwise the cached grid is
+// composited as row copies. The draw_* calls are still made every frame:
+// clear() starts a frame and layers not drawn again before render() are hidden
 class TUIRenderer {
 public:
     TUIRenderer(int width, int height);
     
     void resize(int width, int height);
     void clear();
-    void render();
+    // Composites the layers into grid(), returns false if it didn't change
+    bool compose();
+    void render(Terminal& terminal);
+    void invalidate();
     
     // UI Components
     void draw_background(const std::string& ascii_art);
+    // Converted cells: glyph indices into charset and 0xRRGGBB colors (null
+    // for the default color), centered like draw_background. key names the
+    // frame, the layer is only rasterized again when it changes
+    void draw_background_cells(const std::string& key, int cols, int rows, const uint8_t* glyphs,
+                               const uint32_t* colors, const std::vector<std::string>& charset);
+    // Pre-split art as row runs, cols x rows centered the same way. Each run
+    // is one row fill
+    void draw_background_runs(const std::string& key, int cols, int rows, const std::vector<CellRun>& runs);
     void draw_dialog_box(const std::string& text, int dialog_height = 6);
     void draw_choices(const std::vector<std::string>& choices, int selected_index = -1);
     void draw_status_bar(const std::string& scene_name, bool has_memory_indicator = false);
     void draw_clue_panel(const std::vector<std::string>& clues, bool visible = false);
     
+    void set_layer_z(LayerId id, int z);
+    // Forces a layer to be rasterized again on its next draw
+    void invalidate_layer(LayerId id);
+    
+    // Composited output, rebuilt on render()
     Grid& grid() { return grid_; }
     
 private:
+    struct Layer {
+        Grid grid;
+        int z = 0;
+        int x = 0, y = 0, width = 0, height = 0; // area copied into the output
+        std::string key;        // inputs the grid was last rasterized from
+        bool dirty = true;      // grid is stale, rasterize on next draw
+        bool visible = false;   // part of the current composite
+        bool submitted = false; // drawn since the last clear()
+        bool follows_size = true; // layout depends on the screen size, redraw after a resize
+        
+        Layer(int w, int h) : grid(w, h) {}
+    };
+    
     Grid grid_;
     int width_;
     int height_;
+    std::vector<Layer> layers_;      // indexed by LayerId
+    std::vector<Layer*> z_order_;    // visible or not, sorted by z
+    bool composite_dirty_ = true;
     
     // Layout constants
     static constexpr int STATUS_BAR_HEIGHT = 1;
     static constexpr int DIALOG_MARGIN = 2;
     static constexpr int CLUE_PANEL_WIDTH = 25;
+    
+    void create_layers();
+    // Marks the layer drawn this frame. Returns it cleared if it has to be
+    // rasterized again, nullptr if the cached grid is still good
+    Layer* begin_layer(LayerId id, std::string key, int x, int y, int width, int height);
 };
 
 } // namespace nightforge
\ No newline at end of file
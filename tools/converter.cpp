@@ -1,4 +1,5 @@
 #include "ascii_art.h"
+#include "ascii_anim.h"
 #include <iostream>
 #include <string>
 #include <algorithm>
@@ -29,12 +30,90 @@ static std::string to_lower(std::string s) {
     return s;
 }
 
+// stop via signal (so we can restore terminal state)
+static volatile sig_atomic_t g_stop = 0;
+
+// Plays a converted animation until SIGINT. Only the cells that change between
+// frames are written, frame 0 once in full at the start
+static int play_animation(const ascii_art::Animation& animation, double speed, int min_delay_override) {
+    // clear
+    std::cout << "\x1b[2J";
+    std::cout << "\x1b[?25l";
+
+    std::signal(SIGINT, [](int){ g_stop = 1; });
+
+    const int kMinDelayMs = 20; // allow up to ~50 FPS if GIF requests it but avoid 0ms
+    int kMinDelayMsEffective = kMinDelayMs;
+    if (min_delay_override > 0) kMinDelayMsEffective = min_delay_override;
+
+    auto frame_delay_ms = [&](size_t f) {
+        int delay_ms = animation.delay_ms(f);
+        if (speed > 0.0) {
+            delay_ms = static_cast<int>(std::max(1.0, double(delay_ms) / speed) + 0.5);
+        }
+        return std::max(delay_ms, kMinDelayMsEffective);
+    };
+
+    const size_t frames = animation.frame_count();
+    std::string out;
+    animation.emit(0, out);
+
+    // next_frame_time is the instant when the next displayed frame SHOULD occur
+    auto next_frame_time = std::chrono::steady_clock::now();
+
+    // playback loop so iterate frames repeatedly until SIGINT
+    size_t f = 0;
+    while (!g_stop) {
+        std::cout << out << std::flush;
+        out.clear();
+
+        int delay_ms = frame_delay_ms(f);
+        auto now = std::chrono::steady_clock::now();
+        if (next_frame_time <= now) {
+            next_frame_time = now + std::chrono::milliseconds(delay_ms);
+        } else {
+            next_frame_time += std::chrono::milliseconds(delay_ms);
+        }
+
+        // Sleep until the scheduled time, or if we're already past it, try to catch up by skipping frames.
+        now = std::chrono::steady_clock::now();
+        if (next_frame_time > now) {
+            auto sleep_duration = std::chrono::duration_cast<std::chrono::milliseconds>(next_frame_time - now);
+            sleep_for_ms(static_cast<int>(sleep_duration.count()));
+        } else {
+            // We're behind schedule. Skipped frames aren't shown on their own, their changes
+            // go out together with the next frame (1.7 worldgen be like)
+            while (!g_stop && f + 1 < frames) {
+                next_frame_time += std::chrono::milliseconds(frame_delay_ms(f + 1));
+                ++f;
+                animation.emit(animation.delta_into(f), out);
+                now = std::chrono::steady_clock::now();
+                if (next_frame_time > now) break;
+            }
+        }
+
+        ++f;
+        if (f >= frames) f = 0;
+        animation.emit(animation.delta_into(f), out);
+    }
+
+    // cleanup
+    std::cout << "\x1b[?25h";
+    return 0;
+}
+
 int main(int argc, char** argv) {
     if (argc < 4) {
         std::cerr << "Usage: " << argv[0] << " IMAGE STYLE COLORS [WIDTH] [ANIMATE]\n";
-        std::cerr << "  STYLE: clean | high_fidelity | block\n";
+        std::cerr << "  STYLE: clean | high_fidelity | block | half_block | braille\n";
         std::cerr << "  COLORS: yes | no\n";
         std::cerr << "  ANIMATE: yes | no  (optional; only affects GIFs)\n";
+        std::cerr << "  --filter=nearest|box|bilinear|lanczos  (optional; default nearest)\n";
+        std::cerr << "  --dither=none|bayer|fs|atkinson  (optional; default none)\n";
+        std::cerr << "  --palette=truecolor|256|16  (optional; default truecolor)\n";
+        std::cerr << "  --threads=N  (optional; 0 = one per core, default 1)\n";
+        std::cerr << "  --save=FILE.nfa  (optional; GIFs only, save the converted animation)\n";
+        std::cerr << "  IMAGE may be a saved .nfa animation, it plays without converting\n";
         return 1;
     }
 
@@ -45,6 +124,11 @@ int main(int argc, char** argv) {
     bool animate = false;
     double speed = 1.0;
     int min_delay_override = -1;
+    std::string filter_str = "nearest";
+    std::string dither_str = "none";
+    std::string palette_str = "truecolor";
+    int threads = 1;
+    std::string save_path;
     //any extra positional args (after the first 3) can be width or animate flag in any order.
     for (int i = 4; i < argc; ++i) {
         std::string s = to_lower(argv[i]);
@@ -90,6 +174,51 @@ int main(int argc, char** argv) {
             try { min_delay_override = std::stoi(argv[++i]); } catch(...) {}
             continue;
         }
+        // --filter=lanczos or --filter lanczos
+        if (s.rfind("--filter=", 0) == 0) {
+            filter_str = s.substr(9);
+            continue;
+        }
+        if (s == "--filter" && i+1 < argc) {
+            filter_str = to_lower(argv[++i]);
+            continue;
+        }
+        // --dither=bayer or --dither bayer
+        if (s.rfind("--dither=", 0) == 0) {
+            dither_str = s.substr(9);
+            continue;
+        }
+        if (s == "--dither" && i+1 < argc) {
+            dither_str = to_lower(argv[++i]);
+            continue;
+        }
+        // --palette=256 or --palette 256
+        if (s.rfind("--palette=", 0) == 0) {
+            palette_str = s.substr(10);
+            continue;
+        }
+        if (s == "--palette" && i+1 < argc) {
+            palette_str = to_lower(argv[++i]);
+            continue;
+        }
+        // --save=clip.nfa or --save clip.nfa (keeps the path's case)
+        if (s.rfind("--save=", 0) == 0) {
+            save_path = std::string(argv[i]).substr(7);
+            continue;
+        }
+        if (s == "--save" && i+1 < argc) {
+            save_path = argv[++i];
+            continue;
+        }
+        // --threads=4 or --threads 4
+        if (s.rfind("--threads=", 0) == 0) {
+            try { threads = std::stoi(s.substr(10)); } catch(...) {}
+            continue;
+        }
+        if (s == "--threads" && i+1 < argc) {
+            try { threads = std::stoi(argv[++i]); } catch(...) {}
+            continue;
+        }
     }
 
     ascii_art::Config cfg;
@@ -101,6 +230,10 @@ int main(int argc, char** argv) {
         cfg.mode = ascii_art::Mode::HIGH_FIDELITY;
     } else if (style_str == "block" || style_str == "b") {
         cfg.mode = ascii_art::Mode::BLOCK;
+    } else if (style_str == "half_block" || style_str == "half" || style_str == "hb") {
+        cfg.mode = ascii_art::Mode::HALF_BLOCK;
+    } else if (style_str == "braille" || style_str == "br") {
+        cfg.mode = ascii_art::Mode::BRAILLE;
     } else {
         std::cerr << "Unknown style: " << argv[2] << "\n";
         return 2;
@@ -115,13 +248,63 @@ int main(int argc, char** argv) {
         return 3;
     }
 
+    if (filter_str == "nearest") {
+        cfg.filter = ascii_art::Filter::NEAREST;
+    } else if (filter_str == "box" || filter_str == "area") {
+        cfg.filter = ascii_art::Filter::BOX;
+    } else if (filter_str == "bilinear") {
+        cfg.filter = ascii_art::Filter::BILINEAR;
+    } else if (filter_str == "lanczos") {
+        cfg.filter = ascii_art::Filter::LANCZOS;
+    } else {
+        std::cerr << "Unknown filter: " << filter_str << "\n";
+        return 2;
+    }
+
+    if (dither_str == "none") {
+        cfg.dither = ascii_art::Dither::NONE;
+    } else if (dither_str == "bayer" || dither_str == "ordered") {
+        cfg.dither = ascii_art::Dither::BAYER;
+    } else if (dither_str == "fs" || dither_str == "floyd-steinberg") {
+        cfg.dither = ascii_art::Dither::FLOYD_STEINBERG;
+    } else if (dither_str == "atkinson") {
+        cfg.dither = ascii_art::Dither::ATKINSON;
+    } else {
+        std::cerr << "Unknown dither: " << dither_str << "\n";
+        return 2;
+    }
+
+    if (palette_str == "truecolor" || palette_str == "24bit") {
+        cfg.palette = ascii_art::Palette::TRUECOLOR;
+    } else if (palette_str == "256" || palette_str == "xterm256") {
+        cfg.palette = ascii_art::Palette::XTERM256;
+    } else if (palette_str == "16" || palette_str == "ansi16") {
+        cfg.palette = ascii_art::Palette::ANSI16;
+    } else {
+        std::cerr << "Unknown palette: " << palette_str << "\n";
+        return 2;
+    }
+
+    cfg.threads = std::max(0, threads);
+
     ascii_art::Interpreter interp(cfg);
 
-    // If the input is a GIF and animation requested, use stb's GIF loader to get frames and delays
     auto ext_pos = image_path.find_last_of('.');
     std::string extension = (ext_pos == std::string::npos) ? std::string() : to_lower(image_path.substr(ext_pos + 1));
 
-    if (extension == "gif" && animate) {
+    // A saved animation plays as is, nothing to decode or convert
+    if (extension == "nfa") {
+        try {
+            ascii_art::Animation animation = ascii_art::Animation::load(image_path);
+            return play_animation(animation, speed, min_delay_override);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 4;
+        }
+    }
+
+    // GIFs are converted once up front, then played (or saved) from the frame store
+    if (extension == "gif" && (animate || !save_path.empty())) {
         // read file into memory (fucking hell)
         std::ifstream file(image_path, std::ios::binary | std::ios::ate);
         if (!file) {
@@ -144,96 +327,43 @@ int main(int argc, char** argv) {
             return 5;
         }
 
-        // clear
-        std::cout << "\x1b[2J";
-        std::cout << "\x1b[?25l";
-
-        const int frame_bytes = w * h * 3;
-
-        // stop via signal (so we can restore terminal state)
-        static volatile sig_atomic_t g_stop = 0;
-        auto handle_sigint = [](int){ g_stop = 1; };
-        std::signal(SIGINT, handle_sigint);
-
-        const int kDefaultDelayCs = 100;
-        // const int kDefaultDelayMs = kDefaultDelayCs * 10;
-        const int kMinDelayMs = 20; // allow up to ~50 FPS if GIF requests it but avoid 0ms
-    int kMinDelayMsEffective = kMinDelayMs;
-    if (min_delay_override > 0) kMinDelayMsEffective = min_delay_override;
-
-        // next_frame_time is the instant when the next displayed frame SHOULD occur
-        auto next_frame_time = std::chrono::steady_clock::now();
-
-        // playback loop so iterate frames repeatedly until SIGINT
-        int f = 0;
-        while (!g_stop) {
-            unsigned char* src = gif_data + (size_t)f * frame_bytes;
-            ascii_art::Image image(w, h, 3);
-            ::memcpy(image.data.data(), src, frame_bytes);
-
-            // Convert and render as fast as possible but using timing below to stay accurate
-            std::string out = interp.convert(image);
-
-            // move cursor home and print frame
-            std::cout << "\x1b[H";
-            std::cout << out << std::flush;
-
-            // Determine this frame's delay (in ms). GIF delays are in centiseconds (w trivia?)
-            int delay_cs = kDefaultDelayCs;
-            if (delays) {
-                delay_cs = delays[f];
-                if (delay_cs <= 0) delay_cs = 1;
-            }
-            int delay_ms = delay_cs * 10;
-            
-            if (speed > 0.0) {
-                delay_ms = static_cast<int>(std::max(1.0, double(delay_ms) / speed) + 0.5);
-            }
-            if (delay_ms < kMinDelayMsEffective) delay_ms = kMinDelayMsEffective;
-
-            auto now = std::chrono::steady_clock::now();
-            if (next_frame_time <= now) {
-                next_frame_time = now + std::chrono::milliseconds(delay_ms);
-            } else {
-                next_frame_time += std::chrono::milliseconds(delay_ms);
-            }
-
-            // Sleep until the scheduled time, or if we're already past it, try to catch up by skipping frames.
-            now = std::chrono::steady_clock::now();
-            if (next_frame_time > now) {
-                auto sleep_duration = std::chrono::duration_cast<std::chrono::milliseconds>(next_frame_time - now);
-                sleep_for_ms(static_cast<int>(sleep_duration.count()));
-            } else {
-                // We're behind schedule. Try to skip ahead frames until we're close to the next_frame_time (1.7 worldgen be like)
-                while (!g_stop && f + 1 < frames) {
-                    int look_cs = kDefaultDelayCs;
-                    if (delays) {
-                        look_cs = delays[f+1];
-                        if (look_cs <= 0) look_cs = 1;
-                    }
-                    int look_ms = look_cs * 10;
-                    if (speed > 0.0) {
-                        look_ms = static_cast<int>(std::max(1.0, double(look_ms) / speed) + 0.5);
-                    }
-                    if (look_ms < kMinDelayMsEffective) look_ms = kMinDelayMsEffective;
-                    next_frame_time += std::chrono::milliseconds(look_ms);
-                    ++f; // skip this frame (won't render it)
-                    now = std::chrono::steady_clock::now();
-                    if (next_frame_time > now) break;
-                }
-                // if we've caught up, continue; otherwise we'll loop and render the (possibly advanced) frame
-            }
-
-            ++f;
-            if (f >= frames) f = 0;
+        // GIFs store centiseconds (w trivia?) but stb hands them over as ms already,
+        // missing or 0 ones get defaults
+        const int kDefaultDelayMs = 1000;
+        std::vector<int> delays_ms(frames);
+        for (int f = 0; f < frames; ++f) {
+            delays_ms[f] = delays ? std::max(10, delays[f]) : kDefaultDelayMs;
         }
 
-        // cleanup
-        std::cout << "\x1b[?25h";
+        auto start = std::chrono::steady_clock::now();
+        ascii_art::Animation animation;
+        try {
+            animation = ascii_art::Animation::build(gif_data, w, h, 3, delays_ms, cfg, threads);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            stbi_image_free(gif_data);
+            if (delays) free(delays);
+            return 5;
+        }
         stbi_image_free(gif_data);
         if (delays) free(delays);
+        double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-        return 0;
+        if (!save_path.empty()) {
+            try {
+                animation.save(save_path);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << '\n';
+                return 4;
+            }
+            size_t cells = static_cast<size_t>(animation.width()) * animation.height();
+            std::cerr << "Saved " << save_path << ": " << animation.frame_count() << " frames of "
+                      << animation.width() << "x" << animation.height() << ", "
+                      << animation.stored_cells() << " cells stored of " << cells * animation.frame_count()
+                      << " (" << build_ms << " ms to convert)\n";
+            if (!animate) return 0;
+        }
+        return play_animation(animation, speed, min_delay_override);
     }
 
     try {